@@ -0,0 +1,83 @@
+/*
+ * 80960 Emulator Benchmarks: Host Side
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include <i960-emu.h>
+
+#include "i960-host.h"
+
+uint8_t  host_mem[HOST_MEM_SIZE];
+uint64_t host_faults;
+
+uint8_t i960_read_b (struct i960 *o, uint32_t addr)
+{
+	return host_mem[addr & HOST_MEM_MASK];
+}
+
+uint16_t i960_read_s (struct i960 *o, uint32_t addr)
+{
+	uint16_t x;
+
+	memcpy (&x, host_mem + (addr & HOST_MEM_MASK & ~1), sizeof (x));
+	return x;
+}
+
+uint32_t i960_read_w (struct i960 *o, uint32_t addr)
+{
+	uint32_t x;
+
+	memcpy (&x, host_mem + (addr & HOST_MEM_MASK & ~3), sizeof (x));
+	return x;
+}
+
+void i960_write_b (struct i960 *o, uint32_t addr, uint32_t x)
+{
+	host_mem[addr & HOST_MEM_MASK] = x;
+}
+
+void i960_write_s (struct i960 *o, uint32_t addr, uint32_t x)
+{
+	const uint16_t v = x;
+
+	memcpy (host_mem + (addr & HOST_MEM_MASK & ~1), &v, sizeof (v));
+}
+
+void i960_write_w (struct i960 *o, uint32_t addr, uint32_t x)
+{
+	memcpy (host_mem + (addr & HOST_MEM_MASK & ~3), &x, sizeof (x));
+}
+
+void *i960_map (struct i960 *o, uint32_t addr, uint32_t size, int write)
+{
+	return addr < HOST_MEM_SIZE && size <= HOST_MEM_SIZE - addr ?
+	       host_mem + addr : NULL;
+}
+
+void i960_fault (struct i960 *o, int type) { ++host_faults; }
+void i960_calls (struct i960 *o, int type) {}
+
+double host_now (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int host_selected (const char *name, int argc, char *argv[])
+{
+	int i;
+
+	for (i = 0; i < argc; ++i)
+		if (strcmp (argv[i], name) == 0)
+			return 1;
+
+	return argc == 0;
+}
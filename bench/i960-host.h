@@ -0,0 +1,35 @@
+/*
+ * 80960 Emulator Benchmarks: Host Side
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_HOST_H
+#define I960_HOST_H  1
+
+#include <stdint.h>
+
+/*
+ * Guest memory: flat 1 MiB, addresses wrap. Memory callbacks of the
+ * emulator are defined over it, faults are counted and calls ignored.
+ */
+#define HOST_MEM_SIZE	0x100000
+#define HOST_MEM_MASK	(HOST_MEM_SIZE - 1)
+
+extern uint8_t  host_mem[HOST_MEM_SIZE];
+extern uint64_t host_faults;
+
+/*
+ * Monotonic time in seconds
+ */
+double host_now (void);
+
+/*
+ * Command line filter: name is selected if it is listed in argv or if
+ * argv is empty
+ */
+int host_selected (const char *name, int argc, char *argv[]);
+
+#endif  /* I960_HOST_H */
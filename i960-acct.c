@@ -0,0 +1,65 @@
+/*
+ * 80960 Emulator Host Time Accounting
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <string.h>
+
+#include <i960-emu-acct.h>
+
+static uint64_t acct_ns (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void i960_acct_init (struct i960_acct *a)
+{
+	memset (a, 0, sizeof (*a));
+
+	a->stack[0] = I960_ACCT_DISPATCH;
+	a->ns   = acct_ns ();
+	a->tsc  = i960_acct_clock ();
+	a->mark = a->tsc;
+}
+
+static const char *acct_name[I960_ACCT_COUNT] = {
+	"dispatch", "alu", "branch", "memory", "frame", "fault", "mmio",
+	"jit", "device",
+};
+
+void i960_acct_report (FILE *to, struct i960_acct *a)
+{
+	uint64_t total, ns;
+	double ghz;
+	int i;
+
+	i960_acct_charge (a);
+
+	total = a->mark - a->tsc;
+	ns    = acct_ns () - a->ns;
+	ghz   = ns == 0 ? 1.0 : (double) total / ns;	/* ticks per ns	*/
+
+	fprintf (to, "# %-10s %14s %16s %12s %8s %10s\n", "subsystem",
+		 "entries", "ticks", "ms", "share", "ticks/ent");
+
+	for (i = 0; i < I960_ACCT_COUNT; ++i) {
+		if (a->ticks[i] == 0 && a->count[i] == 0)
+			continue;
+
+		fprintf (to, "%-12s %14llu %16llu %12.3f %7.2f%% %10.1f\n",
+			 acct_name[i], (unsigned long long) a->count[i],
+			 (unsigned long long) a->ticks[i],
+			 a->ticks[i] / ghz / 1e6,
+			 total == 0 ? 0.0 : 100.0 * a->ticks[i] / total,
+			 a->count[i] == 0 ? 0.0 :
+			 (double) a->ticks[i] / a->count[i]);
+	}
+
+	fprintf (to, "# %.3f ms total, %.3f ticks/ns\n", ns / 1e6, ghz);
+}
@@ -0,0 +1,547 @@
+/*
+ * 80960 Emulator Micro-benchmarks
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <i960-emu-ops.h>
+#include <i960-pmu.h>
+#include <i960-results.h>
+#include <i960-sample.h>
+
+#include "i960-host.h"
+
+/*
+ * Randomized instruction streams: generated once per benchmark so the
+ * timed loop does not include operand generation
+ */
+#define NINSNS		4096
+#define MEM_SPAN	0x10000		/* load and store addresses	*/
+
+struct insn {
+	uint32_t op, a, b, c;
+	struct i960_insn in;		/* op decoded, CTRL and COBR	*/
+};
+
+static uint64_t seed = 0x960;
+
+static uint32_t rnd (void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	return seed >> 32;
+}
+
+static uint32_t pick (const uint32_t *v, size_t n)
+{
+	return v[rnd () % n];
+}
+
+static uint32_t reg_word (uint32_t major, uint32_t func)
+{
+	return major << 24 | func << 7;
+}
+
+static void gen_reg (struct insn *v, uint32_t major, const uint32_t *funcs,
+		     size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < NINSNS; ++i) {
+		v[i].op = reg_word (major, pick (funcs, n));
+		v[i].a  = rnd ();
+		v[i].b  = rnd ();
+		v[i].c  = 4 + rnd () % 12;	/* r4..r15 */
+	}
+}
+
+static void gen_log (struct insn *v)
+{
+	static const uint32_t f[] = { 1, 2, 4, 6, 7, 8, 9, 10, 11, 13, 14 };
+
+	gen_reg (v, 0x58, f, sizeof (f) / sizeof (f[0]));
+}
+
+static void gen_add (struct insn *v)
+{
+	static const uint32_t f[] = { 0, 1, 2, 3 };
+
+	gen_reg (v, 0x59, f, sizeof (f) / sizeof (f[0]));
+}
+
+static void gen_addc (struct insn *v)
+{
+	static const uint32_t f[] = { 0, 2 };
+
+	gen_reg (v, 0x5B, f, sizeof (f) / sizeof (f[0]));
+}
+
+static void gen_shift (struct insn *v)
+{
+	static const uint32_t f[] = { 8, 10, 11, 12, 13, 14 };
+	size_t i;
+
+	gen_reg (v, 0x59, f, sizeof (f) / sizeof (f[0]));
+
+	for (i = 0; i < NINSNS; ++i)
+		v[i].a %= 40;		/* mostly in range, some saturate */
+}
+
+static void gen_cmp (struct insn *v)
+{
+	static const uint32_t f[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+	size_t i;
+
+	gen_reg (v, 0x5A, f, sizeof (f) / sizeof (f[0]));
+
+	for (i = 0; i < NINSNS; ++i)
+		if (rnd () & 1)
+			v[i].a = v[i].b;	/* exercise equal outcome */
+}
+
+static void gen_muldiv (struct insn *v)
+{
+	/* mulo, remo, divo, muli, remi, modi, divi */
+	static const uint32_t ops[] = {
+		0x701, 0x708, 0x70B, 0x741, 0x748, 0x749, 0x74B,
+	};
+	size_t i;
+	uint32_t x;
+
+	for (i = 0; i < NINSNS; ++i) {
+		x = pick (ops, sizeof (ops) / sizeof (ops[0]));
+		v[i].op = reg_word (x >> 4, x & 15);
+		v[i].a  = rnd () >> (rnd () % 32) | 1;	/* no division by 0 */
+		v[i].b  = rnd ();
+		v[i].c  = 4 + rnd () % 12;
+	}
+}
+
+static void gen_fpu (struct insn *v)
+{
+	static const uint32_t m[] = { 0x78, 0x79 };		/* r, rl */
+	static const uint32_t f[] = { 0xF, 0xD, 0xC, 0xB };	/* add .. div */
+	size_t i;
+
+	for (i = 0; i < NINSNS; ++i) {
+		v[i].op = reg_word (pick (m, 2), pick (f, 4)) |
+			  (8 + rnd () % 4 * 2) << 19 | 6 << 14 | 4;
+		v[i].a  = 0x3f800000 | (rnd () & 0x807fffff);	/* ±[1, 2) */
+		v[i].b  = 0x3f800000 | (rnd () & 0x807fffff);
+		v[i].c  = (v[i].op >> 19) & 31;
+	}
+}
+
+static void gen_mem (struct insn *v, const uint32_t *ops, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < NINSNS; ++i) {
+		v[i].op = pick (ops, n) << 24;
+		v[i].a  = rnd () & (MEM_SPAN - 1) & ~15;	/* efa */
+		v[i].c  = 4 + (rnd () % 3) * 4;		/* r4, r8, r12 */
+	}
+}
+
+static void gen_load (struct insn *v)
+{
+	static const uint32_t ops[] = { 0x80, 0x88, 0x90, 0x98, 0xB0, 0xC0 };
+
+	gen_mem (v, ops, sizeof (ops) / sizeof (ops[0]));
+}
+
+static void gen_store (struct insn *v)
+{
+	static const uint32_t ops[] = { 0x82, 0x8A, 0x92, 0x9A, 0xB2 };
+
+	gen_mem (v, ops, sizeof (ops) / sizeof (ops[0]));
+}
+
+static void gen_call (struct insn *v)
+{
+	size_t i;
+
+	for (i = 0; i < NINSNS; ++i)
+		v[i].op = 0x09000000 | (rnd () & 0xfffc);
+}
+
+static void gen_cobr (struct insn *v)
+{
+	size_t i;
+
+	for (i = 0; i < NINSNS; ++i) {
+		v[i].op = (0x30 + rnd () % 16) << 24 |
+			  (rnd () % 32) << 19 | (4 + rnd () % 12) << 14 |
+			  (rnd () & 1) << 13 | (rnd () & 0x7fc);
+		v[i].a  = rnd ();	/* src2 register contents */
+	}
+}
+
+static void gen_ctrl (struct insn *v)
+{
+	static const uint32_t ops[] = {
+		0x08, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+	};
+	size_t i;
+
+	for (i = 0; i < NINSNS; ++i) {
+		v[i].op = pick (ops, sizeof (ops) / sizeof (ops[0])) << 24 |
+			  (rnd () & 0xfffffc);
+		v[i].a  = 1 << rnd () % 3;	/* condition code */
+	}
+}
+
+/*
+ * Timed loops, return number of retired instructions
+ */
+static uint64_t run_reg (struct i960 *o, const struct insn *v, unsigned reps,
+			 void (*fn) (struct i960 *o, uint32_t op, uint32_t a,
+				     uint32_t b, size_t c))
+{
+	unsigned k;
+	size_t i;
+
+	for (k = 0; k < reps; ++k)
+		for (i = 0; i < NINSNS; ++i)
+			fn (o, v[i].op, v[i].a, v[i].b, v[i].c);
+
+	return (uint64_t) reps * NINSNS;
+}
+
+static uint64_t run_log (struct i960 *o, const struct insn *v, unsigned reps)
+{
+	return run_reg (o, v, reps, reg_log);
+}
+
+static uint64_t run_add (struct i960 *o, const struct insn *v, unsigned reps)
+{
+	return run_reg (o, v, reps, reg_addx);
+}
+
+static uint64_t run_addc (struct i960 *o, const struct insn *v, unsigned reps)
+{
+	return run_reg (o, v, reps, reg_addc);
+}
+
+static uint64_t run_shift (struct i960 *o, const struct insn *v, unsigned reps)
+{
+	return run_reg (o, v, reps, reg_shift);
+}
+
+static uint64_t run_cmp (struct i960 *o, const struct insn *v, unsigned reps)
+{
+	return run_reg (o, v, reps, reg_cmp);
+}
+
+static uint64_t run_muldiv (struct i960 *o, const struct insn *v, unsigned reps)
+{
+	return run_reg (o, v, reps, reg_muldiv);
+}
+
+/*
+ * Real operands in r4 and r6, long real in r4-r5 and r6-r7; all
+ * exceptions masked and inexact flagged already, as after first inexact
+ * result: steady state of the host fast path
+ */
+static uint64_t run_fpu (struct i960 *o, const struct insn *v, unsigned reps)
+{
+	unsigned k;
+	size_t i;
+
+	o->ac = 0x1f << I960_FPM_POS | 0x10 << I960_FPF_POS;
+
+	for (k = 0; k < reps; ++k)
+		for (i = 0; i < NINSNS; ++i) {
+			o->r[4] = o->r[7] = v[i].a;
+			o->r[5] = o->r[6] = v[i].b;
+			i960_fpu (o, v[i].op, v[i].a, v[i].b, v[i].c);
+		}
+
+	return (uint64_t) reps * NINSNS;
+}
+
+static uint64_t run_mem (struct i960 *o, const struct insn *v, unsigned reps)
+{
+	unsigned k;
+	size_t i;
+
+	for (k = 0; k < reps; ++k)
+		for (i = 0; i < NINSNS; ++i)
+			mem_op (o, v[i].op, v[i].a, v[i].c);
+
+	return (uint64_t) reps * NINSNS;
+}
+
+static uint64_t run_call (struct i960 *o, const struct insn *v, unsigned reps)
+{
+	struct i960_insn ret;
+	unsigned k;
+	size_t i;
+
+	i960_decode (&ret, 0x0A000000, 0);
+
+	for (k = 0; k < reps; ++k)
+		for (i = 0; i < NINSNS; ++i) {
+			i960_ctrl (o, &v[i].in, o->ip - 4);
+			i960_ctrl (o, &ret, o->ip - 4);
+		}
+
+	return (uint64_t) reps * NINSNS * 2;
+}
+
+static uint64_t run_cobr (struct i960 *o, const struct insn *v, unsigned reps)
+{
+	unsigned k;
+	size_t i;
+
+	for (k = 0; k < reps; ++k)
+		for (i = 0; i < NINSNS; ++i) {
+			o->r[(v[i].op >> 14) & 31] = v[i].a;
+			o->ip = 0x1004;
+			i960_cobr (o, &v[i].in, 0x1000);
+		}
+
+	return (uint64_t) reps * NINSNS;
+}
+
+static uint64_t run_ctrl (struct i960 *o, const struct insn *v, unsigned reps)
+{
+	unsigned k;
+	size_t i;
+
+	for (k = 0; k < reps; ++k)
+		for (i = 0; i < NINSNS; ++i) {
+			o->ac = v[i].a;
+			o->ip = 0x1004;
+			i960_ctrl (o, &v[i].in, 0x1000);
+		}
+
+	return (uint64_t) reps * NINSNS;
+}
+
+struct bench {
+	const char *name;
+	void (*gen) (struct insn *v);
+	uint64_t (*run) (struct i960 *o, const struct insn *v, unsigned reps);
+};
+
+static const struct bench benches[] = {
+	{ "reg_log",	gen_log,	run_log		},
+	{ "reg_add",	gen_add,	run_add		},
+	{ "reg_addc",	gen_addc,	run_addc	},
+	{ "reg_shift",	gen_shift,	run_shift	},
+	{ "reg_cmp",	gen_cmp,	run_cmp		},
+	{ "reg_muldiv",	gen_muldiv,	run_muldiv	},
+	{ "reg_fpu",	gen_fpu,	run_fpu		},
+	{ "mem_load",	gen_load,	run_mem		},
+	{ "mem_store",	gen_store,	run_mem		},
+	{ "call_ret",	gen_call,	run_call	},
+	{ "cobr_op",	gen_cobr,	run_cobr	},
+	{ "ctrl_op",	gen_ctrl,	run_ctrl	},
+};
+
+#define NBENCHES	(sizeof (benches) / sizeof (benches[0]))
+
+/*
+ * Measurement
+ */
+static void cpu_init (struct i960 *o)
+{
+	memset (o, 0, sizeof (*o));
+
+	o->ac = 1 << I960_OM_POS;		/* mask integer overflow */
+	o->ip = 0x1004;
+	o->r[I960_SP] = 0x8040;
+	o->r[I960_FP] = 0x8000;
+}
+
+static struct i960_pmu pmu;
+static FILE *store;				/* results file or NULL */
+
+static double sample (const struct bench *b, const struct insn *v,
+		      unsigned reps, uint64_t *total)
+{
+	struct i960 o;
+	uint64_t n;
+	double t;
+
+	cpu_init (&o);
+
+	i960_pmu_start (&pmu);
+	t = host_now ();
+	n = b->run (&o, v, reps);
+	t = host_now () - t;
+	i960_pmu_stop (&pmu);
+
+	*total += n;
+	return t * 1e9 / n;			/* ns per instruction */
+}
+
+struct result {
+	unsigned reps;
+	uint64_t insns;				/* in one run		*/
+	uint64_t total;				/* over all runs	*/
+	struct i960_sample ns;
+};
+
+static void measure (const struct bench *b, unsigned runs, double min_time,
+		     struct result *r)
+{
+	struct insn *v = malloc (NINSNS * sizeof (v[0]));
+	double *x = malloc (runs * sizeof (x[0]));
+	unsigned i;
+	double t;
+
+	if (v == NULL || x == NULL) {
+		perror ("i960-bench");
+		exit (1);
+	}
+
+	memset (v, 0, NINSNS * sizeof (v[0]));
+	b->gen (v);
+
+	for (i = 0; i < NINSNS; ++i)
+		i960_decode (&v[i].in, v[i].op, 0);
+
+	r->total = 0;
+
+	/*
+	 * calibrate: double repetitions until single run is long enough,
+	 * run may retire more than one instruction per entry (call_ret)
+	 */
+	for (r->reps = 1; r->reps < (1u << 24); r->reps *= 2) {
+		r->insns = r->total;
+		t = sample (b, v, r->reps, &r->total);
+		r->insns = r->total - r->insns;
+
+		if (t * r->insns >= min_time * 1e9)
+			break;
+	}
+
+	i960_pmu_reset (&pmu);
+	r->total = 0;
+
+	for (i = 0; i < runs; ++i)
+		x[i] = sample (b, v, r->reps, &r->total);
+
+	i960_sample_stat (&r->ns, x, runs);
+
+	if (store != NULL) {
+		for (i = 0; i < runs; ++i)
+			x[i] = x[i] <= 0.0 ? 0.0 : 1e3 / x[i];	/* MIPS */
+
+		i960_results_put (store, b->name, "handler", x, runs);
+	}
+
+	free (x);
+	free (v);
+}
+
+static double mips (double ns)
+{
+	return ns <= 0.0 ? 0.0 : 1e3 / ns;
+}
+
+/*
+ * Output keys and their order are stable, consumers may diff reports
+ */
+static void report (const struct bench *b, const struct result *r, int first)
+{
+	printf ("%s\n    {\n"
+		"      \"name\": \"%s\",\n"
+		"      \"insns\": %llu,\n"
+		"      \"ns_per_insn\": { \"mean\": %.4f, \"stddev\": %.4f, "
+		"\"ci95\": [%.4f, %.4f], \"min\": %.4f },\n"
+		"      \"mips\": { \"mean\": %.2f, \"ci95\": [%.2f, %.2f] },\n"
+		"      \"host_per_insn\": ",
+		first ? "" : ",", b->name,
+		(unsigned long long) r->insns,
+		r->ns.mean, r->ns.sd, r->ns.lo, r->ns.hi, r->ns.min,
+		mips (r->ns.mean), mips (r->ns.hi), mips (r->ns.lo));
+
+	i960_pmu_report (stdout, &pmu, r->total);
+	printf ("\n    }");
+}
+
+static int usage (void)
+{
+	fprintf (stderr, "usage:\n\ti960-bench [-r runs] [-t ms] [-s seed] "
+			 "[-o dir] [-l] [name ...]\n");
+	return 1;
+}
+
+int main (int argc, char *argv[])
+{
+	unsigned runs = 15, ms = 20;
+	uint64_t base;
+	struct result r;
+	const char *dir = NULL;
+	char path[256];
+	int opt, first = 1;
+	size_t i;
+
+	while ((opt = getopt (argc, argv, "r:t:s:o:l")) != -1)
+		switch (opt) {
+		case 'r':  runs = atoi (optarg);		break;
+		case 't':  ms   = atoi (optarg);		break;
+		case 's':  seed = strtoull (optarg, NULL, 0);	break;
+		case 'o':  dir  = optarg;			break;
+		case 'l':
+			for (i = 0; i < NBENCHES; ++i)
+				printf ("%s\n", benches[i].name);
+
+			return 0;
+		default:
+			return usage ();
+		}
+
+	if (runs == 0 || (base = seed) == 0)
+		return usage ();
+
+	if (dir != NULL &&
+	    (store = i960_results_create (dir, "i960-bench", path,
+					  sizeof (path))) == NULL) {
+		perror (dir);
+		return 1;
+	}
+
+	if (i960_pmu_open (&pmu) == 0)
+		fprintf (stderr, "i960-bench: no host performance counters\n");
+
+	printf ("{\n  \"format\": \"i960-bench/1\",\n"
+		"  \"runs\": %u,\n  \"min_ms\": %u,\n  \"seed\": %llu,\n"
+		"  \"results\": [", runs, ms, (unsigned long long) seed);
+
+	for (i = 0; i < NBENCHES; ++i)
+		if (host_selected (benches[i].name, argc - optind,
+				   argv + optind)) {
+			seed = base ^ (i + 1) * 0x9e3779b97f4a7c15ull;
+			seed = seed == 0 ? 1 : seed;	/* own stream per bench */
+			measure (benches + i, runs, ms * 1e-3, &r);
+			report (benches + i, &r, first);
+			fflush (stdout);
+			first = 0;
+		}
+
+	printf ("\n  ]\n}\n");
+	i960_pmu_close (&pmu);
+
+	if (store != NULL) {
+		if (fclose (store) != 0) {
+			perror (path);
+			return 1;
+		}
+
+		fprintf (stderr, "i960-bench: results saved to %s\n", path);
+	}
+
+	return 0;
+}
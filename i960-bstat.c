@@ -0,0 +1,175 @@
+/*
+ * 80960 Emulator Branch Site Statistics
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <stdlib.h>
+
+#include <i960-dasm.h>
+#include <i960-emu-bstat.h>
+
+void i960_bstat_fini (struct i960_bstat *s)
+{
+	free (s->v);
+	s->v = NULL;
+	s->size = s->used = 0;
+}
+
+static size_t site_hash (uint32_t ip, size_t mask)
+{
+	return ((ip >> 2) * 0x9e3779b1u) & mask;
+}
+
+static struct i960_bsite *site_slot (struct i960_bsite *v, size_t size,
+				     uint32_t ip)
+{
+	const size_t mask = size - 1;
+	size_t i;
+
+	for (i = site_hash (ip, mask); v[i].count != 0; i = (i + 1) & mask)
+		if (v[i].ip == ip)
+			break;
+
+	return v + i;
+}
+
+static int site_grow (struct i960_bstat *s)
+{
+	const size_t n = s->size == 0 ? 1024 : s->size * 2;
+	struct i960_bsite *v;
+	size_t i;
+
+	if ((v = calloc (n, sizeof (v[0]))) == NULL)
+		return 0;
+
+	for (i = 0; i < s->size; ++i)
+		if (s->v[i].count != 0)
+			*site_slot (v, n, s->v[i].ip) = s->v[i];
+
+	free (s->v);
+	s->v    = v;
+	s->size = n;
+	return 1;
+}
+
+struct i960_bsite *i960_bstat_site (struct i960_bstat *s, uint32_t ip,
+				    uint32_t op)
+{
+	struct i960_bsite *site;
+
+	if (s->size > 0 && (site = site_slot (s->v, s->size, ip))->count != 0)
+		return site;
+
+	if (s->used * 2 >= s->size && !site_grow (s))
+		return NULL;
+
+	site = site_slot (s->v, s->size, ip);
+	site->ip = ip;
+	site->op = op;
+	++s->used;
+	return site;
+}
+
+struct i960_bsite *i960_bstat_find (const struct i960_bstat *s, uint32_t ip)
+{
+	struct i960_bsite *site;
+
+	if (s->size == 0)
+		return NULL;
+
+	site = site_slot (s->v, s->size, ip);
+	return site->count != 0 ? site : NULL;
+}
+
+/*
+ * Keep most frequent targets: untracked target replaces least frequent one
+ * when hits of untracked targets outweigh it, victim count goes to other.
+ */
+void i960_bstat_target (struct i960_bsite *site, uint32_t target)
+{
+	struct i960_btarget *t = site->target, *min = t;
+	size_t i;
+
+	for (i = 0; i < I960_BSTAT_TARGETS; ++i, ++t) {
+		if (t->count == 0 || t->ip == target) {
+			t->ip = target;
+			++t->count;
+			return;
+		}
+
+		if (t->count < min->count)
+			min = t;
+	}
+
+	if (++site->other > min->count) {
+		site->other -= 1;
+		site->other += min->count;
+		min->ip    = target;
+		min->count = 1;
+	}
+}
+
+static int site_by_ip (const void *a, const void *b)
+{
+	const struct i960_bsite *x = *(const struct i960_bsite **) a;
+	const struct i960_bsite *y = *(const struct i960_bsite **) b;
+
+	return x->ip < y->ip ? -1 : x->ip > y->ip;
+}
+
+static void site_show (FILE *to, const struct i960_bsite *site)
+{
+	const struct i960_btarget *t;
+	const char *name;
+	size_t i;
+
+	fprintf (to, "%08x  %12llu %12llu %6.2f%%  ", site->ip,
+		 (unsigned long long) site->count,
+		 (unsigned long long) site->taken,
+		 100.0 * site->taken / site->count);
+
+	if ((site->op >> 28) >= 8) {	/* no MEMB displacement kept	*/
+		name = i960_dasm_name (site->op);
+		fprintf (to, "%s\n", name == NULL ? "?" : name);
+	}
+	else {
+		i960_dasm (to, site->ip, site->op, 0);
+		fputc ('\n', to);
+	}
+
+	for (i = 0, t = site->target; i < I960_BSTAT_TARGETS; ++i, ++t)
+		if (t->count != 0)
+			fprintf (to, "\t-> %08x  %12llu %6.2f%%\n", t->ip,
+				 (unsigned long long) t->count,
+				 100.0 * t->count / site->count);
+
+	if (site->other != 0)
+		fprintf (to, "\t-> other     %12llu %6.2f%%\n",
+			 (unsigned long long) site->other,
+			 100.0 * site->other / site->count);
+}
+
+void i960_bstat_report (FILE *to, const struct i960_bstat *s)
+{
+	const struct i960_bsite **v;
+	size_t i, n;
+
+	if ((v = malloc ((s->used + 1) * sizeof (v[0]))) == NULL)
+		return;
+
+	for (i = 0, n = 0; i < s->size; ++i)
+		if (s->v[i].count != 0)
+			v[n++] = s->v + i;
+
+	qsort (v, n, sizeof (v[0]), site_by_ip);
+
+	fprintf (to, "# site          count        taken  ratio  insn\n");
+
+	for (i = 0; i < n; ++i)
+		site_show (to, v[i]);
+
+	free (v);
+}
@@ -0,0 +1,381 @@
+/*
+ * 80960 Emulator Cache Simulator
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <i960-cache.h>
+
+int i960_cache_init (struct i960_cache *o, unsigned size, unsigned ways,
+		     unsigned line)
+{
+	memset (o, 0, sizeof (*o));
+
+	if (size == 0)
+		return 1;
+
+	if (ways == 0 || line < 4 || (line & (line - 1)) != 0 ||
+	    size % (ways * line) != 0) {
+		errno = EINVAL;
+		return 0;
+	}
+
+	for (o->shift = 0; (1u << o->shift) < line; ++o->shift) {}
+
+	o->sets    = size / (ways * line);
+	o->ways    = ways;
+	o->enabled = 1;
+
+	o->lines = calloc (o->sets * ways, sizeof (o->lines[0]));
+	return o->lines != NULL;
+}
+
+void i960_cache_fini (struct i960_cache *o)
+{
+	free (o->lines);
+	o->lines = NULL;
+}
+
+static struct i960_cache_line *
+cache_find (struct i960_cache *o, uint32_t addr, struct i960_cache_line **lru)
+{
+	const uint32_t tag = addr >> o->shift;
+	struct i960_cache_line *set = o->lines + (tag % o->sets) * o->ways;
+	unsigned i;
+
+	for (i = 0, *lru = NULL; i < o->ways; ++i) {
+		if (set[i].valid && set[i].tag == tag)
+			return set + i;
+
+		if (set[i].locked)
+			continue;
+
+		if (*lru == NULL || !set[i].valid ||
+		    ((*lru)->valid && set[i].stamp < (*lru)->stamp))
+			*lru = set + i;
+	}
+
+	return NULL;
+}
+
+static void
+cache_fill (struct i960_cache *o, struct i960_cache_line *l, uint32_t addr)
+{
+	l->tag   = addr >> o->shift;
+	l->valid = 1;
+	l->stamp = ++o->clock;
+}
+
+int i960_cache_read (struct i960_cache *o, uint32_t addr)
+{
+	struct i960_cache_line *l, *lru;
+
+	++o->reads;
+
+	if (!o->enabled || o->lines == NULL) {
+		++o->misses;
+		return 0;
+	}
+
+	if ((l = cache_find (o, addr, &lru)) != NULL) {
+		l->stamp = ++o->clock;
+		return 1;
+	}
+
+	++o->misses;
+
+	if (lru != NULL)
+		cache_fill (o, lru, addr);
+
+	return 0;
+}
+
+void i960_cache_write (struct i960_cache *o, uint32_t addr)
+{
+	struct i960_cache_line *l, *lru;
+
+	++o->writes;
+
+	if (o->enabled && o->lines != NULL &&
+	    (l = cache_find (o, addr, &lru)) != NULL)
+		l->stamp = ++o->clock;
+}
+
+void i960_cache_invalidate (struct i960_cache *o)
+{
+	size_t i;
+
+	for (i = 0; o->lines != NULL && i < o->sets * o->ways; ++i)
+		if (!o->lines[i].locked)
+			o->lines[i].valid = 0;
+}
+
+void i960_cache_invalidate_line (struct i960_cache *o, uint32_t addr)
+{
+	struct i960_cache_line *l, *lru;
+
+	if (o->lines != NULL && (l = cache_find (o, addr, &lru)) != NULL &&
+	    !l->locked)
+		l->valid = 0;
+}
+
+/*
+ * Load and lock: at least one way of each set stays unlocked
+ */
+void i960_cache_lock (struct i960_cache *o, uint32_t addr, unsigned lines)
+{
+	struct i960_cache_line *set, *l, *lru;
+	unsigned i, n;
+
+	for (; o->lines != NULL && lines > 0; --lines, addr += 1 << o->shift) {
+		set = o->lines + ((addr >> o->shift) % o->sets) * o->ways;
+
+		for (i = 0, n = 0; i < o->ways; ++i)
+			n += set[i].locked;
+
+		if ((l = cache_find (o, addr, &lru)) == NULL) {
+			if (lru == NULL || n + 1 >= o->ways)
+				continue;
+
+			cache_fill (o, l = lru, addr);
+		}
+		else if (!l->locked && n + 1 >= o->ways)
+			continue;
+
+		l->locked = 1;
+	}
+}
+
+/*
+ * Simulator
+ */
+struct csim_conf {
+	unsigned isize, iways, dsize, dways, line;
+};
+
+static const struct csim_conf csim_conf[I960_VARIANTS] = {
+	[I960_KA] = {   512, 1,    0, 0, 16 },
+	[I960_KB] = {   512, 1,    0, 0, 16 },
+	[I960_SA] = {   512, 1,    0, 0, 16 },
+	[I960_SB] = {   512, 1,    0, 0, 16 },
+	[I960_CA] = {  1024, 2,    0, 0, 16 },
+	[I960_JF] = {  4096, 2, 2048, 1, 16 },
+	[I960_HD] = { 16384, 4, 8192, 4, 32 },
+};
+
+int i960_csim_init (struct i960_csim *o, int variant, struct i960_syms *s)
+{
+	const struct csim_conf *c;
+
+	memset (o, 0, sizeof (*o));
+
+	if (variant < 0 || variant >= I960_VARIANTS) {
+		errno = EINVAL;
+		return 0;
+	}
+
+	c = csim_conf + variant;
+	o->syms = s;
+
+	if (!i960_cache_init (&o->ic, c->isize, c->iways, c->line))
+		return 0;
+
+	if (!i960_cache_init (&o->dc, c->dsize, c->dways, c->line)) {
+		i960_cache_fini (&o->ic);
+		return 0;
+	}
+
+	return 1;
+}
+
+void i960_csim_fini (struct i960_csim *o)
+{
+	i960_cache_fini (&o->ic);
+	i960_cache_fini (&o->dc);
+	free (o->funcs);
+	o->funcs = NULL;
+}
+
+static size_t func_hash (uint32_t addr, size_t mask)
+{
+	return ((addr >> 2) * 0x9e3779b1u) & mask;
+}
+
+static struct i960_csim_func *func_slot (struct i960_csim_func *v, size_t n,
+					 uint32_t addr)
+{
+	const size_t mask = n - 1;
+	size_t i;
+
+	for (i = func_hash (addr, mask); v[i].fetches + v[i].loads != 0 &&
+					 v[i].addr != addr; i = (i + 1) & mask) {}
+
+	v[i].addr = addr;
+	return v + i;
+}
+
+static int func_grow (struct i960_csim *o)
+{
+	const size_t n = o->nfuncs == 0 ? 256 : o->nfuncs * 2;
+	struct i960_csim_func *v, *f;
+	size_t i;
+
+	if ((v = calloc (n, sizeof (v[0]))) == NULL)
+		return 0;
+
+	for (i = 0; i < o->nfuncs; ++i)
+		if (o->funcs[i].fetches + o->funcs[i].loads != 0) {
+			f = func_slot (v, n, o->funcs[i].addr);
+			*f = o->funcs[i];
+		}
+
+	free (o->funcs);
+	o->funcs  = v;
+	o->nfuncs = n;
+	return 1;
+}
+
+static struct i960_csim_func *csim_func (struct i960_csim *o, uint32_t ip)
+{
+	const struct i960_sym *s;
+	struct i960_csim_func *f;
+
+	s = o->syms == NULL ? NULL : i960_syms_lookup (o->syms, ip);
+
+	if (o->used * 2 >= o->nfuncs && !func_grow (o))
+		return NULL;
+
+	f = func_slot (o->funcs, o->nfuncs, s == NULL ? 0 : s->addr);
+
+	if (f->fetches + f->loads == 0)
+		++o->used;
+
+	return f;
+}
+
+static void csim_ctl (struct i960_cache *c, const struct i960_access *a,
+		      int icache)
+{
+	switch (a->value) {
+	case 0:	c->enabled = 0;
+		break;
+	case 1:	c->enabled = c->lines != NULL;
+		break;
+	case 2:	i960_cache_invalidate (c);
+		break;
+	case 3:	if (icache)	i960_cache_lock (c, a->addr, a->size);
+		else		i960_cache_invalidate (c);
+		break;
+	}
+}
+
+void i960_csim_feed (void *ctx, const struct i960_access *v, size_t count)
+{
+	struct i960_csim *o = ctx;
+	struct i960_csim_func *f;
+	size_t i;
+	int hit;
+
+	for (i = 0; i < count; ++i)
+		switch (v[i].kind) {
+		case I960_ACC_FETCH:
+			hit = i960_cache_read (&o->ic, v[i].addr);
+
+			if ((f = csim_func (o, v[i].ip)) != NULL) {
+				++f->fetches;
+				f->fmisses += !hit;
+			}
+			break;
+		case I960_ACC_LOAD:
+			hit = i960_cache_read (&o->dc, v[i].addr);
+
+			if ((f = csim_func (o, v[i].ip)) != NULL) {
+				++f->loads;
+				f->lmisses += !hit;
+			}
+			break;
+		case I960_ACC_STORE:
+			i960_cache_write (&o->dc, v[i].addr);
+			break;
+		case I960_ACC_ICCTL:
+			csim_ctl (&o->ic, v + i, 1);
+			break;
+		case I960_ACC_DCCTL:
+			csim_ctl (&o->dc, v + i, 0);
+			break;
+		case I960_ACC_DCINVA:
+			i960_cache_invalidate_line (&o->dc, v[i].addr);
+			break;
+		}
+}
+
+static int func_by_misses (const void *a, const void *b)
+{
+	const struct i960_csim_func *x = a, *y = b;
+	const uint64_t p = x->fmisses + x->lmisses;
+	const uint64_t q = y->fmisses + y->lmisses;
+
+	return p > q ? -1 : p < q;
+}
+
+static double ratio (uint64_t a, uint64_t b)
+{
+	return b == 0 ? 0.0 : 100.0 * a / b;
+}
+
+void i960_csim_report (FILE *to, struct i960_csim *o)
+{
+	const struct i960_sym *s;
+	struct i960_csim_func *v;
+	size_t i, n = 0;
+
+	fprintf (to, "# icache: %llu reads, %llu misses (%.2f%%)\n",
+		 (unsigned long long) o->ic.reads,
+		 (unsigned long long) o->ic.misses,
+		 ratio (o->ic.misses, o->ic.reads));
+	fprintf (to, "# dcache: %llu reads, %llu misses (%.2f%%), "
+		     "%llu writes\n",
+		 (unsigned long long) o->dc.reads,
+		 (unsigned long long) o->dc.misses,
+		 ratio (o->dc.misses, o->dc.reads),
+		 (unsigned long long) o->dc.writes);
+
+	if (o->used == 0 || (v = malloc (o->used * sizeof (v[0]))) == NULL)
+		return;
+
+	for (i = 0; i < o->nfuncs; ++i)		/* sort live entries copy */
+		if (o->funcs[i].fetches + o->funcs[i].loads != 0)
+			v[n++] = o->funcs[i];
+
+	qsort (v, n, sizeof (v[0]), func_by_misses);
+
+	fprintf (to, "%12s %12s %7s %12s %12s %7s  %s\n",
+		 "fetches", "misses", "", "loads", "misses", "", "function");
+
+	for (i = 0; i < n; ++i) {
+		const struct i960_csim_func *f = v + i;
+
+		s = o->syms == NULL ? NULL : i960_syms_lookup (o->syms, f->addr);
+
+		fprintf (to, "%12llu %12llu %6.2f%% %12llu %12llu %6.2f%%  ",
+			 (unsigned long long) f->fetches,
+			 (unsigned long long) f->fmisses,
+			 ratio (f->fmisses, f->fetches),
+			 (unsigned long long) f->loads,
+			 (unsigned long long) f->lmisses,
+			 ratio (f->lmisses, f->loads));
+
+		if (s != NULL && s->addr == f->addr)
+			fprintf (to, "%s\n", s->name);
+		else
+			fprintf (to, "0x%08x\n", f->addr);
+	}
+
+	free (v);
+}
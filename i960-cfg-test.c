@@ -0,0 +1,157 @@
+/*
+ * 80960 Control Flow Graph Recovery Test
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Graph is recovered from the switch kernel of i960-macro: call from
+ * reset stub, LCG fill, driver loop and byte dispatch over a jump table
+ * of eight cases.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <i960-cfg.h>
+
+#define ARRAY_SIZE(a)	(sizeof (a) / sizeof ((a)[0]))
+
+#define BASE		0x1000
+#define SITE		0x10b0		/* bx (r9)			*/
+#define TABLE		0x1100		/* eight case addresses		*/
+#define CASE		0x10b4		/* first case, eight bytes each	*/
+#define LOOP		0x109c		/* cases branch back here	*/
+
+static const uint32_t image[] = {
+	0x09000038, 0x08000000, 0x8c203000, 0x0019660d,	/* 1000 */
+	0x8c283000, 0x3c6ef35f, 0x3204601c, 0x70948084,	/* 1010 */
+	0x59948005, 0x92942000, 0x59840804, 0x598c4901,	/* 1020 */
+	0x08ffffe8, 0x0a000000, 0x8c803000, 0x00020000,	/* 1030 */
+	0x8c883000, 0x00000800, 0x8c903000, 0x00000003,	/* 1040 */
+	0x09ffffb8, 0x8c183000, 0x00000008, 0x5c300e00,	/* 1050 */
+	0x8c803000, 0x00020000, 0x8c883000, 0x00002000,	/* 1060 */
+	0x09000018, 0x59318010, 0x5918c901, 0x3500ffe4,	/* 1070 */
+	0x5c800606, 0x0a000000, 0x5c200e00, 0x592c0011,	/* 1080 */
+	0x5c300610, 0x8c603000, 0x00001100, 0x3231405c,	/* 1090 */
+	0x8039a000, 0x59318801, 0x5841c887, 0x904b1d08,	/* 10a0 */
+	0x84025000, 0x59210007, 0x08ffffe4, 0x58210307,	/* 10b0 */
+	0x08ffffdc, 0x59210e01, 0x08ffffd4, 0x59210e83,	/* 10c0 */
+	0x08ffffcc, 0x59210107, 0x08ffffc4, 0x70210883,	/* 10d0 */
+	0x08ffffbc, 0x58200504, 0x08ffffb4, 0x59210807,	/* 10e0 */
+	0x59210c01, 0x08ffffa8, 0x5c800604, 0x0a000000,	/* 10f0 */
+	0x000010b4, 0x000010bc, 0x000010c4, 0x000010cc,	/* 1100 */
+	0x000010d4, 0x000010dc, 0x000010e4, 0x000010ec,	/* 1110 */
+};
+
+static const struct i960_cfg_func funcs[] = {
+	{ 0x1000, I960_CFG_ENTRY  },
+	{ 0x1008, I960_CFG_CALLED },
+	{ 0x1038, I960_CFG_CALLED },
+	{ 0x1088, I960_CFG_CALLED },
+};
+
+/*
+ * Report
+ */
+static int failed, passed;
+
+__attribute__ ((format (printf, 2, 3)))
+static void check (int ok, const char *fmt, ...)
+{
+	va_list ap;
+
+	if (ok) {
+		++passed;
+		return;
+	}
+
+	printf ("FAIL ");
+
+	va_start (ap, fmt);
+	vprintf (fmt, ap);
+	va_end (ap);
+
+	printf ("\n");
+	++failed;
+}
+
+static void test_funcs (const struct i960_cfg *o)
+{
+	size_t i;
+
+	check (o->nfuncs == ARRAY_SIZE (funcs), "funcs: %zu, expected %zu",
+	       o->nfuncs, ARRAY_SIZE (funcs));
+
+	for (i = 0; i < o->nfuncs && i < ARRAY_SIZE (funcs); ++i)
+		check (o->funcs[i].entry  == funcs[i].entry &&
+		       o->funcs[i].origin == funcs[i].origin,
+		       "func %zu: %08x/%d, expected %08x/%d", i,
+		       o->funcs[i].entry, o->funcs[i].origin,
+		       funcs[i].entry, funcs[i].origin);
+}
+
+static void test_table (const struct i960_cfg *o)
+{
+	const struct i960_cfg_block *b = i960_cfg_find (o, SITE);
+	const struct i960_cfg_table *t = o->tables;
+	uint32_t to;
+	size_t i;
+
+	check (o->ntables == 1, "tables: %zu, expected 1", o->ntables);
+
+	if (o->ntables != 1)
+		return;
+
+	check (t->site == SITE && t->addr == TABLE && t->count == 8,
+	       "table: site %08x, addr %08x, count %u", t->site, t->addr,
+	       t->count);
+
+	check (b != NULL && b->end == SITE + 4 &&
+	       b->kind == I960_CFG_TABLE && b->table == 0,
+	       "dispatch block at %08x", SITE);
+
+	for (i = 0; i < t->count; ++i) {
+		to = i960_cfg_table_target (o, t, i);
+		b  = i960_cfg_find (o, to);
+
+		check (to == CASE + 8 * i, "case %zu: %08x, expected %08x",
+		       i, to, (unsigned) (CASE + 8 * i));
+
+		check (b != NULL && b->start == to &&
+		       b->kind == I960_CFG_JUMP && b->taken == LOOP,
+		       "case %zu: block at %08x", i, to);
+	}
+
+	check (i960_cfg_find (o, TABLE) == NULL, "table is not code");
+}
+
+int main (int argc, char *argv[])
+{
+	uint8_t m[sizeof (image)];
+	struct i960_cfg o;
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE (image); ++i) {
+		m[i * 4 + 0] = image[i];
+		m[i * 4 + 1] = image[i] >> 8;
+		m[i * 4 + 2] = image[i] >> 16;
+		m[i * 4 + 3] = image[i] >> 24;
+	}
+
+	if (!i960_cfg_init (&o, m, BASE, sizeof (m))) {
+		perror ("i960-cfg-test");
+		return 1;
+	}
+
+	check (i960_cfg_add_entry (&o, BASE, I960_CFG_ENTRY) &&
+	       i960_cfg_build (&o), "build");
+
+	test_funcs (&o);
+	test_table (&o);
+
+	i960_cfg_fini (&o);
+
+	printf ("i960-cfg-test: %d passed, %d failed\n", passed, failed);
+	return failed == 0 ? 0 : 1;
+}
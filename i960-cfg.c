@@ -0,0 +1,917 @@
+/*
+ * 80960 Control Flow Graph Recovery
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <i960-cfg.h>
+#include <i960-dasm.h>
+#include <i960-decode.h>
+
+#define CFG_TABLE_MAX	1024		/* entries of unbounded table	*/
+#define CFG_GLOBALS	0xffff0000	/* g0 .. fp			*/
+
+/*
+ * Register facts carried along a path, first path to reach an address
+ * wins: constants (lda, mov), index bounds (and with mask, compare and
+ * branch) and jump table loads waiting for bx.
+ */
+struct cfg_state {
+	uint32_t known, bounded, loaded;
+	uint32_t val[32], lim[32];	/* constant, index bound	*/
+	uint32_t taddr[32], tcount[32];	/* loaded from table		*/
+	int cmp_reg, cmp_rev;		/* last cmpo literal, register	*/
+	uint32_t cmp_lit;
+};
+
+struct i960_cfg_item {
+	uint32_t addr;
+	struct cfg_state s;
+};
+
+/*
+ * Image access
+ */
+static int cfg_inside (const struct i960_cfg *o, uint32_t addr)
+{
+	return (addr & 3) == 0 && addr - o->base < o->size &&
+	       o->size - (addr - o->base) >= 4;
+}
+
+static uint32_t cfg_word (const struct i960_cfg *o, uint32_t addr)
+{
+	const uint8_t *p = o->image + (addr - o->base);
+
+	if (!cfg_inside (o, addr))
+		return 0;
+
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static int cfg_read (const struct i960_cfg *o, uint32_t addr, uint32_t *x)
+{
+	if (!cfg_inside (o, addr)) {
+		errno = EFAULT;
+		return 0;
+	}
+
+	*x = cfg_word (o, addr);
+	return 1;
+}
+
+static size_t bit_index (const struct i960_cfg *o, uint32_t addr)
+{
+	return (addr - o->base) / 4;
+}
+
+static int bit_get (const struct i960_cfg *o, const uint32_t *map,
+		    uint32_t addr)
+{
+	const size_t i = bit_index (o, addr);
+
+	return (map[i / 32] >> (i % 32)) & 1;
+}
+
+static void bit_set (const struct i960_cfg *o, uint32_t *map, uint32_t addr)
+{
+	const size_t i = bit_index (o, addr);
+
+	map[i / 32] |= 1u << (i % 32);
+}
+
+static int cfg_valid (const struct i960_cfg *o, uint32_t addr)
+{
+	return cfg_inside (o, addr) && i960_dasm_name (cfg_word (o, addr));
+}
+
+static uint32_t cfg_fetch (const struct i960_cfg *o, struct i960_insn *in,
+			   uint32_t addr)
+{
+	return i960_decode (in, cfg_word (o, addr), cfg_word (o, addr + 4));
+}
+
+/*
+ * Growable arrays
+ */
+static int cfg_reserve (void **v, size_t count, size_t *avail, size_t size)
+{
+	const size_t n = *avail == 0 ? 64 : *avail * 2;
+	void *p;
+
+	if (count < *avail)
+		return 1;
+
+	if ((p = realloc (*v, n * size)) == NULL)
+		return 0;
+
+	*v     = p;
+	*avail = n;
+	return 1;
+}
+
+#define CFG_PUSH(v, n, a)  cfg_reserve ((void **) &(v), n, &(a), sizeof ((v)[0]))
+
+int i960_cfg_init (struct i960_cfg *o, const void *image, uint32_t base,
+		   uint32_t size)
+{
+	const size_t words = ((size_t) size / 4 + 31) / 32;
+
+	memset (o, 0, sizeof (*o));
+
+	o->image = image;
+	o->base  = base;
+	o->size  = size;
+	o->proc  = I960_CFG_NONE;
+
+	o->code   = calloc (words + 1, sizeof (o->code[0]));
+	o->leader = calloc (words + 1, sizeof (o->leader[0]));
+	o->entry  = calloc (words + 1, sizeof (o->entry[0]));
+
+	if (o->code == NULL || o->leader == NULL || o->entry == NULL) {
+		i960_cfg_fini (o);
+		return 0;
+	}
+
+	return 1;
+}
+
+void i960_cfg_fini (struct i960_cfg *o)
+{
+	free (o->code);
+	free (o->leader);
+	free (o->entry);
+	free (o->work);
+	free (o->blocks);
+	free (o->tables);
+	free (o->funcs);
+	memset (o, 0, sizeof (*o));
+}
+
+static int cfg_push (struct i960_cfg *o, uint32_t addr,
+		     const struct cfg_state *s)
+{
+	struct i960_cfg_item *w;
+
+	if (!cfg_inside (o, addr))
+		return 1;
+
+	bit_set (o, o->leader, addr);
+
+	if (bit_get (o, o->code, addr))
+		return 1;
+
+	if (!CFG_PUSH (o->work, o->nwork, o->awork))
+		return 0;
+
+	w = o->work + o->nwork++;
+	w->addr = addr;
+
+	if (s != NULL)
+		w->s = *s;
+	else {
+		memset (&w->s, 0, sizeof (w->s));
+		w->s.cmp_reg = -1;
+	}
+
+	return 1;
+}
+
+/*
+ * Entry Points
+ */
+int i960_cfg_add_entry (struct i960_cfg *o, uint32_t addr, int origin)
+{
+	struct i960_cfg_func *f;
+
+	if (!cfg_inside (o, addr) || bit_get (o, o->entry, addr))
+		return 1;
+
+	if (!CFG_PUSH (o->funcs, o->nfuncs, o->afuncs))
+		return 0;
+
+	bit_set (o, o->entry, addr);
+
+	f = o->funcs + o->nfuncs++;
+	f->entry  = addr;
+	f->origin = origin;
+
+	return cfg_push (o, addr, NULL);
+}
+
+/*
+ * Fault table: 32 entries of two words, handler address with type in
+ * low bits, local call if type is 00, system call otherwise; empty
+ * (zero) entries of all tables are skipped
+ */
+int i960_cfg_add_fault_table (struct i960_cfg *o, uint32_t addr)
+{
+	uint32_t x;
+	int i;
+
+	for (i = 0; i < 32; ++i) {
+		if (!cfg_read (o, addr + i * 8, &x))
+			return 0;
+
+		if (x != 0 && (x & 3) == 0 &&
+		    !i960_cfg_add_entry (o, x, I960_CFG_FAULT))
+			return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * System procedure table: 260 entries from offset 48, local (00) or
+ * supervisor (10) procedure address with type in low bits
+ */
+int i960_cfg_add_proc_table (struct i960_cfg *o, uint32_t addr)
+{
+	uint32_t x;
+	int i;
+
+	for (i = 0; i < 260; ++i) {
+		if (!cfg_read (o, addr + 48 + i * 4, &x))
+			return 0;
+
+		if (x > 3 && (x & 1) == 0 &&
+		    !i960_cfg_add_entry (o, x & ~3, I960_CFG_PROC))
+			return 0;
+	}
+
+	o->proc = addr;
+	return 1;
+}
+
+/*
+ * Interrupt table: vector n entry at offset 4 + 4n, vectors 0-7 are
+ * reserved, low bits of entry select handler type
+ */
+int i960_cfg_add_int_table (struct i960_cfg *o, uint32_t addr)
+{
+	uint32_t x;
+	int i;
+
+	for (i = 8; i < 256; ++i) {
+		if (!cfg_read (o, addr + 4 + i * 4, &x))
+			return 0;
+
+		if (x > 3 && (x & 1) == 0 &&
+		    !i960_cfg_add_entry (o, x & ~3, I960_CFG_INTR))
+			return 0;
+	}
+
+	return 1;
+}
+
+int i960_cfg_add_prcb (struct i960_cfg *o, uint32_t addr)
+{
+	uint32_t fault, intr, proc;
+
+	return	cfg_read (o, addr + 0x00, &fault) &&
+		cfg_read (o, addr + 0x10, &intr)  &&
+		cfg_read (o, addr + 0x14, &proc)  &&
+		i960_cfg_add_fault_table (o, fault) &&
+		i960_cfg_add_int_table   (o, intr)  &&
+		i960_cfg_add_proc_table  (o, proc);
+}
+
+int i960_cfg_add_boot (struct i960_cfg *o, uint32_t ibr)
+{
+	uint32_t ip, prcb;
+
+	return	cfg_read (o, ibr + 0x10, &ip)   &&
+		cfg_read (o, ibr + 0x14, &prcb) &&
+		i960_cfg_add_entry (o, ip, I960_CFG_ENTRY) &&
+		i960_cfg_add_prcb  (o, prcb);
+}
+
+/*
+ * Instruction Classes
+ */
+static int cfg_kind (const struct i960_insn *in)
+{
+	const uint32_t code = in->code;
+
+	switch (in->format) {
+	case I960_FMT_CTRL:
+		switch (code) {
+		case 0x08:  return I960_CFG_JUMP;
+		case 0x09:
+		case 0x0b:  return I960_CFG_CALL;
+		case 0x0a:  return I960_CFG_RET;
+		}
+
+		return code >= 0x10 && code < 0x18 ? I960_CFG_COND :
+						     I960_CFG_FALL;
+	case I960_FMT_COBR:
+		return code >= 0x30 ? I960_CFG_COND : I960_CFG_FALL;
+	case I960_FMT_REG:
+		return code == 0x660 ? I960_CFG_CALL : I960_CFG_FALL;
+	}
+
+	switch (code) {
+	case 0x84:
+		return in->mode == 0x0 || in->mode == 0x5 || in->mode == 0xC ?
+		       I960_CFG_JUMP : I960_CFG_INDIRECT;
+	case 0x85:
+	case 0x86:
+		return I960_CFG_CALL;
+	}
+
+	return I960_CFG_FALL;
+}
+
+/*
+ * Returns effective address of MEM instruction if registers it uses are
+ * known, index register is skipped if noindex is set
+ */
+static int cfg_efa (const struct cfg_state *s, const struct i960_insn *in,
+		    uint32_t ip, int noindex, uint32_t *efa)
+{
+	const uint32_t base = in->val[1], index = in->val[0];
+	uint32_t x = in->disp;
+
+	if (in->format == I960_FMT_MEMB && in->mode == 0x5) {
+		*efa = ip + 8 + x;
+		return 1;
+	}
+
+	if (in->kind[1] == I960_OPND_REG) {
+		if ((s->known & (1u << base)) == 0)
+			return 0;
+
+		x += s->val[base];
+	}
+
+	if (in->kind[0] == I960_OPND_REG && !noindex) {
+		if ((s->known & (1u << index)) == 0)
+			return 0;
+
+		x += s->val[index] << in->scale;
+	}
+
+	*efa = x;
+	return 1;
+}
+
+static int cfg_target (const struct i960_insn *in, uint32_t ip,
+		       uint32_t *target)
+{
+	switch (in->format) {
+	case I960_FMT_CTRL:
+	case I960_FMT_COBR:
+		*target = ip + in->disp;
+		return 1;
+	case I960_FMT_REG:
+		return 0;
+	}
+
+	switch (in->mode) {
+	case 0x0:
+	case 0xC:  *target = in->disp;		return 1;
+	case 0x5:  *target = ip + 8 + in->disp;	return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Register Facts
+ */
+static void cfg_write (struct cfg_state *s, unsigned r, unsigned n)
+{
+	const uint32_t mask = (n >= 32 ? ~0u : (1u << n) - 1) << r;
+
+	s->known   &= ~mask;
+	s->bounded &= ~mask;
+	s->loaded  &= ~mask;
+}
+
+static void cfg_const (struct cfg_state *s, unsigned r, uint32_t x)
+{
+	cfg_write (s, r, 1);
+	s->known |= 1u << r;
+	s->val[r] = x;
+}
+
+static void cfg_limit (struct cfg_state *s, unsigned r, uint32_t count)
+{
+	if (count == 0 || ((s->bounded >> r) & 1 && s->lim[r] <= count))
+		return;
+
+	s->bounded |= 1u << r;
+	s->lim[r] = count;
+}
+
+/*
+ * Apply last unsigned compare of literal N with register r on a path
+ * where condition code is one of set: 4 -- N < r, 2 -- N == r, 1 -- N > r
+ */
+static void cfg_bound (struct cfg_state *s, unsigned set)
+{
+	const unsigned r = s->cmp_reg;
+
+	if (s->cmp_reg < 0 || set == 0)
+		return;
+
+	if (s->cmp_rev)
+		set = (set & 2) | (set & 4) >> 2 | (set & 1) << 2;
+
+	if ((set & 4) == 0)
+		cfg_limit (s, r, (set & 2) == 0 ? s->cmp_lit : s->cmp_lit + 1);
+}
+
+static unsigned reg_width (uint32_t code)
+{
+	switch (code) {
+	case 0x5dc: case 0x670: case 0x671:	return 2;
+	case 0x5ec:				return 3;
+	case 0x5fc:				return 4;
+	}
+
+	return 1;
+}
+
+static unsigned mem_width (uint32_t code)
+{
+	switch (code & 0xf0) {
+	case 0x90:  return (code & 8) ? 2 : 1;
+	case 0xa0:  return 3;
+	case 0xb0:  return 4;
+	}
+
+	return 1;
+}
+
+static void cfg_reg (struct cfg_state *s, const struct i960_insn *in)
+{
+	const uint32_t a = in->val[0], b = in->val[1], c = in->val[2];
+	const int la = in->kind[0] == I960_OPND_LIT;
+	const int lb = in->kind[1] == I960_OPND_LIT;
+	const int ra = in->kind[0] == I960_OPND_REG;
+	const int rb = in->kind[1] == I960_OPND_REG;
+	struct cfg_state old;
+
+	switch (in->code) {
+	case 0x5a0:					/* cmpo */
+		if (la != lb && (ra || rb)) {
+			s->cmp_reg = la ? b : a;
+			s->cmp_lit = la ? a : b;
+			s->cmp_rev = lb;
+		}
+		return;
+	case 0x5cc:					/* mov */
+		if (in->kind[2] != I960_OPND_REG)
+			return;
+
+		if (la) {
+			cfg_const (s, c, a);
+			return;
+		}
+
+		old = *s;
+		cfg_write (s, c, 1);
+
+		if (!ra)
+			return;
+
+		s->known   |= ((old.known   >> a) & 1) << c;
+		s->bounded |= ((old.bounded >> a) & 1) << c;
+		s->loaded  |= ((old.loaded  >> a) & 1) << c;
+		s->val[c]    = old.val[a];
+		s->lim[c]    = old.lim[a];
+		s->taddr[c]  = old.taddr[a];
+		s->tcount[c] = old.tcount[a];
+		return;
+	case 0x581:					/* and */
+		if (in->kind[2] != I960_OPND_REG)
+			return;
+
+		cfg_write (s, c, 1);
+
+		if (la && lb)
+			cfg_const (s, c, a & b);
+		else if (la && (a & (a + 1)) == 0)
+			cfg_limit (s, c, a + 1);
+		else if (lb && (b & (b + 1)) == 0)
+			cfg_limit (s, c, b + 1);
+		return;
+	}
+
+	if (in->kind[2] == I960_OPND_REG)
+		cfg_write (s, c, reg_width (in->code));
+}
+
+static void cfg_mem (struct cfg_state *s, const struct i960_insn *in,
+		     uint32_t ip)
+{
+	const uint32_t code = in->code, c = in->val[2], index = in->val[0];
+	uint32_t x, count;
+
+	if (code == 0x8c) {				/* lda */
+		if (cfg_efa (s, in, ip, 0, &x))
+			cfg_const (s, c, x);
+		else
+			cfg_write (s, c, 1);
+
+		return;
+	}
+
+	if ((code & 7) != 0 || code < 0x80)		/* not a load */
+		return;
+
+	if (code != 0x90 || in->kind[0] != I960_OPND_REG || in->scale != 2 ||
+	    !cfg_efa (s, in, ip, 1, &x)) {
+		cfg_write (s, c, mem_width (code));
+		return;
+	}
+
+	count = (s->bounded >> index) & 1 ? s->lim[index] : 0;
+
+	cfg_write (s, c, 1);
+	s->loaded |= 1u << c;
+	s->taddr[c]  = x;
+	s->tcount[c] = count;
+}
+
+/*
+ * Jump Tables
+ */
+uint32_t i960_cfg_table_target (const struct i960_cfg *o,
+				const struct i960_cfg_table *t, size_t i)
+{
+	return cfg_word (o, t->addr + i * 4);
+}
+
+static int cfg_table (struct i960_cfg *o, uint32_t site, uint32_t addr,
+		      uint32_t count, const struct cfg_state *s)
+{
+	struct i960_cfg_table *t;
+	uint32_t i, n = count == 0 ? CFG_TABLE_MAX : count;
+
+	for (i = 0; i < n && cfg_inside (o, addr + i * 4); ++i)
+		if (count == 0 && !cfg_valid (o, cfg_word (o, addr + i * 4)))
+			break;
+
+	if (i == 0)
+		return 1;
+
+	if (!CFG_PUSH (o->tables, o->ntables, o->atables))
+		return 0;
+
+	t = o->tables + o->ntables++;
+	t->site  = site;
+	t->addr  = addr;
+	t->count = i;
+
+	for (n = i, i = 0; i < n; ++i)
+		if (!cfg_push (o, cfg_word (o, addr + i * 4), s))
+			return 0;
+
+	return 1;
+}
+
+/*
+ * Pass 1: mark instruction starts and block leaders following paths from
+ * pending addresses
+ */
+static int cfg_call (struct i960_cfg *o, struct cfg_state *s,
+		     const struct i960_insn *in, uint32_t ip)
+{
+	const int leaf = in->code == 0x0b || in->code == 0x85;
+	uint32_t target;
+
+	if (in->format == I960_FMT_REG) {		/* calls */
+		if (in->kind[0] == I960_OPND_LIT && o->proc != I960_CFG_NONE)
+			target = cfg_word (o, o->proc + 48 + in->val[0] * 4) & ~3;
+		else
+			target = I960_CFG_NONE;
+	}
+	else if (in->format != I960_FMT_CTRL) {
+		if (!cfg_efa (s, in, ip, 0, &target))
+			target = I960_CFG_NONE;
+	}
+	else
+		target = ip + in->disp;
+
+	if (target != I960_CFG_NONE &&
+	    !i960_cfg_add_entry (o, target,
+				 leaf ? I960_CFG_LEAF : I960_CFG_CALLED))
+		return 0;
+
+	if (leaf)
+		cfg_write (s, 0, 32);
+	else
+		s->known &= ~CFG_GLOBALS, s->bounded &= ~CFG_GLOBALS,
+		s->loaded &= ~CFG_GLOBALS;
+
+	return 1;
+}
+
+static int cfg_follow (struct i960_cfg *o, uint32_t ip, struct cfg_state *s)
+{
+	struct i960_insn in;
+	struct cfg_state taken;
+	uint32_t len, target, r;
+	int kind;
+
+	for (;;) {
+		if (!cfg_valid (o, ip) || bit_get (o, o->code, ip))
+			return 1;
+
+		bit_set (o, o->code, ip);
+		len  = cfg_fetch (o, &in, ip);
+		kind = cfg_kind (&in);
+
+		if (in.format != I960_FMT_CTRL)
+			s->cmp_reg = -1;
+
+		switch (in.format) {
+		case I960_FMT_REG:
+			cfg_reg (s, &in);
+			break;
+		case I960_FMT_COBR:
+			if (in.kind[2] == I960_OPND_REG)	/* test */
+				cfg_write (s, in.val[2], 1);
+
+			if (in.code > 0x30 && in.code < 0x37 &&
+			    in.kind[0] == I960_OPND_LIT &&
+			    in.kind[1] == I960_OPND_REG) {
+				s->cmp_reg = in.val[1];
+				s->cmp_lit = in.val[0];
+				s->cmp_rev = 0;
+			}
+			break;
+		case I960_FMT_MEMA:
+		case I960_FMT_MEMB:
+			if (kind == I960_CFG_FALL)
+				cfg_mem (s, &in, ip);
+		}
+
+		switch (kind) {
+		case I960_CFG_JUMP:
+			cfg_target (&in, ip, &target);
+			return cfg_push (o, target, s);
+		case I960_CFG_RET:
+			return 1;
+		case I960_CFG_INDIRECT:
+			r = in.val[1];
+
+			if (in.mode != 0x4 || (s->loaded & (1u << r)) == 0)
+				return 1;
+
+			return cfg_table (o, ip, s->taddr[r], s->tcount[r], s);
+		case I960_CFG_COND:
+			taken = *s;
+			cfg_bound (&taken, in.code & 7);
+			cfg_bound (s, ~in.code & 7);
+			taken.cmp_reg = s->cmp_reg = -1;
+
+			cfg_target (&in, ip, &target);
+
+			if (!cfg_push (o, target, &taken) ||
+			    !cfg_push (o, ip + len, s))
+				return 0;
+
+			break;
+		case I960_CFG_CALL:
+			if (!cfg_call (o, s, &in, ip) ||
+			    !cfg_push (o, ip + len, s))
+				return 0;
+
+			break;
+		}
+
+		if (in.format == I960_FMT_CTRL)
+			s->cmp_reg = -1;
+
+		ip += len;
+	}
+}
+
+/*
+ * Pass 2: split marked code into blocks
+ */
+static int table_cmp (const void *a, const void *b)
+{
+	const struct i960_cfg_table *x = a, *y = b;
+
+	return x->site < y->site ? -1 : x->site > y->site;
+}
+
+static int func_cmp (const void *a, const void *b)
+{
+	const struct i960_cfg_func *x = a, *y = b;
+
+	return x->entry < y->entry ? -1 : x->entry > y->entry;
+}
+
+static uint32_t cfg_table_find (const struct i960_cfg *o, uint32_t site)
+{
+	size_t lo = 0, hi = o->ntables, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+
+		if (o->tables[mid].site < site)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo < o->ntables && o->tables[lo].site == site ? lo :
+							       I960_CFG_NONE;
+}
+
+static void cfg_close (struct i960_cfg *o, struct i960_cfg_block *b,
+		       const struct i960_insn *in, uint32_t ip, uint32_t next)
+{
+	struct cfg_state none;
+
+	b->end   = next;
+	b->next  = I960_CFG_NONE;
+	b->taken = I960_CFG_NONE;
+	b->table = I960_CFG_NONE;
+	b->func  = I960_CFG_NONE;
+	b->kind  = cfg_kind (in);
+
+	switch (b->kind) {
+	case I960_CFG_FALL:
+		if (cfg_inside (o, next) && bit_get (o, o->code, next))
+			b->next = next;
+		else
+			b->kind = I960_CFG_INVALID;
+		break;
+	case I960_CFG_COND:
+		b->next = next;
+		/* fall through */
+	case I960_CFG_JUMP:
+		cfg_target (in, ip, &b->taken);
+		break;
+	case I960_CFG_CALL:
+		b->next = next;
+
+		if (in->format == I960_FMT_CTRL)
+			b->taken = ip + in->disp;
+		else if (in->format == I960_FMT_REG) {
+			if (in->kind[0] == I960_OPND_LIT &&
+			    o->proc != I960_CFG_NONE)
+				b->taken = cfg_word (o, o->proc + 48 +
+							in->val[0] * 4) & ~3;
+		}
+		else {
+			memset (&none, 0, sizeof (none));
+
+			if (!cfg_efa (&none, in, ip, 0, &b->taken))
+				b->taken = I960_CFG_NONE;
+		}
+		break;
+	case I960_CFG_INDIRECT:
+		if ((b->table = cfg_table_find (o, ip)) != I960_CFG_NONE)
+			b->kind = I960_CFG_TABLE;
+		break;
+	}
+}
+
+static int cfg_split (struct i960_cfg *o)
+{
+	const size_t words = o->size / 4;
+	struct i960_cfg_block *b;
+	struct i960_insn in;
+	uint32_t ip, next;
+	size_t i;
+
+	o->nblocks = 0;
+
+	for (i = 0; i < words; ++i) {
+		if ((o->leader[i / 32] >> (i % 32) & 1) == 0 ||
+		    (o->code[i / 32]   >> (i % 32) & 1) == 0)
+			continue;
+
+		if (!CFG_PUSH (o->blocks, o->nblocks, o->ablocks))
+			return 0;
+
+		b = o->blocks + o->nblocks++;
+		b->start = ip = o->base + i * 4;
+
+		for (;; ip = next) {
+			next = ip + cfg_fetch (o, &in, ip);
+
+			if (cfg_kind (&in) != I960_CFG_FALL ||
+			    !cfg_inside (o, next) ||
+			    !bit_get (o, o->code, next) ||
+			    bit_get (o, o->leader, next))
+				break;
+		}
+
+		cfg_close (o, b, &in, ip, next);
+	}
+
+	return 1;
+}
+
+/*
+ * Pass 3: assign blocks to functions reachable without calls
+ */
+static size_t cfg_index (const struct i960_cfg *o, uint32_t addr)
+{
+	size_t lo = 0, hi = o->nblocks, mid;
+
+	while (lo < hi) {		/* find first block above addr */
+		mid = (lo + hi) / 2;
+
+		if (o->blocks[mid].start <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo == 0 || addr >= o->blocks[lo - 1].end ? I960_CFG_NONE :
+							  lo - 1;
+}
+
+const struct i960_cfg_block *i960_cfg_find (const struct i960_cfg *o,
+					    uint32_t addr)
+{
+	const size_t i = cfg_index (o, addr);
+
+	return i == I960_CFG_NONE ? NULL : o->blocks + i;
+}
+
+static int cfg_visit (struct i960_cfg *o, uint32_t *stack, size_t *depth,
+		      uint32_t addr, uint32_t func)
+{
+	const size_t i = cfg_index (o, addr);
+
+	if (i == I960_CFG_NONE || o->blocks[i].start != addr ||
+	    o->blocks[i].func != I960_CFG_NONE)
+		return 0;
+
+	o->blocks[i].func = func;
+	stack[(*depth)++] = i;
+	return 1;
+}
+
+static int cfg_own (struct i960_cfg *o)
+{
+	uint32_t *stack, f, k;
+	const struct i960_cfg_block *b;
+	const struct i960_cfg_table *t;
+	size_t depth;
+
+	if ((stack = malloc ((o->nblocks + 1) * sizeof (stack[0]))) == NULL)
+		return 0;
+
+	for (f = 0; f < o->nfuncs; ++f) {
+		depth = 0;
+		cfg_visit (o, stack, &depth, o->funcs[f].entry, f);
+
+		while (depth > 0) {
+			b = o->blocks + stack[--depth];
+
+			if (b->kind == I960_CFG_JUMP || b->kind == I960_CFG_COND)
+				cfg_visit (o, stack, &depth, b->taken, f);
+
+			if (b->next != I960_CFG_NONE)
+				cfg_visit (o, stack, &depth, b->next, f);
+
+			if (b->kind != I960_CFG_TABLE)
+				continue;
+
+			t = o->tables + b->table;
+
+			for (k = 0; k < t->count; ++k)
+				cfg_visit (o, stack, &depth,
+					   i960_cfg_table_target (o, t, k), f);
+		}
+	}
+
+	free (stack);
+	return 1;
+}
+
+int i960_cfg_build (struct i960_cfg *o)
+{
+	struct i960_cfg_item w;
+
+	while (o->nwork > 0) {
+		w = o->work[--o->nwork];
+
+		if (!cfg_follow (o, w.addr, &w.s))
+			return 0;
+	}
+
+	if (o->ntables > 1)
+		qsort (o->tables, o->ntables, sizeof (o->tables[0]), table_cmp);
+
+	if (o->nfuncs > 1)
+		qsort (o->funcs, o->nfuncs, sizeof (o->funcs[0]), func_cmp);
+
+	return cfg_split (o) && cfg_own (o);
+}
@@ -0,0 +1,318 @@
+/*
+ * 80960 Emulator Call Graph Profiler
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <i960-emu-cg.h>
+
+static uint64_t cg_now (struct i960_cg *o)
+{
+	return o->clock == NULL ? 0 : *o->clock;
+}
+
+static void cg_tick (struct i960_cg *o)		/* charge current context */
+{
+	const uint64_t now = cg_now (o);
+	const uint32_t node = o->depth == 0 ? 0 : o->stack[o->depth - 1].node;
+
+	o->nodes[node].self += now - o->last;
+	o->last = now;
+}
+
+static uint32_t cg_node (struct i960_cg *o, uint32_t parent, uint32_t addr)
+{
+	const size_t avail = o->avail * 2;
+	struct i960_cg_node *v;
+	uint32_t i;
+
+	for (i = o->nodes[parent].child; i != 0; i = o->nodes[i].next)
+		if (o->nodes[i].addr == addr)
+			return i;
+
+	if (o->count == o->avail) {
+		if ((v = realloc (o->nodes, avail * sizeof (v[0]))) == NULL)
+			return parent;
+
+		o->nodes = v;
+		o->avail = avail;
+	}
+
+	i = o->count++;
+	memset (o->nodes + i, 0, sizeof (o->nodes[i]));
+
+	o->nodes[i].addr   = addr;
+	o->nodes[i].parent = parent;
+	o->nodes[i].next   = o->nodes[parent].child;
+	o->nodes[parent].child = i;
+	return i;
+}
+
+int i960_cg_init (struct i960_cg *o, const uint64_t *clock)
+{
+	memset (o, 0, sizeof (*o));
+
+	if ((o->nodes = calloc (256, sizeof (o->nodes[0]))) == NULL)
+		return 0;
+
+	o->clock = clock;
+	o->last  = cg_now (o);
+	o->count = 1;			/* node 0 is root context	*/
+	o->avail = 256;
+	return 1;
+}
+
+void i960_cg_fini (struct i960_cg *o)
+{
+	free (o->nodes);
+	o->nodes = NULL;
+}
+
+/*
+ * Chrome Trace Events
+ */
+static void cg_name (FILE *to, struct i960_cg *o, uint32_t addr)
+{
+	const struct i960_sym *s;
+
+	s = o->syms == NULL ? NULL : i960_syms_lookup (o->syms, addr);
+
+	if (s != NULL && s->addr == addr)
+		fprintf (to, "%s", s->name);
+	else if (s != NULL)
+		fprintf (to, "%s+0x%x", s->name, addr - s->addr);
+	else
+		fprintf (to, "0x%08x", addr);
+}
+
+static void cg_event (struct i960_cg *o, uint32_t addr, char ph)
+{
+	if (o->trace == NULL)
+		return;
+
+	fprintf (o->trace, "{\"name\": \"");
+	cg_name (o->trace, o, addr);
+	fprintf (o->trace, "\", \"ph\": \"%c\", \"ts\": %llu, \"pid\": 0, "
+			   "\"tid\": %d},\n",
+		 ph, (unsigned long long) o->last, o->tid);
+}
+
+void i960_cg_trace_start (struct i960_cg *o, FILE *to, int tid)
+{
+	o->trace = to;
+	o->tid   = tid;
+
+	fprintf (to, "[\n");
+}
+
+void i960_cg_trace_finish (struct i960_cg *o)
+{
+	size_t i;
+
+	if (o->trace == NULL)
+		return;
+
+	cg_tick (o);
+
+	for (i = o->depth; i > 0; --i)
+		cg_event (o, o->nodes[o->stack[i - 1].node].addr, 'E');
+
+	fprintf (o->trace, "{}]\n");
+	o->trace = NULL;
+}
+
+/*
+ * Shadow Stack
+ */
+void i960_cg_enter (struct i960_cg *o, uint32_t addr, uint32_t link)
+{
+	struct i960_cg_frame *f = o->stack + o->depth;
+	uint32_t parent;
+
+	cg_tick (o);
+
+	if (o->depth == I960_CG_DEPTH) {
+		if (link != 0)
+			++o->leaves;
+		else
+			++o->lost;
+		return;
+	}
+
+	parent = o->depth == 0 ? 0 : f[-1].node;
+
+	f->node  = cg_node (o, parent, addr);
+	f->link  = link;
+	f->start = o->last;
+
+	++o->nodes[f->node].calls;
+	++o->depth;
+
+	cg_event (o, addr, 'B');
+}
+
+static void cg_pop (struct i960_cg *o)
+{
+	struct i960_cg_frame *f = o->stack + --o->depth;
+
+	o->nodes[f->node].total += o->last - f->start;
+	cg_event (o, o->nodes[f->node].addr, 'E');
+}
+
+/*
+ * Frames beyond stack are counted only: ret drops leaf frames above call
+ * frame it closes, bx closes lost leaf frame before any tracked one
+ */
+void i960_cg_leave (struct i960_cg *o)
+{
+	cg_tick (o);
+
+	o->leaves = 0;
+
+	if (o->lost > 0) {
+		--o->lost;
+		return;
+	}
+
+	while (o->depth > 0 && o->stack[o->depth - 1].link != 0)
+		cg_pop (o);			/* unwind leaf frames	*/
+
+	if (o->depth > 0)
+		cg_pop (o);
+}
+
+void i960_cg_leaf_leave (struct i960_cg *o, uint32_t addr)
+{
+	if (o->leaves > 0) {
+		--o->leaves;
+		return;
+	}
+
+	if (o->lost > 0 || o->depth == 0 || o->stack[o->depth - 1].link != addr)
+		return;
+
+	cg_tick (o);
+	cg_pop (o);
+}
+
+/*
+ * Reports
+ */
+static void cg_path (FILE *to, struct i960_cg *o, uint32_t node)
+{
+	if (o->nodes[node].parent != 0) {
+		cg_path (to, o, o->nodes[node].parent);
+		fputc (';', to);
+	}
+
+	cg_name (to, o, o->nodes[node].addr);
+}
+
+void i960_cg_folded (FILE *to, struct i960_cg *o)
+{
+	size_t i;
+
+	cg_tick (o);
+
+	if (o->nodes[0].self > 0)
+		fprintf (to, "[root] %llu\n",
+			 (unsigned long long) o->nodes[0].self);
+
+	for (i = 1; i < o->count; ++i)
+		if (o->nodes[i].self > 0) {
+			cg_path (to, o, i);
+			fprintf (to, " %llu\n",
+				 (unsigned long long) o->nodes[i].self);
+		}
+}
+
+struct cg_func {
+	uint32_t addr;
+	uint64_t calls, self, total;
+};
+
+static int func_by_total (const void *a, const void *b)
+{
+	const struct cg_func *x = a, *y = b;
+
+	return x->total > y->total ? -1 : x->total < y->total;
+}
+
+static int cg_recursive (struct i960_cg *o, uint32_t node)
+{
+	uint32_t i;
+
+	for (i = o->nodes[node].parent; i != 0; i = o->nodes[i].parent)
+		if (o->nodes[i].addr == o->nodes[node].addr)
+			return 1;
+
+	return 0;
+}
+
+void i960_cg_report (FILE *to, struct i960_cg *o)
+{
+	struct cg_func *v;
+	const struct i960_cg_node *p;
+	uint64_t total = 0;
+	size_t i, j, n = 0;
+
+	cg_tick (o);
+
+	if ((v = malloc (o->count * sizeof (v[0]))) == NULL)
+		return;
+
+	for (i = 0; i < o->count; ++i)
+		total += o->nodes[i].self;
+
+	for (i = 1; i < o->count; ++i) {
+		p = o->nodes + i;
+
+		for (j = 0; j < n && v[j].addr != p->addr; ++j) {}
+
+		if (j == n) {
+			memset (v + n, 0, sizeof (v[n]));
+			v[n++].addr = p->addr;
+		}
+
+		v[j].calls += p->calls;
+		v[j].self  += p->self;
+
+		if (!cg_recursive (o, i))	/* count outermost only	*/
+			v[j].total += p->total;
+	}
+
+	for (i = o->depth; i > 0; --i) {	/* account open frames	*/
+		p = o->nodes + o->stack[i - 1].node;
+
+		for (j = 0; j < n && v[j].addr != p->addr; ++j) {}
+
+		if (j == n)			/* root context		*/
+			continue;
+
+		if (!cg_recursive (o, o->stack[i - 1].node))
+			v[j].total += o->last - o->stack[i - 1].start;
+	}
+
+	qsort (v, n, sizeof (v[0]), func_by_total);
+
+	fprintf (to, "%12s %7s %12s %7s %10s  %s\n",
+		 "inclusive", "", "exclusive", "", "calls", "function");
+
+	for (i = 0; i < n; ++i) {
+		fprintf (to, "%12llu %6.2f%% %12llu %6.2f%% %10llu  ",
+			 (unsigned long long) v[i].total,
+			 total == 0 ? 0.0 : 100.0 * v[i].total / total,
+			 (unsigned long long) v[i].self,
+			 total == 0 ? 0.0 : 100.0 * v[i].self / total,
+			 (unsigned long long) v[i].calls);
+		cg_name (to, o, v[i].addr);
+		fputc ('\n', to);
+	}
+
+	free (v);
+}
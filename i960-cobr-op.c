@@ -15,38 +15,50 @@
  * 27  testo	2F  -		37  bbs		3F  cmpibo
  */
 
+#include <i960-decode.h>
 #include <i960-emu.h>
+#include <i960-emu-acct.h>
 #include <i960-emu-bits.h>
 #include <i960-emu-branch.h>
 #include <i960-emu-compare.h>
+#include <i960-emu-faults.h>
+#include <i960-emu-ops.h>
+#include <i960-emu-stat.h>
 
 static inline
-void cobr_testcc (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, int32_t disp)
+void cobr_testcc (struct i960 *o, const struct i960_insn *in, uint32_t a,
+		  uint32_t b, uint32_t efa)
 {
-	const size_t c = u32_extract (op, 19, 5);
+	const uint32_t cc = i960_check_cond (o, in->op);
 
-	o->r[c] = i960_check_cond (o, op);
+	if (in->kind[2] == I960_OPND_SFR)
+		o->sf[in->val[2]] = cc;
+	else
+		o->r[in->val[2]] = cc;
 }
 
 static inline
-void cobr_bb (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, int32_t disp)
+void cobr_bb (struct i960 *o, const struct i960_insn *in, uint32_t a,
+	      uint32_t b, uint32_t efa)
 {
-	const int C0 = u32_bit_select (op, 24 + 0);	/* ---1 0--x */
+	const int C0 = u32_bit_select (in->code, 0);	/* ---1 0--x */
 	const int ok = !(u32_bit_select (b, a) ^ C0);
 
 	i960_set_cond (o, ok ? 2 : 0);
+	i960_bstat_cond (o, in->op, ok);
 
 	if (ok)
-		i960_b (o, o->ip + disp);
+		i960_br (o, efa);
 }
 
 static inline
-void cobr_cmpbcc (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, int32_t disp)
+void cobr_cmpbcc (struct i960 *o, const struct i960_insn *in, uint32_t a,
+		  uint32_t b, uint32_t efa)
 {
-	const int C3 = u32_bit_select (op, 24 + 3);	/* ---1 x--- */
+	const int C3 = u32_bit_select (in->code, 3);	/* ---1 x--- */
 
 	i960_cmp (o, a, b, C3);
-	i960_bcc (o, op, o->ip + disp);
+	i960_bcc (o, in->op, efa);
 }
 
 /*
@@ -54,27 +66,43 @@ void cobr_cmpbcc (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, int32_t d
  *
  * decoder height = mux + max (mux, 3 * nand/nor) <= 4
  */
-static
-void cobr_op (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, int32_t disp)
+static void cobr_op (struct i960 *o, const struct i960_insn *in, uint32_t a,
+		     uint32_t b, uint32_t efa)
 {
-	const int C4 = u32_bit_select (op, 24 + 4);	/* ---x ---- */
+	const int C4 = u32_bit_select (in->code, 4);	/* ---x ---- */
+	const uint32_t i = in->code & 15;		/* ---- xxxx */
 
 	if (!C4)
-		cobr_testcc (o, op, a, b, disp);	/* ---0 ---- */
+		cobr_testcc (o, in, a, b, efa);		/* ---0 ---- */
 	else
-	if (op == 0x30 || op == 0x37)			/* ---1 -000 */
-		cobr_bb     (o, op, a, b, disp);	/* ---1 -111 */
+	if (i == 0 || i == 7)				/* ---1 0000 */
+		cobr_bb     (o, in, a, b, efa);		/* ---1 0111 */
 	else
-		cobr_cmpbcc (o, op, a, b, disp);
+		cobr_cmpbcc (o, in, a, b, efa);
 }
 
-void i960_cobr (struct i960 *o, uint32_t op, uint32_t ip)
+/*
+ * Operands come from shared decoder: src1 is register or literal, src2
+ * and test destination are register or special function register
+ */
+void i960_cobr (struct i960 *o, const struct i960_insn *in, uint32_t ip)
 {
-	const uint32_t ai = u32_extract (op, 19, 5);
-	const uint32_t bi = u32_extract (op, 14, 5);
-	const uint32_t a  = u32_bit_select (op, 13) ? ai : o->r[ai];
-	const uint32_t b  = o->r[bi];
-	const int32_t disp = (((int32_t) op << 19) >> 19) & ~3;
+	const uint32_t a = in->kind[0] == I960_OPND_LIT ? in->val[0] :
+							   o->r[in->val[0]];
+	uint32_t b = o->r[in->val[1]];
+
+	if (in->kind[1] == I960_OPND_SFR) {
+		if (!i960_check_sfr (o, in->val[1]))
+			return;
+
+		b = o->sf[in->val[1]];
+	}
+
+	if (in->kind[2] == I960_OPND_SFR && !i960_check_sfr (o, in->val[2]))
+		return;
 
-	cobr_op (o, op, a, b, disp);
+	i960_stat_cobr (o, in->op);
+	i960_acct_enter (o, I960_ACCT_BRANCH);
+	cobr_op (o, in, a, b, ip + in->disp);
+	i960_acct_leave (o);
 }
@@ -0,0 +1,110 @@
+/*
+ * 80960 Emulator Benchmark Run Comparison
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <i960-results.h>
+#include <i960-sample.h>
+
+/*
+ * Change is significant when rank test rejects equality at level alpha
+ * and median moved more than threshold: a statistically real but tiny
+ * shift is not worth flagging
+ */
+static double alpha = 0.05, threshold = 0.02;
+
+static void show_header (const char *label, const struct i960_results *o)
+{
+	printf ("# %s: %s %s, %s, %s\n", label,
+		o->tool     != NULL ? o->tool     : "?",
+		o->revision != NULL ? o->revision : "?",
+		o->date     != NULL ? o->date     : "?",
+		o->cpu      != NULL ? o->cpu      : "?");
+}
+
+static int compare (const struct i960_result *a, const struct i960_result *b)
+{
+	const double ma = i960_sample_median (a->v, a->n);
+	const double mb = i960_sample_median (b->v, b->n);
+	const double change = ma > 0 ? mb / ma - 1 : 0;
+	const double p = i960_sample_mwu (a->v, a->n, b->v, b->n);
+	const int sig = p < alpha && (change > threshold || -change > threshold);
+	const char *verdict = !sig ? "same" : change < 0 ? "REGRESSION" :
+				     "improvement";
+
+	printf ("%-16s %-8s %10.2f %10.2f %+7.1f%% %8.4f  %s\n",
+		a->name, a->mode, ma, mb, change * 100, p, verdict);
+
+	return sig && change < 0;
+}
+
+static int usage (void)
+{
+	fprintf (stderr, "usage:\n\ti960-compare [-a alpha] [-t threshold%%] "
+			 "base.res new.res\n");
+	return 2;
+}
+
+int main (int argc, char *argv[])
+{
+	struct i960_results base, next;
+	const struct i960_result *r;
+	int opt, bad = 0;
+	size_t i;
+
+	while ((opt = getopt (argc, argv, "a:t:")) != -1)
+		switch (opt) {
+		case 'a':  alpha     = atof (optarg);		break;
+		case 't':  threshold = atof (optarg) / 100;	break;
+		default:
+			return usage ();
+		}
+
+	if (argc - optind != 2 || alpha <= 0 || alpha >= 1 || threshold < 0)
+		return usage ();
+
+	if (!i960_results_load (&base, argv[optind])) {
+		perror (argv[optind]);
+		return 2;
+	}
+
+	if (!i960_results_load (&next, argv[optind + 1])) {
+		perror (argv[optind + 1]);
+		i960_results_fini (&base);
+		return 2;
+	}
+
+	show_header ("base", &base);
+	show_header ("new ", &next);
+
+	if (base.cpu != NULL && next.cpu != NULL &&
+	    strcmp (base.cpu, next.cpu) != 0)
+		printf ("# warning: runs were made on different host CPUs\n");
+
+	printf ("%-16s %-8s %10s %10s %8s %8s  %s\n", "benchmark", "mode",
+		"base MIPS", "new MIPS", "change", "p-value", "verdict");
+
+	for (i = 0; i < base.count; ++i) {
+		r = i960_results_find (&next, base.v[i].name, base.v[i].mode);
+
+		if (r == NULL)
+			printf ("%-16s %-8s %10.2f %10s\n", base.v[i].name,
+				base.v[i].mode, i960_sample_median
+				(base.v[i].v, base.v[i].n), "missing");
+		else
+			bad |= compare (base.v + i, r);
+	}
+
+	i960_results_fini (&base);
+	i960_results_fini (&next);
+	return bad;
+}
@@ -6,11 +6,16 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <i960-decode.h>
 #include <i960-emu.h>
+#include <i960-emu-acct.h>
+#include <i960-emu-alog.h>
 #include <i960-emu-bits.h>
 #include <i960-emu-branch.h>
 #include <i960-emu-compare.h>
 #include <i960-emu-faults.h>
+#include <i960-emu-ops.h>
+#include <i960-emu-stat.h>
 
 static inline uint32_t i960_read_lock (struct i960 *o, uint32_t addr)
 {
@@ -36,19 +41,23 @@ static inline uint32_t u32_modify (uint32_t old, uint32_t new, uint32_t mask)
 static inline int i960_div_check (struct i960 *o, uint32_t d)
 {
 	if (d == 0)
-		i960_fault (o, 0x30002);	/* division by zero */
+		i960_raise (o, 0x30002);	/* division by zero */
 
 	return d != 0;
 }
 
-static inline int i960_check_em (struct i960 *o)
+/*
+ * Word n of multi-word src1 (slot 0) or src2 (slot 1) operand: literal
+ * and special function register operands are single-word
+ */
+static inline
+uint32_t i960_src_word (const struct i960 *o, uint32_t op, int slot, int n)
 {
-	const int em = u32_bit_select (o->pc, I960_EM_POS);
-
-	if (em == 0)
-		i960_fault (o, 0xa0001);	/* type mismatch */
+	const uint32_t i = u32_extract (op, slot ? 14 : 0, 5);
+	const int M = u32_bit_select (op, 11 + slot);
+	const int S = u32_bit_select (op,  5 + slot);
 
-	return em;
+	return M | S ? 0 : o->r[i | n];
 }
 
 /*
@@ -82,15 +91,6 @@ static inline char u32_sbb (uint32_t *r, uint32_t x, uint32_t y, char c)
 	return c + u32_sub (r, x, a);
 }
 
-/*
- * FPU Not Implemented
- */
-static inline
-void i960_fpu (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
-{
-	i960_on_undef (o);
-}
-
 /*
  *
  */
@@ -307,7 +307,7 @@ void reg_addx (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 static inline
 void reg_eshro (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
-	const uint32_t bh = o->r[u32_extract (op, 14, 5) | 1];
+	const uint32_t bh = i960_src_word (o, op, 1, 1);
 	const uint64_t bl = (uint64_t) bh << 32 | b;
 
 	o->r[c] = (bl >> (a & 31));		/* (bh, bl) >> (n & 31) */
@@ -545,12 +545,11 @@ static inline
 void reg_move (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
 	const uint32_t i = u32_extract (op, 24 + 0, 2);  /* ---- -1xx */
-	const size_t src = u32_extract (op, 0, 5);
 
 	switch (i) {
-	case 3:  o->r[c | 3] = o->r[src | 3];
-	case 2:  o->r[c | 2] = o->r[src | 2];
-	case 1:  o->r[c | 1] = o->r[src | 1];
+	case 3:  o->r[c | 3] = i960_src_word (o, op, 0, 3);
+	case 2:  o->r[c | 2] = i960_src_word (o, op, 0, 2);
+	case 1:  o->r[c | 1] = i960_src_word (o, op, 0, 1);
 	case 0:  o->r[c | 0] = a;
 	}
 }
@@ -573,6 +572,9 @@ void reg_core (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
 	const uint32_t i = u32_extract (op, 24 + 0, 3);  /* ---- -xxx */
 
+	i960_stat_reg (o, op);
+	i960_acct_enter (o, I960_ACCT_ALU);
+
 	switch (i) {
 	case 0:  reg_log (o, op, a, b, c);  break;  /* -000		*/
 	case 1:  reg_59  (o, op, a, b, c);  break;  /* -001		*/
@@ -583,11 +585,13 @@ void reg_core (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 	case 6:  reg_5C  (o, op, a, b, c);  break;  /* -1--  filler	*/
 	case 7:  reg_5C  (o, op, a, b, c);  break;  /* -1--		*/
 	}
+
+	i960_acct_leave (o);
 }
 
 /*
- * 600  synmov	601  synmovl	602  synmovq	603  -
- * 604  -	605  -		606  -		607  -
+ * 600  synmov	601  synmovl	602  synmovq	603  cmpstr
+ * 604  movqstr	605  movstr	606  -		607  -
  * 608  -	609  -		60A  -		60B  -
  * 60C  -	60D  -		60E  -		60F  -
  *
@@ -596,14 +600,19 @@ void reg_core (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 static inline
 void reg_synmov (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
-	i960_on_undef (o);
+	const uint32_t i = u32_extract (op, 7, 4);
+
+	if (i >= 3 && i <= 5)
+		i960_string (o, op, a, b, c);
+	else
+		i960_on_undef (o);
 }
 
 /*
  * 80960 REG Format: Atomic Operations
  *
  * 610  atmod	611  -		612  atadd	613  -
- * 614  -	615  -		616  -		617  -
+ * 614  -	615  -		616  -		617  fill
  * 618  -	619  -		61A  -		61B  -
  * 61C  -	61D  -		61E  -		61F  -
  *
@@ -622,6 +631,15 @@ void reg_atomic (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 	o->r[c] = old;
 }
 
+static inline
+void reg_61 (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
+{
+	if (u32_extract (op, 7, 4) == 7)
+		i960_string (o, op, a, b, c);
+	else
+		reg_atomic (o, op, a, b, c);
+}
+
 /*
  * 620  -	621  -		622  -		623  -
  * 624  -	625  -		626  -		627  -
@@ -720,12 +738,54 @@ void reg_modpc (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 	/* check pending interrupts here */
 }
 
+/*
+ * There are no caches here: cache control operations are passed to access
+ * log consumers (cache simulator), status requests return zero.
+ *
+ * a -- operation type, b -- address, r[c] -- lines to lock or status
+ */
+static inline
+void reg_icctl (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
+{
+	if (!i960_check_em (o))
+		return;
+
+	i960_alog (o, I960_ACC_ICCTL, b, o->r[c], a);
+
+	if (a == 4 || a == 5)		/* get status, get lock status	*/
+		o->r[c] = 0;
+}
+
+static inline
+void reg_dcctl (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
+{
+	if (!i960_check_em (o))
+		return;
+
+	i960_alog (o, I960_ACC_DCCTL, b, o->r[c], a);
+
+	if (a == 4 || a == 5)
+		o->r[c] = 0;
+}
+
+/*
+ * F3  -- system control vs bit field ops
+ */
 static inline
 void reg_65 (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
+	const int F  = u32_extract (op, 7, 3);
 	const int F0 = u32_bit_select (op, 7 + 0);
 	const int F2 = u32_bit_select (op, 7 + 2);
+	const int F3 = u32_bit_select (op, 7 + 3);
 
+	if (F3)
+		switch (F) {
+		case 3:  reg_icctl (o, op, a, b, c);  break;
+		case 4:  reg_dcctl (o, op, a, b, c);  break;
+		default: i960_on_undef (o);
+		}
+	else
 	if (F2)
 		if (F0) reg_modpc (o, op, a, b, c);
 		else    reg_modtc (o, op, a, b, c);
@@ -757,7 +817,7 @@ void reg_fmark (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 static inline
 void reg_flushreg (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
-	/* nothing to do */
+	i960_stat_flush (o);	/* nothing to do, but register cache model */
 }
 
 static inline
@@ -766,13 +826,33 @@ void reg_syncf (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 	/* nothing to do */
 }
 
+static inline
+void reg_calls (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
+{
+	i960_stat_call (o);
+	i960_calls (o, a);
+	i960_on_call (o, o->ip);
+}
+
+/*
+ * F3  -- mark/sync ops vs calls
+ * F2  -- fmark, flushreg, syncf vs mark
+ * F1  -- syncf vs fmark/flushreg
+ * F0  -- flushreg vs fmark
+ */
 static inline
 void reg_66 (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
+	const int F0 = u32_bit_select (op, 7 + 0);
+	const int F1 = u32_bit_select (op, 7 + 1);
+	const int F2 = u32_bit_select (op, 7 + 2);
 	const int F3 = u32_bit_select (op, 7 + 3);
 
-	if (!F3)
-		i960_calls (o, a);
+	if (!F3)	reg_calls    (o, op, a, b, c);
+	else if (!F2)	reg_mark     (o, op, a, b, c);
+	else if (F1)	reg_syncf    (o, op, a, b, c);
+	else if (F0)	reg_flushreg (o, op, a, b, c);
+	else		reg_fmark    (o, op, a, b, c);
 }
 
 /*
@@ -796,7 +876,7 @@ void reg_emul (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 static inline
 void reg_ediv (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
-	const uint32_t bh = o->r[u32_extract (op, 14, 5) | 1];
+	const uint32_t bh = i960_src_word (o, op, 1, 1);
 	const uint64_t bl = (uint64_t) bh << 32 | b;
 	const int ok = i960_div_check (o, a);
 
@@ -823,16 +903,21 @@ void reg_supp (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
 	const uint32_t i = u32_extract (op, 24 + 0, 3);  /* ---- -xxx */
 
+	i960_stat_reg (o, op);
+	i960_acct_enter (o, I960_ACCT_ALU);
+
 	switch (i) {
 	case 0:  reg_synmov (o, op, a, b, c);  break;  /* -000		*/
-	case 1:  reg_atomic (o, op, a, b, c);  break;  /* -001		*/
+	case 1:  reg_61     (o, op, a, b, c);  break;  /* -001		*/
 	case 2:  reg_synmov (o, op, a, b, c);  break;  /* -010	filler	*/
-	case 3:  reg_atomic (o, op, a, b, c);  break;  /* -011	filler	*/
+	case 3:  reg_61     (o, op, a, b, c);  break;  /* -011	filler	*/
 	case 4:  reg_64     (o, op, a, b, c);  break;  /* -100		*/
 	case 5:  reg_65     (o, op, a, b, c);  break;  /* -101		*/
 	case 6:  reg_66     (o, op, a, b, c);  break;  /* -110		*/
 	case 7:  reg_67     (o, op, a, b, c);  break;  /* -111		*/
 	}
+
+	i960_acct_leave (o);
 }
 
 /*
@@ -865,9 +950,9 @@ void reg_supp (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
  * 6D8  -	6D9  movrl	6DA  -		6DB  -
  * 6DC  -	6DD  -		6DE  -		6DF  -
  *
- * 6E0  -	6E1  -		6E2  cpysre	6E3  cpyrsre
+ * 6E0  -	6E1  movre	6E2  cpysre	6E3  cpyrsre
  * 6E4  -	6E5  -		6E6  -		6E7  -
- * 6E8  -	6E9  movre	6EA  -		6EB  -
+ * 6E8  -	6E9  -		6EA  -		6EB  -
  * 6EC  -	6ED  -		6EE  -		6EF  -
  *
  * scale  -- ldexp(3)
@@ -891,10 +976,14 @@ void reg_supp (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 /*
  * op 68..6F
  */
-static inline
 void reg_fpu (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
+	i960_stat_reg (o, op);
+	i960_acct_enter (o, I960_ACCT_ALU);
+
 	i960_fpu (o, op, a, b, c);
+
+	i960_acct_leave (o);
 }
 
 /*
@@ -987,8 +1076,13 @@ void reg_muldiv (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
 	const int C2 = u32_bit_select (op, 24 + 2);
 
+	i960_stat_reg (o, op);
+	i960_acct_enter (o, I960_ACCT_ALU);
+
 	if (C2)	reg_74 (o, op, a, b, c);
 	else	reg_70 (o, op, a, b, c);
+
+	i960_acct_leave (o);
 }
 
 /*
@@ -1011,14 +1105,21 @@ void reg_muldiv (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 static inline
 void reg_addcc (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
-	if (i960_check_cond (o, op))
+	const int ok = i960_check_cond (o, op);
+
+	i960_bstat_cond (o, op, ok);
+
+	if (ok)
 		reg_add (o, op, a, b, c);
 }
 
 static inline
 void reg_selcc (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
-	o->r[c] = i960_check_cond (o, op) ? b : a;
+	const int ok = i960_check_cond (o, op);
+
+	i960_bstat_cond (o, op, ok);
+	o->r[c] = ok ? b : a;
 }
 
 /*
@@ -1029,22 +1130,118 @@ void reg_cond (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 	const int F2 = u32_bit_select (op, 7 + 2);
 	const int F3 = u32_bit_select (op, 7 + 3);
 
+	i960_stat_reg (o, op);
+	i960_acct_enter (o, I960_ACCT_ALU);
+
 	if (F3) i960_fpu  (o, op, a, b, c);
 	else
 	if (F2)	reg_selcc (o, op, a, b, c);
 	else	reg_addcc (o, op, a, b, c);
+
+	i960_acct_leave (o);
 }
 
-#if 0
-void reg_op (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
+/*
+ * 80960 REG Format: Operand Front End
+ *
+ * Operand kinds come from i960_decode. Register and literal operands
+ * resolve in place, operations with sfr go slow path. FPU operations get
+ * register index or constant selector of real operands (SFR kind) and
+ * resolve them in reg_fpu.
+ */
+static inline
+void reg_exec (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
 {
-	const uint32_t i = u32_extract (op, 24 + 4, 2);  /* --xx ---- */
+	const uint32_t i = u32_extract (op, 27, 5);	/* xxxx x--- */
 
 	switch (i) {
-	case 0:  reg_core (o, op, a, b, c);  break;  /* --0-		*/
-	case 1:  reg_core (o, op, a, b, c);  break;  /* --0-  filler	*/
-//	case 2:  reg_supp (o, op, a, b, c);  break;  /* --10		*/
-//	case 3:  reg_fpu  (o, op, a, b, c);  break;  /* --11		*/
+	case 0x0B:  reg_core   (o, op, a, b, c);  break;	/* 58..5F */
+	case 0x0C:  reg_supp   (o, op, a, b, c);  break;	/* 60..67 */
+	case 0x0D:  reg_fpu    (o, op, a, b, c);  break;	/* 68..6F */
+	case 0x0E:  reg_muldiv (o, op, a, b, c);  break;	/* 70..77 */
+	case 0x0F:  reg_cond   (o, op, a, b, c);  break;	/* 78..7F */
+	default:    i960_on_undef (o);
 	}
 }
-#endif
+
+static inline
+uint32_t reg_arg (struct i960 *o, const struct i960_insn *in, int slot)
+{
+	const uint32_t i = in->val[slot];
+
+	return in->kind[slot] == I960_OPND_REG ? o->r[i] : i;
+}
+
+/*
+ * Source operand with sfr: reserved S with M decodes as none, sf3-sf31
+ * are not implemented
+ */
+static int reg_sfr_src (struct i960 *o, const struct i960_insn *in, int slot,
+			uint32_t *x)
+{
+	const uint32_t i = in->val[slot];
+
+	switch (in->kind[slot]) {
+	case I960_OPND_REG:  *x = o->r[i];  return 1;
+	case I960_OPND_LIT:  *x = i;        return 1;
+	case I960_OPND_SFR:
+		if (i >= I960_SF_COUNT)
+			return 0;
+
+		*x = o->sf[i];
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Special function registers are supervisor-only. Operation with sfr
+ * destination writes to scratch register preloaded with sfr value, as
+ * read-modify-write operations (modify, atmod) use it as source too.
+ */
+static void reg_sfr (struct i960 *o, const struct i960_insn *in)
+{
+	const size_t c = in->val[2];
+	const int    D = in->kind[2] == I960_OPND_SFR;
+	uint32_t a, b;
+
+	if (!i960_check_em (o))
+		return;
+
+	if (in->fp != 0 || !reg_sfr_src (o, in, 0, &a) ||
+	    !reg_sfr_src (o, in, 1, &b) || (D && c >= I960_SF_COUNT)) {
+		i960_raise (o, 0x20004);	/* invalid operand */
+		return;
+	}
+
+	if (!D) {
+		reg_exec (o, in->op, a, b, c);
+		return;
+	}
+
+	o->r[I960_SF_SLOT] = o->sf[c];
+	reg_exec (o, in->op, a, b, I960_SF_SLOT);
+	o->sf[c] = o->r[I960_SF_SLOT];
+}
+
+static inline int reg_fast (const struct i960_insn *in)
+{
+	const uint8_t *k = in->kind;
+
+	if (in->fp != 0)
+		return k[0] != I960_OPND_NONE && k[1] != I960_OPND_NONE;
+
+	return (k[0] == I960_OPND_REG || k[0] == I960_OPND_LIT) &&
+	       (k[1] == I960_OPND_REG || k[1] == I960_OPND_LIT) &&
+	        k[2] == I960_OPND_REG;
+}
+
+void i960_reg (struct i960 *o, const struct i960_insn *in)
+{
+	if (__builtin_expect (!reg_fast (in), 0))
+		reg_sfr (o, in);
+	else
+		reg_exec (o, in->op, reg_arg (o, in, 0), reg_arg (o, in, 1),
+			  in->val[2]);
+}
@@ -15,36 +15,41 @@
  * 07  -	0F  -		17  bo		1F  faulto
  */
 
+#include <i960-decode.h>
 #include <i960-emu.h>
+#include <i960-emu-acct.h>
 #include <i960-emu-bits.h>
 #include <i960-emu-branch.h>
+#include <i960-emu-ops.h>
+#include <i960-emu-stat.h>
 
 /*
  * Operation Entry Point
  *
  * decoder height = 3
  */
-static void ctrl_op (struct i960 *o, uint32_t op, uint32_t efa)
+static void ctrl_op (struct i960 *o, const struct i960_insn *in, uint32_t efa)
 {
-	const int C4 = u32_bit_select  (op, 24 + 4);	/* ---x ---- */
-	const int C3 = u32_bit_select  (op, 24 + 3);	/* ---- x--- */
-	const uint32_t i = u32_extract (op, 24 + 0, 2);	/* ---0 --xx */
+	const int C4 = u32_bit_select (in->code, 4);	/* ---x ---- */
+	const int C3 = u32_bit_select (in->code, 3);	/* ---- x--- */
+	const uint32_t i = in->code & 3;		/* ---0 --xx */
 
 	if (!C4)
 		switch (i) {
-		case 0:  i960_b    (o, efa);           break;  /* ---0 --00 */
+		case 0:  i960_br   (o, efa);           break;  /* ---0 --00 */
 		case 1:  i960_call (o, efa);           break;  /* ---0 --01 */
 		case 2:  i960_ret  (o);                break;  /* ---0 --10 */
 		case 3:  i960_bal  (o, efa, I960_LP);  break;  /* ---0 --11 */
 		}
 	else
-	if (!C3)  i960_bcc     (o, op, efa);	/* ---1 0--- */
-	else      i960_faultcc (o, op, efa);	/* ---1 1--- */
+	if (!C3)  i960_bcc     (o, in->op, efa);	/* ---1 0--- */
+	else      i960_faultcc (o, in->op, efa);	/* ---1 1--- */
 }
 
-void i960_ctrl (struct i960 *o, uint32_t op, uint32_t ip)
+void i960_ctrl (struct i960 *o, const struct i960_insn *in, uint32_t ip)
 {
-	const int32_t disp = (((int32_t) op << 8) >> 8) & ~3;
-
-	ctrl_op (o, op, ip + disp);
+	i960_stat_ctrl (o, in->op);
+	i960_acct_enter (o, I960_ACCT_BRANCH);
+	ctrl_op (o, in, ip + in->disp);
+	i960_acct_leave (o);
 }
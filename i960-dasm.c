@@ -9,475 +9,663 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+
+#include <i960-dasm.h>
+#include <i960-decode.h>
 
 struct tabent {
-	char name[12];
-	int args;
+	char    name[12];
+	uint8_t len, args;
 };
 
-static void imm (FILE *to, const char *prefix, uint32_t x)
-{
-	const char *fmt = x < 10 ? "%s%d" : "%s0x%x";
+struct opnd {
+	char    name[4];
+	uint8_t len;
+};
 
-	fprintf (to, fmt, prefix, x);
+#define OP(name, args)	{ name, sizeof (name) - 1, args }
+#define R(name)		{ name, sizeof (name) - 1 }
+
+/*
+ * Output cursor: formatting goes straight into buffer without bounds
+ * checks, no stdio, no locale; buffer must have I960_DASM_MAX bytes.
+ * Helpers work on local copy of the cursor: stores through char pointer
+ * may alias it otherwise.
+ */
+struct out {
+	char *p;
+};
+
+static inline void put_c (struct out *to, int c)
+{
+	*to->p++ = c;
 }
 
-static void label (FILE *to, const char *prefix, uint32_t efa)
+static inline void put_s (struct out *to, const char *s)
 {
-	imm (to, prefix, efa);
+	const size_t len = strlen (s);	/* folded for string literals */
+
+	memcpy (to->p, s, len);
+	to->p += len;
 }
 
-static const char *get_arg (int M, int S, int i, int fp)
+/*
+ * Mnemonics and operand names are in fixed-size zero-padded arrays with
+ * length precomputed, copy them as a whole
+ */
+static inline void put_name (struct out *to, const struct tabent *e)
 {
-	static const char *const regs[32] = {
-		"pfp",  "sp",   "rip",  "r3",   "r4",   "r5",   "r6",   "r7",
-		"r8",   "r9",   "r10",  "r11",  "r12",  "r13",  "r14",  "r15",
-		"g0",   "g1",   "g2",   "g3",   "g4",   "g5",   "g6",   "g7",
-		"g8",   "g9",   "g10",  "g11",  "g12",  "g13",  "g14",  "fp",
-	};
-	static const char *const lits[32] = {
-		"0",    "1",    "2",    "3",    "4",    "5",    "6",    "7",
-		"8",    "9",    "10",   "11",   "12",   "13",   "14",   "15",
-		"16",   "17",   "18",   "19",   "20",   "21",   "22",   "23",
-		"24",   "25",   "26",   "27",   "28",   "29",   "30",   "31",
-	};
-	static const char *const sregs[32] = {
-		"sf0",  "sf1",  "sf2",  "sf3",  "sf4",  "sf5",  "sf6",  "sf7",
-		"sf8",  "sf9",  "sf10", "sf11", "sf12", "sf13", "sf14", "sf15",
-		"sf16", "sf17", "sf18", "sf19", "sf20", "sf21", "sf22", "sf23",
-		"sf24", "sf25", "sf26", "sf27", "sf28", "sf29", "sf30", "sf31",
-	};
-	static const char *const fregs[32] = {
-		"fp0",  "fp1",  "fp2",  "fp3",  "fp4",  "fp5",  "fp6",  "fp7",
-		"fp8",  "fp9",  "fp10", "fp11", "fp12", "fp13", "fp14", "fp15",
-		"0.0",  "fp17", "fp18", "fp19", "fp20", "fp21", "1.0",  "fp23",
-		"fp24", "fp25", "fp26", "fp27", "fp28", "fp29", "fp30", "fp31",
-	};
+	memcpy (to->p, e->name, 12);
+	to->p += e->len;
+}
 
-	return S ? fp ? fregs[i] : sregs[i] : M ? lits[i] : regs[i];
+static inline void put_reg (struct out *to, const struct opnd *e)
+{
+	memcpy (to->p, e->name, 4);
+	to->p += e->len;
 }
 
-static void reg_op (FILE *to, const char *prefix, int M, int S, int reg, int fp)
+/*
+ * Hex digits without branches and loops: nibbles are spread to bytes and
+ * converted to ASCII as a whole, first digit goes to lowest address.
+ * Value is shifted to put its first significant digit on top.
+ */
+static inline void put_hex8 (struct out *to, uint32_t x)
 {
-	fprintf (to, "%s%s", prefix, get_arg (M, S, reg, fp));
+	const uint64_t ones = 0x0101010101010101;
+	uint64_t v = x;
+
+	v = (v | v << 16) & 0x0000ffff0000ffff;
+	v = (v | v <<  8) & 0x00ff00ff00ff00ff;
+	v = (v | v <<  4) & 0x0f0f0f0f0f0f0f0f;		/* nibble i at byte i */
+	v += '0' * ones + ((v + 6 * ones) >> 4 & ones) * ('a' - '0' - 10);
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	v = __builtin_bswap64 (v);
+#endif
+	memcpy (to->p, &v, 8);
+	to->p += 8;
 }
 
-static uint32_t i960_inval (FILE *to, uint32_t len, uint32_t op, uint32_t disp)
+static inline void put_hex (struct out *to, uint32_t x)
 {
-	const char *fmt = len == 8 ? ".word\t0x%08x, 0x%08x" : "word\t0x%08x";
+	const int n = (35 - __builtin_clz (x | 1)) / 4;
+	char *p = to->p;
 
-	fprintf (to, fmt, op, disp);
-	return len;
+	put_hex8 (to, x << (32 - 4 * n));
+	to->p = p + n;
 }
 
-static uint32_t i960_ctrl (FILE *to, uint32_t ip, uint32_t op, uint32_t disp)
+/*
+ * Immediate: single decimal digit or hex with 0x prefix, without branches
+ * on value: decimal digit is the same as hex one
+ */
+static inline void imm (struct out *to, const char *prefix, uint32_t x)
 {
-	static const struct tabent map[32] = {
-		[0x08] = { "b",		1, },	/* 08 */
-		[0x09] = { "call",	1, },	/* 09 */
-		[0x0a] = { "ret",	0, },	/* 0a */
-		[0x0b] = { "bal",	1, },	/* 0b */
-		[0x10] = { "bno",	1, },	/* 10 */
-		[0x11] = { "bg",	1, },	/* 11 */
-		[0x12] = { "be",	1, },	/* 12 */
-		[0x13] = { "bge",	1, },	/* 13 */
-		[0x14] = { "bl",	1, },	/* 14 */
-		[0x15] = { "bne",	1, },	/* 15 */
-		[0x16] = { "ble",	1, },	/* 16 */
-		[0x17] = { "bo",	1, },	/* 17 */
-		[0x18] = { "faultno",	0, },	/* 18 */
-		[0x19] = { "faultg",	0, },	/* 19 */
-		[0x1a] = { "faulte",	0, },	/* 1a */
-		[0x1b] = { "faultge",	0, },	/* 1b */
-		[0x1c] = { "faultl",	0, },	/* 1c */
-		[0x1d] = { "faultne",	0, },	/* 1d */
-		[0x1e] = { "faultle",	0, },	/* 1e */
-		[0x1f] = { "faulto",	0, },	/* 1f */
-	};
+	put_s (to, prefix);
+	memcpy (to->p, "0x", 2);
+	to->p += x < 10 ? 0 : 2;
+	put_hex (to, x);
+}
 
-	const int i = (op >> 24) & 31;
-	const int T = (op >>  1) & 1;
-	const int R = (op >>  0) & 1;
+static inline void label (struct out *to, const char *prefix, uint32_t efa)
+{
+	imm (to, prefix, efa);
+}
 
-	if (map[i].name[0] == 0 || R)
-		return i960_inval (to, 4, op, disp);
+/*
+ * Operand names by kind: sfr kind of FPU operation is real register or
+ * constant, none kind is never printed
+ */
+static const struct opnd opnd_name[5][32] = {
+	{	/* I960_OPND_NONE */
+	},
+	{	/* I960_OPND_REG */
+		R ("pfp"),  R ("sp"),   R ("rip"),  R ("r3"),
+		R ("r4"),   R ("r5"),   R ("r6"),   R ("r7"),
+		R ("r8"),   R ("r9"),   R ("r10"),  R ("r11"),
+		R ("r12"),  R ("r13"),  R ("r14"),  R ("r15"),
+		R ("g0"),   R ("g1"),   R ("g2"),   R ("g3"),
+		R ("g4"),   R ("g5"),   R ("g6"),   R ("g7"),
+		R ("g8"),   R ("g9"),   R ("g10"),  R ("g11"),
+		R ("g12"),  R ("g13"),  R ("g14"),  R ("fp"),
+	},
+	{	/* I960_OPND_LIT */
+		R ("0"),    R ("1"),    R ("2"),    R ("3"),
+		R ("4"),    R ("5"),    R ("6"),    R ("7"),
+		R ("8"),    R ("9"),    R ("10"),   R ("11"),
+		R ("12"),   R ("13"),   R ("14"),   R ("15"),
+		R ("16"),   R ("17"),   R ("18"),   R ("19"),
+		R ("20"),   R ("21"),   R ("22"),   R ("23"),
+		R ("24"),   R ("25"),   R ("26"),   R ("27"),
+		R ("28"),   R ("29"),   R ("30"),   R ("31"),
+	},
+	{	/* I960_OPND_SFR */
+		R ("sf0"),  R ("sf1"),  R ("sf2"),  R ("sf3"),
+		R ("sf4"),  R ("sf5"),  R ("sf6"),  R ("sf7"),
+		R ("sf8"),  R ("sf9"),  R ("sf10"), R ("sf11"),
+		R ("sf12"), R ("sf13"), R ("sf14"), R ("sf15"),
+		R ("sf16"), R ("sf17"), R ("sf18"), R ("sf19"),
+		R ("sf20"), R ("sf21"), R ("sf22"), R ("sf23"),
+		R ("sf24"), R ("sf25"), R ("sf26"), R ("sf27"),
+		R ("sf28"), R ("sf29"), R ("sf30"), R ("sf31"),
+	},
+	{	/* I960_OPND_SFR of FPU operation */
+		R ("fp0"),  R ("fp1"),  R ("fp2"),  R ("fp3"),
+		R ("fp4"),  R ("fp5"),  R ("fp6"),  R ("fp7"),
+		R ("fp8"),  R ("fp9"),  R ("fp10"), R ("fp11"),
+		R ("fp12"), R ("fp13"), R ("fp14"), R ("fp15"),
+		R ("0.0"),  R ("fp17"), R ("fp18"), R ("fp19"),
+		R ("fp20"), R ("fp21"), R ("1.0"),  R ("fp23"),
+		R ("fp24"), R ("fp25"), R ("fp26"), R ("fp27"),
+		R ("fp28"), R ("fp29"), R ("fp30"), R ("fp31"),
+	},
+};
 
-	fprintf (to, "%s%s", map[i].name, T ? ".f" : "");
+static inline void reg_op (struct out *to, const char *prefix,
+			   const struct i960_insn *in, int slot, int fp)
+{
+	const int kind = in->kind[slot];
 
-	if (map[i].args)
-		label (to, "\t", ip + disp);
+	put_s (to, prefix);
+	put_reg (to, opnd_name[kind + (fp && kind == I960_OPND_SFR)] +
+		     in->val[slot]);
+}
 
-	return 4;
+/*
+ * Optional parts are formatted unconditionally and dropped by moving
+ * the cursor back: random instruction streams mispredict otherwise
+ */
+static inline void keep_if (struct out *to, char *start, int on)
+{
+	to->p = on ? to->p : start;
 }
 
-static uint32_t i960_cobr (FILE *to, uint32_t ip, uint32_t op, uint32_t disp)
+static inline
+uint32_t i960_inval (struct out *to, const struct i960_insn *in)
 {
-	static const struct tabent map[32] = {
-		[0x00] = { "testno",	1, },	/* 20 */
-		[0x01] = { "testg",	1, },	/* 21 */
-		[0x02] = { "teste",	1, },	/* 22 */
-		[0x03] = { "testge",	1, },	/* 23 */
-		[0x04] = { "testl",	1, },	/* 24 */
-		[0x05] = { "testne",	1, },	/* 25 */
-		[0x06] = { "testle",	1, },	/* 26 */
-		[0x07] = { "testo",	1, },	/* 27 */
-		[0x10] = { "bbc",	3, },	/* 30 */
-		[0x11] = { "cmpobg",	3, },	/* 31 */
-		[0x12] = { "cmpobe",	3, },	/* 32 */
-		[0x13] = { "cmpobge",	3, },	/* 33 */
-		[0x14] = { "cmpobl",	3, },	/* 34 */
-		[0x15] = { "cmpobne",	3, },	/* 35 */
-		[0x16] = { "cmpoble",	3, },	/* 36 */
-		[0x17] = { "bbs",	3, },	/* 37 */
-		[0x18] = { "cmpibno",	3, },	/* 38 */
-		[0x19] = { "cmpibg",	3, },	/* 39 */
-		[0x1a] = { "cmpibe",	3, },	/* 3a */
-		[0x1b] = { "cmpibge",	3, },	/* 3b */
-		[0x1c] = { "cmpibl",	3, },	/* 3c */
-		[0x1d] = { "cmpibne",	3, },	/* 3d */
-		[0x1e] = { "cmpible",	3, },	/* 3e */
-		[0x1f] = { "cmpibo",	3, },	/* 3f */
-	};
+	put_s (to, in->len == 8 ? ".word\t0x" : "word\t0x");
+	put_hex8 (to, in->op);
+
+	if (in->len == 8) {
+		put_s (to, ", 0x");
+		put_hex8 (to, in->disp);
+	}
+
+	return in->len;
+}
 
-	const int i  = (op >> 24) & 31;
-	const int c  = (op >> 19) & 31;
-	const int b  = (op >> 14) & 31;
-	const int a  = c;
-	const int S3 = (op >> 13) & 1;
-	const int M1 = S3;
-	const int T  = (op >>  1) & 1;
-	const int S2 = (op >>  0) & 1;
+static const struct tabent ctrl_map[32] = {
+	[0x08] = OP ("b",	1),	/* 08 */
+	[0x09] = OP ("call",	1),	/* 09 */
+	[0x0a] = OP ("ret",	0),	/* 0a */
+	[0x0b] = OP ("bal",	1),	/* 0b */
+	[0x10] = OP ("bno",	1),	/* 10 */
+	[0x11] = OP ("bg",	1),	/* 11 */
+	[0x12] = OP ("be",	1),	/* 12 */
+	[0x13] = OP ("bge",	1),	/* 13 */
+	[0x14] = OP ("bl",	1),	/* 14 */
+	[0x15] = OP ("bne",	1),	/* 15 */
+	[0x16] = OP ("ble",	1),	/* 16 */
+	[0x17] = OP ("bo",	1),	/* 17 */
+	[0x18] = OP ("faultno",	0),	/* 18 */
+	[0x19] = OP ("faultg",	0),	/* 19 */
+	[0x1a] = OP ("faulte",	0),	/* 1a */
+	[0x1b] = OP ("faultge",	0),	/* 1b */
+	[0x1c] = OP ("faultl",	0),	/* 1c */
+	[0x1d] = OP ("faultne",	0),	/* 1d */
+	[0x1e] = OP ("faultle",	0),	/* 1e */
+	[0x1f] = OP ("faulto",	0),	/* 1f */
+};
 
-	if (map[i].name[0] == 0)
-		return i960_inval (to, 4, op, disp);
+static uint32_t i960_ctrl (struct out *to, uint32_t ip,
+			   const struct i960_insn *in)
+{
+	const int i = in->code & 31;
+	const int T = (in->op >> 1) & 1;
+	const int R = (in->op >> 0) & 1;
+	char *start;
 
-	fprintf (to, "%s%s", map[i].name, T ? ".f" : "");
+	if (ctrl_map[i].name[0] == 0 || R)
+		return i960_inval (to, in);
 
-	if (i & 0x10) {
-		reg_op (to, "\t", M1, 0, a, 0);
-		reg_op (to, ", ", 0, S2, b, 0);
-		label  (to, ", ", ip + disp);
-	}
-	else
-		reg_op (to, "\t", 0, S3, c, 0);
+	put_name (to, ctrl_map + i);
+	memcpy (to->p, ".f", 2);
+	to->p += 2 * T;
 
+	start = to->p;
+	label (to, "\t", ip + in->disp);
+	keep_if (to, start, ctrl_map[i].args);
 	return 4;
 }
 
-static uint32_t i960_mem (FILE *to, uint32_t ip, uint32_t op, uint32_t disp)
+static const struct tabent cobr_map[32] = {
+	[0x00] = OP ("testno",	1),	/* 20 */
+	[0x01] = OP ("testg",	1),	/* 21 */
+	[0x02] = OP ("teste",	1),	/* 22 */
+	[0x03] = OP ("testge",	1),	/* 23 */
+	[0x04] = OP ("testl",	1),	/* 24 */
+	[0x05] = OP ("testne",	1),	/* 25 */
+	[0x06] = OP ("testle",	1),	/* 26 */
+	[0x07] = OP ("testo",	1),	/* 27 */
+	[0x10] = OP ("bbc",	3),	/* 30 */
+	[0x11] = OP ("cmpobg",	3),	/* 31 */
+	[0x12] = OP ("cmpobe",	3),	/* 32 */
+	[0x13] = OP ("cmpobge",	3),	/* 33 */
+	[0x14] = OP ("cmpobl",	3),	/* 34 */
+	[0x15] = OP ("cmpobne",	3),	/* 35 */
+	[0x16] = OP ("cmpoble",	3),	/* 36 */
+	[0x17] = OP ("bbs",	3),	/* 37 */
+	[0x18] = OP ("cmpibno",	3),	/* 38 */
+	[0x19] = OP ("cmpibg",	3),	/* 39 */
+	[0x1a] = OP ("cmpibe",	3),	/* 3a */
+	[0x1b] = OP ("cmpibge",	3),	/* 3b */
+	[0x1c] = OP ("cmpibl",	3),	/* 3c */
+	[0x1d] = OP ("cmpibne",	3),	/* 3d */
+	[0x1e] = OP ("cmpible",	3),	/* 3e */
+	[0x1f] = OP ("cmpibo",	3),	/* 3f */
+};
+
+static uint32_t i960_cobr (struct out *to, uint32_t ip,
+			   const struct i960_insn *in)
 {
-	static const struct tabent map[128] = {
-		[0x00] = { "ldob",	2 },	/* 80 */
-		[0x02] = { "stob",	1 },	/* 82 */
-		[0x04] = { "bx",	0 },	/* 84 */
-		[0x05] = { "balx",	2 },	/* 85 */
-		[0x06] = { "callx",	0 },	/* 86 */
-		[0x08] = { "ldos",	2 },	/* 88 */
-		[0x0a] = { "stos",	1 },	/* 8a */
-		[0x0c] = { "lda",	2 },	/* 8c */
-		[0x10] = { "ld",	2 },	/* 90 */
-		[0x12] = { "st",	1 },	/* 92 */
-		[0x18] = { "ldl",	2 },	/* 98 */
-		[0x1a] = { "stl",	1 },	/* 9a */
-		[0x20] = { "ldt",	2 },	/* a0 */
-		[0x22] = { "stt",	1 },	/* a2 */
-		[0x2c] = { "dcinva",	0 },	/* ac */
-		[0x30] = { "ldq",	2 },	/* b0 */
-		[0x32] = { "stq",	1 },	/* b2 */
-		[0x40] = { "ldib",	2 },	/* c0 */
-		[0x42] = { "stib",	1 },	/* c2 */
-		[0x48] = { "ldis",	2 },	/* c8 */
-		[0x4a] = { "stis",	1 },	/* ca */
-	};
+	const int i = in->code & 31;
+	const int T = (in->op >> 1) & 1;
+	const int C = (i >> 4) & 1;		/* compare and branch	*/
+	char *start;
+
+	if (cobr_map[i].name[0] == 0)
+		return i960_inval (to, in);
+
+	put_name (to, cobr_map + i);
+	memcpy (to->p, ".f", 2);
+	to->p += 2 * T;
 
+	reg_op (to, "\t", in, C ? 0 : 2, 0);
+
+	start = to->p;
+	reg_op (to, ", ", in, 1, 0);
+	label  (to, ", ", ip + in->disp);
+	keep_if (to, start, C);
+	return 4;
+}
+
+static const struct tabent mem_map[128] = {
+	[0x00] = OP ("ldob",	2),	/* 80 */
+	[0x02] = OP ("stob",	1),	/* 82 */
+	[0x04] = OP ("bx",	0),	/* 84 */
+	[0x05] = OP ("balx",	2),	/* 85 */
+	[0x06] = OP ("callx",	0),	/* 86 */
+	[0x08] = OP ("ldos",	2),	/* 88 */
+	[0x0a] = OP ("stos",	1),	/* 8a */
+	[0x0c] = OP ("lda",	2),	/* 8c */
+	[0x10] = OP ("ld",	2),	/* 90 */
+	[0x12] = OP ("st",	1),	/* 92 */
+	[0x18] = OP ("ldl",	2),	/* 98 */
+	[0x1a] = OP ("stl",	1),	/* 9a */
+	[0x20] = OP ("ldt",	2),	/* a0 */
+	[0x22] = OP ("stt",	1),	/* a2 */
+	[0x2c] = OP ("dcinva",	0),	/* ac */
+	[0x30] = OP ("ldq",	2),	/* b0 */
+	[0x32] = OP ("stq",	1),	/* b2 */
+	[0x40] = OP ("ldib",	2),	/* c0 */
+	[0x42] = OP ("stib",	1),	/* c2 */
+	[0x48] = OP ("ldis",	2),	/* c8 */
+	[0x4a] = OP ("stis",	1),	/* ca */
+};
+
+static uint32_t i960_mem (struct out *to, uint32_t ip,
+			  const struct i960_insn *in)
+{
 	static const char F[16] = {
 		0x4, 0x4, 0x4, 0x4,  0x2, 0x8, 0x0, 0x3,  /* 00-- 01xx- */
 		0x6, 0x6, 0x6, 0x6,  0xC, 0xE, 0xD, 0xF,  /* 10-- 11xx */
 	};
 
-	const int i    = (op >> 24) & 127;
-	const int c    = (op >> 19) & 31;
-	const int b    = (op >> 14) & 31;
-	const int mode = (op >> 10) & 15;
-	const int a    = (op >>  0) & 31;
-	const int S2   = (op >>  6) & 1;
-	const int S1   = (op >>  5) & 1;
+	static const struct opnd scale[8] = {
+		R (""),     R ("*2"),   R ("*4"),   R ("*8"),
+		R ("*16"),  R ("*32"),  R ("*64"),  R ("*128"),
+	};
 
-	const int scale = 1 << ((op >> 7) & 7);
+	const int i    = in->code & 127;
+	const int mode = in->mode;
+	const int args = mem_map[i].args;
+	char *start;
 
-	const char *base  = get_arg (0, S2, b, 0);
-	const char *index = get_arg (0, S1, a, 0);
-	const char *ifmt  = scale == 1 ? "[%s]" : "[%s*%d]";
+	if (mem_map[i].name[0] == 0 || mode == 6)
+		return i960_inval (to, in);
 
-	uint32_t len = F[mode] & 8 ? 8 : 4;
+	put_name (to, mem_map + i);
+	put_c (to, '\t');
 
-	if (map[i].name[0] == 0 || mode == 6)
-		return i960_inval (to, len, op, disp);
+	start = to->p;
+	reg_op (to, "", in, 2, 0);
+	put_s (to, ", ");
+	keep_if (to, start, args & 1);
 
-	fprintf (to, "%s\t", map[i].name);
+	start = to->p;
+	imm (to, "", mode == 5 ? ip + 8 + in->disp : in->disp);
+	keep_if (to, start, F[mode] & 0xC);
 
-	if (map[i].args & 1)  fprintf (to, "%s, ", get_arg (0, 0, c, 0));
+	start = to->p;
+	reg_op (to, "(", in, 1, 0);
+	put_c (to, ')');
+	keep_if (to, start, F[mode] & 2);
 
-	if (mode == 5)    label (to, "", ip + 8 + disp);
-	if (F[mode] & 4)  imm (to, "", disp);
-	if (F[mode] & 2)  fprintf (to, "(%s)", base);
-	if (F[mode] & 1)  fprintf (to, ifmt, index, scale);
+	start = to->p;
+	reg_op (to, "[", in, 0, 0);
+	put_reg (to, scale + in->scale);
+	put_c (to, ']');
+	keep_if (to, start, F[mode] & 1);
 
-	if (map[i].args & 2)  fprintf (to, ", %s", get_arg (0, 0, c, 0));
+	start = to->p;
+	reg_op (to, ", ", in, 2, 0);
+	keep_if (to, start, args & 2);
 
-	return len;
+	return in->len;
 }
 
-static uint32_t i960_reg (FILE *to, uint32_t ip, uint32_t op, uint32_t disp)
+static const struct tabent reg_map[1024] = {
+	[0x180] = OP ("notbit",		7),
+	[0x181] = OP ("and",		7),
+	[0x182] = OP ("andnot",		7),
+	[0x183] = OP ("setbit",		7),
+	[0x184] = OP ("notand",		7),
+	[0x186] = OP ("xor",		7),
+	[0x187] = OP ("or",		7),
+	[0x188] = OP ("nor",		7),
+	[0x189] = OP ("xnor",		7),
+	[0x18a] = OP ("not",		5),
+	[0x18b] = OP ("ornot",		7),
+	[0x18c] = OP ("clrbit",		7),
+	[0x18d] = OP ("notor",		7),
+	[0x18e] = OP ("nand",		7),
+	[0x18f] = OP ("alterbit",	7),
+	[0x190] = OP ("addo",		7),
+	[0x191] = OP ("addi",		7),
+	[0x192] = OP ("subo",		7),
+	[0x193] = OP ("subi",		7),
+	[0x194] = OP ("cmpob",		3),
+	[0x195] = OP ("cmpib",		3),
+	[0x196] = OP ("cmpos",		3),
+	[0x197] = OP ("cmpis",		3),
+	[0x198] = OP ("shro",		7),
+	[0x19a] = OP ("shrdi",		7),
+	[0x19b] = OP ("shri",		7),
+	[0x19c] = OP ("shlo",		7),
+	[0x19d] = OP ("rotate",		7),
+	[0x19e] = OP ("shli",		7),
+	[0x1a0] = OP ("cmpo",		3),
+	[0x1a1] = OP ("cmpi",		3),
+	[0x1a2] = OP ("concmpo",	3),
+	[0x1a3] = OP ("concmpi",	3),
+	[0x1a4] = OP ("cmpinco",	7),
+	[0x1a5] = OP ("cmpinci",	7),
+	[0x1a6] = OP ("cmpdeco",	7),
+	[0x1a7] = OP ("cmpdeci",	7),
+	[0x1ac] = OP ("scanbyte",	3),
+	[0x1ad] = OP ("bswap",		5),
+	[0x1ae] = OP ("chkbit",		3),
+	[0x1b0] = OP ("addc",		7),
+	[0x1b2] = OP ("subc",		7),
+	[0x1b4] = OP ("intdis",		0),
+	[0x1b5] = OP ("inten",		0),
+	[0x1cc] = OP ("mov",		5),
+	[0x1d8] = OP ("eshro",		7),
+	[0x1dc] = OP ("movl",		5),
+	[0x1ec] = OP ("movt",		5),
+	[0x1fc] = OP ("movq",		5),
+	[0x200] = OP ("synmov",		3),
+	[0x201] = OP ("synmovl",	3),
+	[0x202] = OP ("synmovq",	3),
+	[0x203] = OP ("cmpstr",		7),
+	[0x204] = OP ("movqstr",	7),
+	[0x205] = OP ("movstr",		7),
+	[0x210] = OP ("atmod",		7),
+	[0x212] = OP ("atadd",		7),
+	[0x213] = OP ("inspacc",	5),
+	[0x214] = OP ("ldphy",		5),
+	[0x215] = OP ("synld",		5),
+	[0x217] = OP ("fill",		7),
+	[0x230] = OP ("sdma",		7),
+	[0x231] = OP ("udma",		0),
+	[0x240] = OP ("spanbit",	5),
+	[0x241] = OP ("scanbit",	5),
+	[0x242] = OP ("daddc",		7),
+	[0x243] = OP ("dsubc",		7),
+	[0x244] = OP ("dmovt",		5),
+	[0x245] = OP ("modac",		7),
+	[0x246] = OP ("condrec",	5),
+	[0x250] = OP ("modify",		7),
+	[0x251] = OP ("extract",	7),
+	[0x254] = OP ("modtc",		7),
+	[0x255] = OP ("modpc",		7),
+	[0x256] = OP ("receive",	5),
+	[0x258] = OP ("intctl",		5),
+	[0x259] = OP ("sysctl",		7),
+	[0x25b] = OP ("icctl",		7),
+	[0x25c] = OP ("dcctl",		7),
+	[0x25d] = OP ("halt",		0),
+	[0x260] = OP ("calls",		1),
+	[0x262] = OP ("send",		7),
+	[0x263] = OP ("sendserv",	1),
+	[0x264] = OP ("resumprcs",	1),
+	[0x265] = OP ("schedprcs",	1),
+	[0x266] = OP ("saveprcs",	0),
+	[0x268] = OP ("condwait",	1),
+	[0x269] = OP ("wait",		1),
+	[0x26a] = OP ("signal",		1),
+	[0x26b] = OP ("mark",		0),
+	[0x26c] = OP ("fmark",		0),
+	[0x26d] = OP ("flushreg",	0),
+	[0x26f] = OP ("syncf",		0),
+	[0x270] = OP ("emul",		7),
+	[0x271] = OP ("ediv",		7),
+	[0x273] = OP ("ldtime",		4),
+	[0x274] = OP ("cvtir",		13),
+	[0x275] = OP ("cvtilr",		13),
+	[0x276] = OP ("scalerl",	15),
+	[0x277] = OP ("scaler",		15),
+	[0x280] = OP ("atanr",		15),
+	[0x281] = OP ("logepr",		15),
+	[0x282] = OP ("logr",		15),
+	[0x283] = OP ("remr",		15),
+	[0x284] = OP ("cmpor",		11),
+	[0x285] = OP ("cmpr",		11),
+	[0x288] = OP ("sqrtr",		13),
+	[0x289] = OP ("expr",		13),
+	[0x28a] = OP ("logbnr",		13),
+	[0x28b] = OP ("roundr",		13),
+	[0x28c] = OP ("sinr",		13),
+	[0x28d] = OP ("cosr",		13),
+	[0x28e] = OP ("tanr",		13),
+	[0x28f] = OP ("classr",		9),
+	[0x290] = OP ("atanrl",		15),
+	[0x291] = OP ("logeprl",	15),
+	[0x292] = OP ("logrl",		15),
+	[0x293] = OP ("remrl",		15),
+	[0x294] = OP ("cmporl",		11),
+	[0x295] = OP ("cmprl",		11),
+	[0x298] = OP ("sqrtrl",		13),
+	[0x299] = OP ("exprl",		13),
+	[0x29a] = OP ("logbnrl",	13),
+	[0x29b] = OP ("roundrl",	13),
+	[0x29c] = OP ("sinrl",		13),
+	[0x29d] = OP ("cosrl",		13),
+	[0x29e] = OP ("tanrl",		13),
+	[0x29f] = OP ("classrl",	9),
+	[0x2c0] = OP ("cvtri",		13),
+	[0x2c1] = OP ("cvtril",		13),
+	[0x2c2] = OP ("cvtzri",		13),
+	[0x2c3] = OP ("cvtzril",	13),
+	[0x2c9] = OP ("movr",		13),
+	[0x2d9] = OP ("movrl",		13),
+	[0x2e1] = OP ("movre",		13),
+	[0x2e2] = OP ("cpysre",		15),
+	[0x2e3] = OP ("cpyrsre",	15),
+	[0x301] = OP ("mulo",		7),
+	[0x308] = OP ("remo",		7),
+	[0x30b] = OP ("divo",		7),
+	[0x341] = OP ("muli",		7),
+	[0x348] = OP ("remi",		7),
+	[0x349] = OP ("modi",		7),
+	[0x34b] = OP ("divi",		7),
+	[0x380] = OP ("addono",		7),
+	[0x381] = OP ("addino",		7),
+	[0x382] = OP ("subono",		7),
+	[0x383] = OP ("subino",		7),
+	[0x384] = OP ("selno",		7),
+	[0x38b] = OP ("divr",		15),
+	[0x38c] = OP ("mulr",		15),
+	[0x38d] = OP ("subr",		15),
+	[0x38f] = OP ("addr",		15),
+	[0x390] = OP ("addog",		7),
+	[0x391] = OP ("addig",		7),
+	[0x392] = OP ("subog",		7),
+	[0x393] = OP ("subig",		7),
+	[0x394] = OP ("selg",		7),
+	[0x39b] = OP ("divrl",		15),
+	[0x39c] = OP ("mulrl",		15),
+	[0x39d] = OP ("subrl",		15),
+	[0x39f] = OP ("addrl",		15),
+	[0x3a0] = OP ("addoe",		7),
+	[0x3a1] = OP ("addie",		7),
+	[0x3a2] = OP ("suboe",		7),
+	[0x3a3] = OP ("subie",		7),
+	[0x3a4] = OP ("sele",		7),
+	[0x3b0] = OP ("addoge",		7),
+	[0x3b1] = OP ("addige",		7),
+	[0x3b2] = OP ("suboge",		7),
+	[0x3b3] = OP ("subige",		7),
+	[0x3b4] = OP ("selge",		7),
+	[0x3c0] = OP ("addol",		7),
+	[0x3c1] = OP ("addil",		7),
+	[0x3c2] = OP ("subol",		7),
+	[0x3c3] = OP ("subil",		7),
+	[0x3c4] = OP ("sell",		7),
+	[0x3d0] = OP ("addone",		7),
+	[0x3d1] = OP ("addine",		7),
+	[0x3d2] = OP ("subone",		7),
+	[0x3d3] = OP ("subine",		7),
+	[0x3d4] = OP ("selne",		7),
+	[0x3e0] = OP ("addole",		7),
+	[0x3e1] = OP ("addile",		7),
+	[0x3e2] = OP ("subole",		7),
+	[0x3e3] = OP ("subile",		7),
+	[0x3e4] = OP ("selle",		7),
+	[0x3f0] = OP ("addoo",		7),
+	[0x3f1] = OP ("addio",		7),
+	[0x3f2] = OP ("suboo",		7),
+	[0x3f3] = OP ("subio",		7),
+	[0x3f4] = OP ("selo",		7),
+};
+
+/*
+ * Separator is tab before first operand and comma after it
+ */
+static inline void reg_slot (struct out *to, const struct i960_insn *in,
+			     int args, int slot, int fp)
 {
-	static const struct tabent map[1024] = {
-		[0x180] = { "notbit",		7 },
-		[0x181] = { "and",		7 },
-		[0x182] = { "andnot",		7 },
-		[0x183] = { "setbit",		7 },
-		[0x184] = { "notand",		7 },
-		[0x186] = { "xor",		7 },
-		[0x187] = { "or",		7 },
-		[0x188] = { "nor",		7 },
-		[0x189] = { "xnor",		7 },
-		[0x18a] = { "not",		5 },
-		[0x18b] = { "ornot",		7 },
-		[0x18c] = { "clrbit",		7 },
-		[0x18d] = { "notor",		7 },
-		[0x18e] = { "nand",		7 },
-		[0x18f] = { "alterbit",		7 },
-		[0x190] = { "addo",		7 },
-		[0x191] = { "addi",		7 },
-		[0x192] = { "subo",		7 },
-		[0x193] = { "subi",		7 },
-		[0x194] = { "cmpob",		3 },
-		[0x195] = { "cmpib",		3 },
-		[0x196] = { "cmpos",		3 },
-		[0x197] = { "cmpis",		3 },
-		[0x198] = { "shro",		7 },
-		[0x19a] = { "shrdi",		7 },
-		[0x19b] = { "shri",		7 },
-		[0x19c] = { "shlo",		7 },
-		[0x19d] = { "rotate",		7 },
-		[0x19e] = { "shli",		7 },
-		[0x1a0] = { "cmpo",		3 },
-		[0x1a1] = { "cmpi",		3 },
-		[0x1a2] = { "concmpo",		3 },
-		[0x1a3] = { "concmpi",		3 },
-		[0x1a4] = { "cmpinco",		7 },
-		[0x1a5] = { "cmpinci",		7 },
-		[0x1a6] = { "cmpdeco",		7 },
-		[0x1a7] = { "cmpdeci",		7 },
-		[0x1ac] = { "scanbyte",		3 },
-		[0x1ad] = { "bswap",		5 },
-		[0x1ae] = { "chkbit",		3 },
-		[0x1b0] = { "addc",		7 },
-		[0x1b2] = { "subc",		7 },
-		[0x1b4] = { "intdis",		0 },
-		[0x1b5] = { "inten",		0 },
-		[0x1cc] = { "mov",		5 },
-		[0x1d8] = { "eshro",		7 },
-		[0x1dc] = { "movl",		5 },
-		[0x1ec] = { "movt",		5 },
-		[0x1fc] = { "movq",		5 },
-		[0x200] = { "synmov",		3 },
-		[0x201] = { "synmovl",		3 },
-		[0x202] = { "synmovq",		3 },
-		[0x203] = { "cmpstr",		7 },
-		[0x204] = { "movqstr",		7 },
-		[0x205] = { "movstr",		7 },
-		[0x210] = { "atmod",		7 },
-		[0x212] = { "atadd",		7 },
-		[0x213] = { "inspacc",		5 },
-		[0x214] = { "ldphy",		5 },
-		[0x215] = { "synld",		5 },
-		[0x217] = { "fill",		7 },
-		[0x230] = { "sdma",		7 },
-		[0x231] = { "udma",		0 },
-		[0x240] = { "spanbit",		5 },
-		[0x241] = { "scanbit",		5 },
-		[0x242] = { "daddc",		7 },
-		[0x243] = { "dsubc",		7 },
-		[0x244] = { "dmovt",		5 },
-		[0x245] = { "modac",		7 },
-		[0x246] = { "condrec",		5 },
-		[0x250] = { "modify",		7 },
-		[0x251] = { "extract",		7 },
-		[0x254] = { "modtc",		7 },
-		[0x255] = { "modpc",		7 },
-		[0x256] = { "receive",		5 },
-		[0x258] = { "intctl",		5 },
-		[0x259] = { "sysctl",		7 },
-		[0x25b] = { "icctl",		7 },
-		[0x25c] = { "dcctl",		7 },
-		[0x25d] = { "halt",		0 },
-		[0x260] = { "calls",		1 },
-		[0x262] = { "send",		7 },
-		[0x263] = { "sendserv",		1 },
-		[0x264] = { "resumprcs",	1 },
-		[0x265] = { "schedprcs",	1 },
-		[0x266] = { "saveprcs",		0 },
-		[0x268] = { "condwait",		1 },
-		[0x269] = { "wait",		1 },
-		[0x26a] = { "signal",		1 },
-		[0x26b] = { "mark",		0 },
-		[0x26c] = { "fmark",		0 },
-		[0x26d] = { "flushreg",		0 },
-		[0x26f] = { "syncf",		0 },
-		[0x270] = { "emul",		7 },
-		[0x271] = { "ediv",		7 },
-		[0x273] = { "ldtime",		4 },
-		[0x274] = { "cvtir",		13 },
-		[0x275] = { "cvtilr",		13 },
-		[0x276] = { "scalerl",		15 },
-		[0x277] = { "scaler",		15 },
-		[0x280] = { "atanr",		15 },
-		[0x281] = { "logepr",		15 },
-		[0x282] = { "logr",		15 },
-		[0x283] = { "remr",		15 },
-		[0x284] = { "cmpor",		11 },
-		[0x285] = { "cmpr",		11 },
-		[0x288] = { "sqrtr",		13 },
-		[0x289] = { "expr",		13 },
-		[0x28a] = { "logbnr",		13 },
-		[0x28b] = { "roundr",		13 },
-		[0x28c] = { "sinr",		13 },
-		[0x28d] = { "cosr",		13 },
-		[0x28e] = { "tanr",		13 },
-		[0x28f] = { "classr",		9 },
-		[0x290] = { "atanrl",		15 },
-		[0x291] = { "logeprl",		15 },
-		[0x292] = { "logrl",		15 },
-		[0x293] = { "remrl",		15 },
-		[0x294] = { "cmporl",		11 },
-		[0x295] = { "cmprl",		11 },
-		[0x298] = { "sqrtrl",		13 },
-		[0x299] = { "exprl",		13 },
-		[0x29a] = { "logbnrl",		13 },
-		[0x29b] = { "roundrl",		13 },
-		[0x29c] = { "sinrl",		13 },
-		[0x29d] = { "cosrl",		13 },
-		[0x29e] = { "tanrl",		13 },
-		[0x29f] = { "classrl",		9 },
-		[0x2c0] = { "cvtri",		13 },
-		[0x2c1] = { "cvtril",		13 },
-		[0x2c2] = { "cvtzri",		13 },
-		[0x2c3] = { "cvtzril",		13 },
-		[0x2c9] = { "movr",		13 },
-		[0x2d9] = { "movrl",		13 },
-		[0x2e1] = { "movre",		13 },
-		[0x2e2] = { "cpysre",		15 },
-		[0x2e3] = { "cpyrsre",		15 },
-		[0x301] = { "mulo",		7 },
-		[0x308] = { "remo",		7 },
-		[0x30b] = { "divo",		7 },
-		[0x341] = { "muli",		7 },
-		[0x348] = { "remi",		7 },
-		[0x349] = { "modi",		7 },
-		[0x34b] = { "divi",		7 },
-		[0x380] = { "addono",		7 },
-		[0x381] = { "addino",		7 },
-		[0x382] = { "subono",		7 },
-		[0x383] = { "subino",		7 },
-		[0x384] = { "selno",		7 },
-		[0x38b] = { "divr",		15 },
-		[0x38c] = { "mulr",		15 },
-		[0x38d] = { "subr",		15 },
-		[0x38f] = { "addr",		15 },
-		[0x390] = { "addog",		7 },
-		[0x391] = { "addig",		7 },
-		[0x392] = { "subog",		7 },
-		[0x393] = { "subig",		7 },
-		[0x394] = { "selg",		7 },
-		[0x39b] = { "divrl",		15 },
-		[0x39c] = { "mulrl",		15 },
-		[0x39d] = { "subrl",		15 },
-		[0x39f] = { "addrl",		15 },
-		[0x3a0] = { "addoe",		7 },
-		[0x3a1] = { "addie",		7 },
-		[0x3a2] = { "suboe",		7 },
-		[0x3a3] = { "subie",		7 },
-		[0x3a4] = { "sele",		7 },
-		[0x3b0] = { "addoge",		7 },
-		[0x3b1] = { "addige",		7 },
-		[0x3b2] = { "suboge",		7 },
-		[0x3b3] = { "subige",		7 },
-		[0x3b4] = { "selge",		7 },
-		[0x3c0] = { "addol",		7 },
-		[0x3c1] = { "addil",		7 },
-		[0x3c2] = { "subol",		7 },
-		[0x3c3] = { "subil",		7 },
-		[0x3c4] = { "sell",		7 },
-		[0x3d0] = { "addone",		7 },
-		[0x3d1] = { "addine",		7 },
-		[0x3d2] = { "subone",		7 },
-		[0x3d3] = { "subine",		7 },
-		[0x3d4] = { "selne",		7 },
-		[0x3e0] = { "addole",		7 },
-		[0x3e1] = { "addile",		7 },
-		[0x3e2] = { "subole",		7 },
-		[0x3e3] = { "subile",		7 },
-		[0x3e4] = { "selle",		7 },
-		[0x3f0] = { "addoo",		7 },
-		[0x3f1] = { "addio",		7 },
-		[0x3f2] = { "suboo",		7 },
-		[0x3f3] = { "subio",		7 },
-		[0x3f4] = { "selo",		7 },
-	};
+	const int first = (args & ((1 << slot) - 1)) == 0;
+	char *start = to->p;
 
-	const int i = ((op >> 20) & 0x3f0) | ((op >> 7) & 0xf);
+	memcpy (to->p, first ? "\t" : ", ", 2);
+	to->p += 2 - first;
+	reg_op (to, "", in, slot, fp);
+	keep_if (to, start, (args >> slot) & 1);
+}
 
-	if (map[i].name[0] == 0)
-		return i960_inval (to, 4, op, disp);
+static uint32_t i960_reg (struct out *to, uint32_t ip,
+			  const struct i960_insn *in)
+{
+	const int i    = in->code & 0x3ff;
+	const int args = reg_map[i].args;
+	const int fp   = (args & 8) != 0;
+	const int none = (in->kind[0] == I960_OPND_NONE) << 0 |
+			 (in->kind[1] == I960_OPND_NONE) << 1 |
+			 (in->kind[2] == I960_OPND_NONE) << 2;
 
-	fprintf (to, map[i].name);
+	if (reg_map[i].len == 0 || (args & none & 7) != 0)
+		return i960_inval (to, in);	/* or reserved operand */
 
-	const int c = (op >> 19) & 31;
-	const int b = (op >> 14) & 31;
-	const int a = (op >>  0) & 31;
+	put_name (to, reg_map + i);
 
-	const int S3 = (op >> 13) & 1;
-	const int M2 = (op >> 12) & 1;
-	const int M1 = (op >> 11) & 1;
-	const int S2 = (op >>  6) & 1;
-	const int S1 = (op >>  5) & 1;
+	reg_slot (to, in, args, 0, fp);
+	reg_slot (to, in, args, 1, fp);
+	reg_slot (to, in, args, 2, fp);
+	return 4;
+}
 
-	const char *sep = "\t";
-	const int fp = (map[i].args & 8) != 0;
+static uint32_t dasm (struct out *to, uint32_t ip, const struct i960_insn *in)
+{
+	switch (in->format) {
+	case I960_FMT_CTRL:	return i960_ctrl (to, ip, in);
+	case I960_FMT_COBR:	return i960_cobr (to, ip, in);
+	case I960_FMT_REG:	return i960_reg  (to, ip, in);
+	default:		return i960_mem  (to, ip, in);
+	}
+}
 
-	if (map[i].args & 1)  reg_op (to, sep, M1, S1, a, fp), sep = ", ";
-	if (map[i].args & 2)  reg_op (to, sep, M2, S2, b, fp), sep = ", ";
-	if (map[i].args & 4)  reg_op (to, sep,  0, S3, c, fp);
+static inline
+uint32_t dasm_line (char *buf, size_t len, uint32_t ip,
+		    const struct i960_insn *in)
+{
+	char line[I960_DASM_MAX];
+	struct out to = { len < sizeof (line) ? line : buf };
+	const uint32_t n = dasm (&to, ip, in);
+	size_t size;
 
-	return 4;
+	*to.p = '\0';
+
+	if (len < sizeof (line) && len > 0) {	/* short buffer: truncate */
+		size = to.p - line;
+		size = size < len ? size : len - 1;
+
+		memcpy (buf, line, size);
+		buf[size] = '\0';
+	}
+
+	return n;
 }
 
-static int32_t i960_ctrl_disp (uint32_t op)
+uint32_t i960_dasm_insn (char *buf, size_t len, uint32_t ip,
+			 const struct i960_insn *in)
 {
-	const int32_t disp = op & 0xfffffc;
-
-	return op & 0x800000 ? disp | ~0xffffff : disp;  /* sign-extend */
+	return dasm_line (buf, len, ip, in);
 }
 
-static int32_t i960_cobr_disp (uint32_t op)
+uint32_t i960_dasm_buf (char *buf, size_t len, uint32_t ip, uint32_t op,
+			uint32_t disp)
 {
-	const int32_t disp = op & 0x1ffc;
+	struct i960_insn in;
 
-	return op & 0x1000 ? disp | ~0x1fff : disp;  /* sign-extend */
+	i960_decode (&in, op, disp);
+	return dasm_line (buf, len, ip, &in);
 }
 
-static int32_t i960_mem_disp (uint32_t op, uint32_t disp)
+uint32_t i960_dasm (FILE *to, uint32_t ip, uint32_t op, uint32_t disp)
 {
-	return op & 0x1000 ? disp : op & 0xfff;  /* MEMB vs MEMA */
+	char line[I960_DASM_MAX];
+	const uint32_t n = i960_dasm_buf (line, sizeof (line), ip, op, disp);
+
+	fputs (line, to);
+	return n;
 }
 
-uint32_t i960_dasm (FILE *to, uint32_t ip, uint32_t op, uint32_t disp)
+const char *i960_dasm_name (uint32_t op)
 {
-	const uint32_t line = (op >> 28) & 15;
+	struct i960_insn in;
+	const struct tabent *e;
 
-	if (line >= 8)  return i960_mem (to, ip, op, i960_mem_disp (op, disp));
-	if (line >= 4)  return i960_reg (to, ip, op, disp);
-	if (line >= 2)  return i960_cobr (to, ip, op, i960_cobr_disp (op));
+	i960_decode (&in, op, 0);
+
+	switch (in.format) {
+	case I960_FMT_CTRL:	e = ctrl_map + (in.code & 31);		break;
+	case I960_FMT_COBR:	e = cobr_map + (in.code & 31);		break;
+	case I960_FMT_REG:	e = reg_map  + (in.code & 0x3ff);	break;
+	default:		e = mem_map  + (in.code & 127);
+	}
 
-	return i960_ctrl (to, ip, op, i960_ctrl_disp (op));
+	return e->name[0] == 0 ? NULL : e->name;
 }
@@ -0,0 +1,365 @@
+/*
+ * 80960 Emulator Floating-Point Function Kernels
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Argument reduction and polynomial approximations follow fdlibm, with
+ * special case branches turned into selects and out-of-domain arguments
+ * left to caller. Selects use 64-bit masks only, thus kernels have no
+ * data-dependent branches.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <i960-fpu-fn.h>
+
+static inline uint64_t bits (double x)
+{
+	uint64_t r;
+
+	memcpy (&r, &x, sizeof (r));
+	return r;
+}
+
+static inline double from (uint64_t x)
+{
+	double r;
+
+	memcpy (&r, &x, sizeof (r));
+	return r;
+}
+
+static inline int normal (uint64_t x)
+{
+	return ((x >> 52) & 0x7ff) - 1 < 0x7fe;
+}
+
+#define SIGN	(1ull << 63)
+
+static inline double fabs_ (double x)
+{
+	return from (bits (x) & ~SIGN);
+}
+
+/* all ones if bit n of x is set, zero otherwise */
+static inline uint64_t bit_mask (uint64_t x, int n)
+{
+	return 0 - ((x >> n) & 1);
+}
+
+static inline double select (uint64_t m, double a, double b)
+{
+	return from ((bits (a) & m) | (bits (b) & ~m));
+}
+
+static inline double flip (double x, uint64_t m)
+{
+	return from (bits (x) ^ (m & SIGN));
+}
+
+/* adding SHIFT rounds to integer, integer is in low bits then */
+#define SHIFT	0x1.8p52
+
+/*
+ * Exact sum and product as pairs of doubles: Fast2Sum for |a| >= |b|
+ * and Dekker product
+ */
+static inline double fast_sum (double a, double b, double *e)
+{
+	const double s = a + b;
+
+	*e = b - (s - a);
+	return s;
+}
+
+static inline double sum_exact (double a, double b, double *e)
+{
+	const double s  = a + b;
+	const double bv = s - a;
+
+	*e = (a - (s - bv)) + (b - bv);
+	return s;
+}
+
+static inline double split (double a, double *lo)
+{
+	const double c  = 134217729.0 * a;
+	const double hi = c - (c - a);
+
+	*lo = a - hi;
+	return hi;
+}
+
+static inline double mul_exact (double a, double b, double *e)
+{
+	const double p = a * b;
+	double al, bl, ah = split (a, &al), bh = split (b, &bl);
+
+	*e = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+	return p;
+}
+
+/*
+ * Sine, cosine and tangent: x = k pi/2 + r, |r| <= pi/4, pi/2 splits into
+ * three parts, first two of 33 bits, thus products by k < 2^20 are exact
+ */
+#define INV_PIO2	6.36619772367581382433e-01
+#define PIO2_1		1.57079632673412561417e+00
+#define PIO2_2		6.07710050630396597660e-11
+#define PIO2_3		2.02226624879595063154e-21
+
+#define S1	-1.66666666666666324348e-01
+#define S2	 8.33333333332248946124e-03
+#define S3	-1.98412698298579493134e-04
+#define S4	 2.75573137070700676789e-06
+#define S5	-2.50507602534068634195e-08
+#define S6	 1.58969099521155010221e-10
+
+#define C1	 4.16666666666666019037e-02
+#define C2	-1.38888888888741095749e-03
+#define C3	 2.48015872894767294178e-05
+#define C4	-2.75573143513906633035e-07
+#define C5	 2.08757232129817482790e-09
+#define C6	-1.13596475577881948265e-11
+
+static inline double fn_trig (int fn, double x)
+{
+	const double kd = x * INV_PIO2 + SHIFT;
+	const double k  = kd - SHIFT;
+	const uint64_t q = bits (kd), odd = bit_mask (q, 0);
+	const double r1 = x - k * PIO2_1;
+	const double w1 = k * PIO2_2;
+	const double r2 = r1 - w1;
+	const double r3 = ((r1 - r2) - w1) - k * PIO2_3;
+	double y, r = fast_sum (r2, r3, &y);		/* r + y */
+	const double z  = r * r;
+	const double v  = z * r;
+	const double ps = S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)));
+	const double pc = z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 +
+			  z * C6)))));
+	const double hz = 0.5 * z;
+	const double w  = 1 - hz;
+	double sl, sh = fast_sum (r, -((z * (0.5 * y - v * ps) - y) - v * S1),
+				  &sl);
+	double cl, ch = fast_sum (w, ((1 - w) - hz) + (z * pc - r * y), &cl);
+	double n, nl, d, dl, t, pl, p;
+
+	switch (fn) {
+	case I960_FN_SIN:
+		return flip (select (odd, ch, sh), bit_mask (q, 1));
+	case I960_FN_COS:
+		return flip (select (odd, sh, ch), bit_mask (q + 1, 1));
+	}
+
+	n  = select (odd, ch, sh);
+	nl = select (odd, cl, sl);
+	d  = select (odd, sh, ch);
+	dl = select (odd, sl, cl);
+	t  = n / d;
+	p  = mul_exact (t, d, &pl);
+	t += ((((n - p) - pl) + nl) - t * dl) / d;
+	return flip (t, odd);
+}
+
+/*
+ * 2^x - 1: x = k + f, k is x truncated, |f| < 1, expm1 (f ln 2) by Taylor
+ * series over exact product f ln 2; result does not lose precision on
+ * cancellation for |x| < 1 then
+ */
+#define LN2	6.93147180559945286227e-01
+#define LN2_LO	2.31904681384629955842e-17
+
+static inline double fn_exp (double x)
+{
+	const double kr = (x + SHIFT) - SHIFT;
+	const double k  = kr - (x > 0 ? (kr > x ? 1.0 : 0.0) :
+					(kr < x ? -1.0 : 0.0));
+	const double f  = x - k;
+	const double p2 = from ((bits (k + SHIFT) + 1023) << 52);
+	double tl, t = mul_exact (f, LN2, &tl);
+	double ql, q, hl, h, p, e;
+
+	p = 1.0/355687428096000;		/* 1/17! */
+	p = p * t + 1.0/20922789888000;
+	p = p * t + 1.0/1307674368000;
+	p = p * t + 1.0/87178291200;
+	p = p * t + 1.0/6227020800;
+	p = p * t + 1.0/479001600;
+	p = p * t + 1.0/39916800;
+	p = p * t + 1.0/3628800;
+	p = p * t + 1.0/362880;
+	p = p * t + 1.0/40320;
+	p = p * t + 1.0/5040;
+	p = p * t + 1.0/720;
+	p = p * t + 1.0/120;
+	p = p * t + 1.0/24;
+	p = p * t + 1.0/6;
+
+	q = mul_exact (t, t, &ql);			/* t^2 */
+	h = fast_sum (t, 0.5 * q, &hl);			/* t + t^2/2 */
+	e = hl + 0.5 * ql + q * t * p;
+	e = h + (e + (tl + f * LN2_LO) * (1 + h));
+
+	return p2 * e + (p2 - 1);
+}
+
+/*
+ * log2 (m) = e + log2 (1 + f): s = f / (2 + f), log (1 + f) = f - hfsq +
+ * s (hfsq + R (s^2)), result assembled from high and low parts
+ */
+#define SQRT2	1.41421356237309514547e+00
+
+#define LG1	6.666666666666735130e-01
+#define LG2	3.999999999940941908e-01
+#define LG3	2.857142874366239149e-01
+#define LG4	2.222219843214978396e-01
+#define LG5	1.818357216161805012e-01
+#define LG6	1.531383769920937332e-01
+#define LG7	1.479819860511658591e-01
+
+#define IVLN2HI	1.44269504072144627571e+00
+#define IVLN2LO	1.67517131648865118353e-10
+
+static inline double log2_1p (double f, double e)
+{
+	const double hfsq = 0.5 * f * f;
+	const double s  = f / (2 + f);
+	const double z  = s * s;
+	const double w  = z * z;
+	const double R  = z * (LG1 + w * (LG3 + w * (LG5 + w * LG7))) +
+			  w * (LG2 + w * (LG4 + w * LG6));
+	const double hi = from (bits (f - hfsq) & ~0xffffffffull);
+	const double lo = (f - hi) - hfsq + s * (hfsq + R);
+	const double vh = hi * IVLN2HI;
+	const double vl = (lo + hi) * IVLN2LO + lo * IVLN2HI;
+	const double y  = e + vh;
+
+	return (vl + ((e - y) + vh)) + y;
+}
+
+static inline double fn_log (double x)
+{
+	const uint64_t u = bits (x);
+	const double m = from ((u & 0xfffffffffffffull) | 0x3ff0000000000000ull);
+	const double f = (m > SQRT2 ? m * 0.5 : m) - 1;
+	const double e = from (0x4330000000000000ull | (u >> 52)) - 0x1p52 -
+			 1023 + (m > SQRT2 ? 1.0 : 0.0);
+
+	return log2_1p (f, e);
+}
+
+static inline double fn_logep (double x)
+{
+	return log2_1p (x, 0);
+}
+
+/*
+ * atan2 (y, x): t = min / max of |x| and |y| <= 1, atan (t) = c + atan (u)
+ * where c is 0, atan (1/2) or pi/4 and |u| <= 0.185, then result is
+ * b + atan (t) or b - atan (t) for b of 0, pi/2 or pi by octant; error
+ * of t rounding goes to low part
+ */
+#define AT0	 3.33333333333329318027e-01
+#define AT1	-1.99999999998764832476e-01
+#define AT2	 1.42857142725034663711e-01
+#define AT3	-1.11111104054623557880e-01
+#define AT4	 9.09088713343650656196e-02
+#define AT5	-7.69187620504482999495e-02
+#define AT6	 6.66107313738753120669e-02
+#define AT7	-5.83357013379057348645e-02
+#define AT8	 4.97687799461593236017e-02
+#define AT9	-3.65315727442169155270e-02
+#define AT10	 1.62858201153657823623e-02
+
+#define ATAN_HALF_HI	4.63647609000806093515e-01
+#define ATAN_HALF_LO	2.26987774529616870924e-17
+#define PIO4_HI		7.85398163397448278999e-01
+#define PIO4_LO		3.06161699786838301793e-17
+#define PIO2_HI		1.57079632679489655800e+00
+#define PIO2_LO		6.12323399573676603587e-17
+#define PI_HI		3.14159265358979311600e+00
+#define PI_LO		1.22464679914735320717e-16
+
+static inline double fn_atan (double y, double x)
+{
+	const double ax = fabs_ (x), ay = fabs_ (y);
+	const double n  = ay > ax ? ax : ay;
+	const double d  = ay > ax ? ay : ax;
+	const double t  = n / d;
+	const double u  = t < 7.0/16  ? t :
+			  t < 11.0/16 ? (2 * t - 1) / (2 + t) : (t - 1) / (t + 1);
+	const double z  = u * u;
+	const double w  = z * z;
+	const double s1 = z * (AT0 + w * (AT2 + w * (AT4 + w * (AT6 +
+			  w * (AT8 + w * AT10)))));
+	const double s2 = w * (AT1 + w * (AT3 + w * (AT5 + w * (AT7 +
+			  w * AT9))));
+	const double v  = u * (s1 + s2);		/* atan (u) = u - v */
+	const double sw = ay > ax ? -1.0 : 1.0;
+	const double sg = x < 0 ? -sw : sw;
+	const double ch = t < 7.0/16 ? 0 : t < 11.0/16 ? ATAN_HALF_HI : PIO4_HI;
+	const double cl = t < 7.0/16 ? 0 : t < 11.0/16 ? ATAN_HALF_LO : PIO4_LO;
+	const double Bh = ay > ax ? PIO2_HI : x < 0 ? PI_HI : 0;
+	const double Bl = ay > ax ? PIO2_LO : x < 0 ? PI_LO : 0;
+	double bl, bh = sum_exact (Bh, sg * ch, &bl);
+	double pl, p = mul_exact (t, d, &pl);
+
+	bl += Bl + sg * (cl + ((n - p) - pl) / d / (1 + t * t));
+	return flip (bh + ((bl - sg * v) + sg * u), bits (y));
+}
+
+/*
+ * Result status: kernel domain and exact results
+ */
+static int fn_status (int fn, double x, double y)
+{
+	const uint64_t u = bits (x), v = bits (y);
+	const int ex = (u >> 52) & 0x7ff, ey = (v >> 52) & 0x7ff;
+
+	switch (fn) {
+	case I960_FN_ATAN:
+		/* min / max is normal */
+		return normal (u) && normal (v) && ex - ey < 1000 &&
+		       ey - ex < 1000 ? I960_FN_INEXACT : I960_FN_OUT;
+	case I960_FN_LOGEP:
+		/* FYL2XP1 domain of 80387: |x| < 1 - sqrt (2) / 2 */
+		return normal (u) && fabs_ (x) < 0.29289321881345247560 ?
+		       I960_FN_INEXACT : I960_FN_OUT;
+	case I960_FN_LOG:
+		return !normal (u) || (u & SIGN) ? I960_FN_OUT :
+		       (u & 0xfffffffffffffull) == 0 ? I960_FN_EXACT :
+						       I960_FN_INEXACT;
+	case I960_FN_EXP:
+		/* 2^k - 1 is exact for integer |k| <= 53 */
+		return !normal (u) || fabs_ (x) >= 1000 ? I960_FN_OUT :
+		       fabs_ (x) <= 53 && (x + SHIFT) - SHIFT == x ?
+		       I960_FN_EXACT : I960_FN_INEXACT;
+	}
+
+	return normal (u) && fabs_ (x) < 0x1p16 ? I960_FN_INEXACT :
+						      I960_FN_OUT;
+}
+
+int i960_fpu_fn (int fn, double x, double y, double *r)
+{
+	const int s = fn_status (fn, x, y);
+
+	if (s == I960_FN_OUT)
+		return s;
+
+	switch (fn) {
+	case I960_FN_ATAN:	*r = fn_atan (y, x);			break;
+	case I960_FN_LOGEP:	*r = fn_logep (x);			break;
+	case I960_FN_LOG:	*r = fn_log (x);			break;
+	case I960_FN_EXP:	*r = fn_exp (x);			break;
+	case I960_FN_SIN:
+	case I960_FN_COS:
+	case I960_FN_TAN:	*r = fn_trig (fn, x);			break;
+	default:		return I960_FN_OUT;
+	}
+
+	return s;
+}
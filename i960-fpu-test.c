@@ -0,0 +1,705 @@
+/*
+ * 80960 Emulator Floating-Point Instructions Test
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Instructions run through i960_reg in all four rounding modes and in
+ * fast path state, results and exception flags are checked against host
+ * float and double arithmetic done in the same rounding mode. Unmasked
+ * exceptions must raise fault and leave destination intact.
+ */
+
+#include <fenv.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <i960-emu.h>
+#include <i960-emu-bits.h>
+#include <i960-emu-fpr.h>
+#include <i960-emu-ops.h>
+
+uint8_t  i960_read_b (struct i960 *o, uint32_t addr) { return 0; }
+uint16_t i960_read_s (struct i960 *o, uint32_t addr) { return 0; }
+uint32_t i960_read_w (struct i960 *o, uint32_t addr) { return 0; }
+
+void i960_write_b (struct i960 *o, uint32_t addr, uint32_t x) {}
+void i960_write_s (struct i960 *o, uint32_t addr, uint32_t x) {}
+void i960_write_w (struct i960 *o, uint32_t addr, uint32_t x) {}
+
+void *i960_map (struct i960 *o, uint32_t addr, uint32_t size, int write)
+{
+	return NULL;
+}
+
+static int fault;
+
+void i960_fault (struct i960 *o, int type)
+{
+	fault = type;
+}
+
+void i960_calls (struct i960 *o, int type) {}
+
+/*
+ * Operands: src1 in r4, src2 in r8, destination in r12, all of them can
+ * hold extended real triple
+ */
+#define SRC1	4
+#define SRC2	8
+#define DST	12
+
+#define M1	1			/* src1 is literal or fp0-fp3	*/
+#define M2	2			/* src2 is literal or fp0-fp3	*/
+#define M3	4			/* dst is fp0-fp3		*/
+
+#define FPU_OVERFLOW	1
+#define FPU_UNDERFLOW	2
+#define FPU_INVALID	4
+#define FPU_ZDIV	8
+#define FPU_INEXACT	16
+
+static uint32_t fpu_op (uint32_t code, int c, int b, int a, int m)
+{
+	return (code >> 4) << 24 | c << 19 | b << 14 | m << 11 |
+	       (code & 15) << 7 | a;
+}
+
+static const int host_mode[4] = {
+	FE_TONEAREST, FE_DOWNWARD, FE_UPWARD, FE_TOWARDZERO,
+};
+
+/*
+ * Mode 4 is round to nearest with inexact flag already set: the only
+ * state where host fast path is taken
+ */
+#define MODE_FAST	4
+
+static const char *mode_name[5] = {
+	"nearest", "down", "up", "zero", "fast",
+};
+
+static void exec_op (struct i960 *o, uint32_t op)
+{
+	struct i960_insn in;
+
+	i960_decode (&in, op, 0);
+	i960_reg (o, &in);
+}
+
+/*
+ * Runs instruction with all exceptions masked and flags cleared, returns
+ * exception flags raised
+ */
+static unsigned run (struct i960 *o, uint32_t op, int mode)
+{
+	o->ac = 0x1fu << I960_FPM_POS;
+
+	if (mode == MODE_FAST)
+		o->ac |= FPU_INEXACT << I960_FPF_POS;
+	else
+		o->ac |= (uint32_t) mode << I960_RND_POS;
+
+	fault = 0;
+	exec_op (o, op);
+	return u32_extract (o->ac, I960_FPF_POS, 5);
+}
+
+static unsigned host_flags (void)
+{
+	const int e = fetestexcept (FE_ALL_EXCEPT);
+
+	return	(e & FE_OVERFLOW  ? FPU_OVERFLOW  : 0) |
+		(e & FE_UNDERFLOW ? FPU_UNDERFLOW : 0) |
+		(e & FE_INVALID   ? FPU_INVALID   : 0) |
+		(e & FE_DIVBYZERO ? FPU_ZDIV      : 0) |
+		(e & FE_INEXACT   ? FPU_INEXACT   : 0);
+}
+
+static void host_enter (int mode)
+{
+	feclearexcept (FE_ALL_EXCEPT);
+
+	if (mode == MODE_FAST)
+		feraiseexcept (FE_INEXACT);
+	else
+		fesetround (host_mode[mode]);
+}
+
+static unsigned host_leave (void)
+{
+	const unsigned flags = host_flags ();
+
+	fesetround (FE_TONEAREST);
+	return flags;
+}
+
+/*
+ * Host formats
+ */
+static float f32_from (uint32_t x)
+{
+	float r;
+
+	memcpy (&r, &x, sizeof (r));
+	return r;
+}
+
+static uint32_t f32_bits (float x)
+{
+	uint32_t r;
+
+	memcpy (&r, &x, sizeof (r));
+	return r;
+}
+
+static double f64_get (const struct i960 *o, size_t i)
+{
+	const uint64_t x = (uint64_t) o->r[i + 1] << 32 | o->r[i];
+	double r;
+
+	memcpy (&r, &x, sizeof (r));
+	return r;
+}
+
+static void f64_set (struct i960 *o, size_t i, double x)
+{
+	uint64_t b;
+
+	memcpy (&b, &x, sizeof (b));
+	o->r[i + 0] = b;
+	o->r[i + 1] = b >> 32;
+}
+
+static long double f80_get (const struct i960 *o, size_t i)
+{
+	const uint64_t m = (uint64_t) o->r[i + 1] << 32 | o->r[i];
+	const int e = o->r[i + 2] & 0x7fff;
+	const long double r = ldexpl (m, (e == 0 ? 1 : e) - 16383 - 63);
+
+	return o->r[i + 2] & 0x8000 ? -r : r;
+}
+
+/*
+ * Report
+ */
+static int failed, passed;
+
+__attribute__ ((format (printf, 4, 5)))
+static void check (int ok, const char *name, int mode, const char *fmt, ...)
+{
+	va_list ap;
+
+	if (ok) {
+		++passed;
+		return;
+	}
+
+	printf ("FAIL %-8s %-7s ", name, mode < 0 ? "" : mode_name[mode]);
+
+	va_start (ap, fmt);
+	vprintf (fmt, ap);
+	va_end (ap);
+
+	printf ("\n");
+	++failed;
+}
+
+static int same_s (float x, float y)
+{
+	return f32_bits (x) == f32_bits (y) || (isnan (x) && isnan (y));
+}
+
+static int same_d (double x, double y)
+{
+	return memcmp (&x, &y, sizeof (x)) == 0 || (isnan (x) && isnan (y));
+}
+
+/*
+ * Arithmetic: addr, subr, mulr, divr, sqrtr and long real forms compute
+ * src2 op src1
+ */
+enum fn { ADD, SUB, MUL, DIV, SQRT };
+
+static const struct arith {
+	const char *name;
+	uint32_t code;
+	enum fn fn;
+	int wide;
+} arith[] = {
+	{ "addr",   0x78F, ADD,  0 },
+	{ "subr",   0x78D, SUB,  0 },
+	{ "mulr",   0x78C, MUL,  0 },
+	{ "divr",   0x78B, DIV,  0 },
+	{ "sqrtr",  0x688, SQRT, 0 },
+	{ "addrl",  0x79F, ADD,  1 },
+	{ "subrl",  0x79D, SUB,  1 },
+	{ "mulrl",  0x79C, MUL,  1 },
+	{ "divrl",  0x79B, DIV,  1 },
+	{ "sqrtrl", 0x698, SQRT, 1 },
+};
+
+static const double values[] = {
+	0.0, -0.0, 1.0, -1.5, 2.25, 3.0, 0.1, -7.125, 1.0 / 3, 1e-30,
+	1e30, 1e-300, 1e300, 5e-324, INFINITY, -INFINITY, NAN,
+};
+
+#define ARRAY_SIZE(a)	(sizeof (a) / sizeof ((a)[0]))
+
+static float host_s (enum fn fn, float a, float b, int mode, unsigned *flags)
+{
+	volatile float x = a, y = b, r;
+
+	host_enter (mode);
+
+	switch (fn) {
+	case ADD:  r = y + x;  break;
+	case SUB:  r = y - x;  break;
+	case MUL:  r = y * x;  break;
+	case DIV:  r = y / x;  break;
+	default:   r = sqrtf (x);
+	}
+
+	*flags = host_leave ();
+	return r;
+}
+
+static double host_d (enum fn fn, double a, double b, int mode, unsigned *flags)
+{
+	volatile double x = a, y = b, r;
+
+	host_enter (mode);
+
+	switch (fn) {
+	case ADD:  r = y + x;  break;
+	case SUB:  r = y - x;  break;
+	case MUL:  r = y * x;  break;
+	case DIV:  r = y / x;  break;
+	default:   r = sqrt (x);
+	}
+
+	*flags = host_leave ();
+	return r;
+}
+
+static void test_arith (struct i960 *o, const struct arith *t)
+{
+	const uint32_t op = fpu_op (t->code, DST, SRC2, SRC1, 0);
+	size_t i, j, nj = t->fn == SQRT ? 1 : ARRAY_SIZE (values);
+	unsigned flags, ref_flags;
+	float xs, ys, rs;
+	double r;
+	int mode;
+
+	for (mode = 0; mode <= MODE_FAST; ++mode)
+	for (i = 0; i < ARRAY_SIZE (values); ++i)
+	for (j = 0; j < nj; ++j)
+		if (t->wide) {
+			f64_set (o, SRC1, values[i]);
+			f64_set (o, SRC2, values[j]);
+			flags = run (o, op, mode);
+			r = host_d (t->fn, values[i], values[j], mode,
+				    &ref_flags);
+
+			check (same_d (f64_get (o, DST), r) &&
+			       flags == ref_flags, t->name, mode,
+			       "%g, %g -> %.17g/%02x, expected %.17g/%02x",
+			       values[i], values[j], f64_get (o, DST), flags,
+			       r, ref_flags);
+		}
+		else {
+			xs = values[i], ys = values[j];
+			o->r[SRC1] = f32_bits (xs);
+			o->r[SRC2] = f32_bits (ys);
+			flags = run (o, op, mode);
+			rs = host_s (t->fn, xs, ys, mode, &ref_flags);
+
+			check (same_s (f32_from (o->r[DST]), rs) &&
+			       flags == ref_flags, t->name, mode,
+			       "%g, %g -> %.9g/%02x, expected %.9g/%02x",
+			       xs, ys, f32_from (o->r[DST]), flags, rs,
+			       ref_flags);
+		}
+}
+
+/*
+ * Compare: condition code 100 -- src1 < src2, 010 -- equal, 001 --
+ * src1 > src2, 000 -- unordered; cmpor signals invalid on unordered,
+ * cmpr on signaling NaN only
+ */
+static void test_cmpr (struct i960 *o)
+{
+	static const uint32_t v[] = {
+		0x00000000, 0x80000000, 0x3f800000, 0xbfc00000, 0x40000000,
+		0x7f800000, 0xff800000, 0x7fc00000, 0x7fa00000,
+	};
+	const uint32_t cmpr  = fpu_op (0x685, 0, SRC2, SRC1, 0);
+	const uint32_t cmpor = fpu_op (0x684, 0, SRC2, SRC1, 0);
+	size_t i, j;
+	float x, y;
+	unsigned flags, cc, ref;
+	int snan;
+
+	for (i = 0; i < ARRAY_SIZE (v); ++i)
+	for (j = 0; j < ARRAY_SIZE (v); ++j) {
+		o->r[SRC1] = v[i], x = f32_from (v[i]);
+		o->r[SRC2] = v[j], y = f32_from (v[j]);
+
+		ref  = isless (x, y) ? 4 : isgreater (x, y) ? 1 :
+		       x == y ? 2 : 0;
+		snan = v[i] == 0x7fa00000 || v[j] == 0x7fa00000;
+
+		flags = run (o, cmpr, 0), cc = o->ac & 7;
+		check (cc == ref && flags == (snan ? FPU_INVALID : 0),
+		       "cmpr", -1, "%08x, %08x -> cc %u/%02x, expected %u",
+		       v[i], v[j], cc, flags, ref);
+
+		flags = run (o, cmpor, 0), cc = o->ac & 7;
+		check (cc == ref && flags == (ref == 0 ? FPU_INVALID : 0),
+		       "cmpor", -1, "%08x, %08x -> cc %u/%02x, expected %u",
+		       v[i], v[j], cc, flags, ref);
+	}
+
+	/* literal +1.0 against register */
+	o->r[SRC2] = 0x3f800000;
+	run (o, fpu_op (0x685, 0, SRC2, 0x16, M1), 0);
+	check ((o->ac & 7) == 2, "cmpr", -1, "1.0 literal -> cc %u",
+	       o->ac & 7);
+}
+
+/*
+ * Classify: AC[6] is sign, AC[5:3] is class
+ */
+static void test_classr (struct i960 *o)
+{
+	static const struct {
+		uint32_t s, lo, hi;	/* real and long real		*/
+		unsigned cls;
+	} v[] = {
+		{ 0x00000000, 0, 0x00000000, 0x0 },	/* zero		*/
+		{ 0x80000000, 0, 0x80000000, 0x8 },	/* minus zero	*/
+		{ 0x00000001, 1, 0x00000000, 0x1 },	/* denormal	*/
+		{ 0xbf800000, 0, 0xbff00000, 0xa },	/* normal	*/
+		{ 0xff800000, 0, 0xfff00000, 0xb },	/* infinity	*/
+		{ 0x7fc00000, 0, 0x7ff80000, 0x4 },	/* quiet NaN	*/
+		{ 0x7fa00000, 0, 0x7ff40000, 0x5 },	/* signaling NaN */
+	};
+	size_t i;
+	unsigned cls;
+
+	for (i = 0; i < ARRAY_SIZE (v); ++i) {
+		o->r[SRC1] = v[i].s;
+		run (o, fpu_op (0x68F, 0, 0, SRC1, 0), 0);
+		cls = u32_extract (o->ac, I960_AS_POS, 4);
+
+		check (cls == v[i].cls, "classr", -1,
+		       "%08x -> %x, expected %x", v[i].s, cls, v[i].cls);
+
+		o->r[SRC1 + 0] = v[i].lo;
+		o->r[SRC1 + 1] = v[i].hi;
+		run (o, fpu_op (0x69F, 0, 0, SRC1, 0), 0);
+		cls = u32_extract (o->ac, I960_AS_POS, 4);
+
+		check (cls == v[i].cls, "classrl", -1,
+		       "%08x %08x -> %x, expected %x", v[i].hi, v[i].lo, cls,
+		       v[i].cls);
+	}
+}
+
+/*
+ * Conversions: integer to real rounds in current mode, real to integer
+ * rounds in current mode or truncates, out of range is invalid
+ */
+static void test_cvtir (struct i960 *o)
+{
+	static const int64_t v[] = {
+		0, 1, -1, 16777217, -16777219, INT32_MIN, INT32_MAX,
+		123456789, (1ll << 53) + 1, -(1ll << 60) - 3, INT64_MAX,
+	};
+	size_t i;
+	int mode;
+	volatile int32_t n;
+	volatile int64_t l;
+	volatile float rs;
+	volatile double rd;
+	unsigned flags, ref;
+
+	for (mode = 0; mode < 4; ++mode)
+	for (i = 0; i < ARRAY_SIZE (v); ++i) {
+		o->r[SRC1 + 0] = v[i];
+		o->r[SRC1 + 1] = (uint64_t) v[i] >> 32;
+
+		n = v[i];
+		host_enter (mode), rs = n, ref = host_leave ();
+		flags = run (o, fpu_op (0x674, DST, 0, SRC1, 0), mode);
+
+		check (same_s (f32_from (o->r[DST]), rs) && flags == ref,
+		       "cvtir", mode, "%d -> %.9g, expected %.9g", (int) n,
+		       f32_from (o->r[DST]), rs);
+
+		l = v[i];
+		host_enter (mode), rd = l, ref = host_leave ();
+		flags = run (o, fpu_op (0x675, DST, 0, SRC1, 0), mode);
+
+		check (same_d (f64_get (o, DST), rd) && flags == ref,
+		       "cvtilr", mode, "%lld -> %.17g, expected %.17g",
+		       (long long) l, f64_get (o, DST), rd);
+	}
+
+	/* literal source, extended destination is exact */
+	run (o, fpu_op (0x674, 1, 0, 5, M3 | M1), 0);
+	check (i960_fpr_get (o->fp + 1) == 5, "cvtir", -1, "5 -> fp1 %Lg",
+	       i960_fpr_get (o->fp + 1));
+
+	o->r[SRC1 + 0] = 1, o->r[SRC1 + 1] = 1u << 31;	/* -2^63 + 1 */
+	run (o, fpu_op (0x675, 2, 0, SRC1, M3), 0);
+	check (i960_fpr_get (o->fp + 2) == -0x7fffffffffffffffll, "cvtilr",
+	       -1, "-2^63 + 1 -> fp2 %Lg", i960_fpr_get (o->fp + 2));
+}
+
+static void test_cvtri (struct i960 *o)
+{
+	static const double v[] = {
+		0.0, 0.49, 0.5, 1.5, 2.5, -2.5, -2.7, 3.5, 1e6 + 0.75,
+		-2147483648.0, 2147483520.0, 1e20, -1e20,
+	};
+	static const struct {
+		const char *name;
+		uint32_t code;
+		int wide, trunc;
+	} t[] = {
+		{ "cvtri",   0x6C0, 0, 0 },
+		{ "cvtril",  0x6C1, 1, 0 },
+		{ "cvtzri",  0x6C2, 0, 1 },
+		{ "cvtzril", 0x6C3, 1, 1 },
+	};
+	size_t i, k;
+	int mode, range;
+	double x, r;
+	int64_t got, ref;
+	unsigned flags, ref_flags;
+
+	for (k = 0; k < ARRAY_SIZE (t); ++k)
+	for (mode = 0; mode < 4; ++mode)
+	for (i = 0; i < ARRAY_SIZE (v); ++i) {
+		x = t[k].wide ? v[i] : (float) v[i];
+
+		if (t[k].wide)
+			f64_set (o, SRC1, x);
+		else
+			o->r[SRC1] = f32_bits (x);
+
+		o->r[DST + 0] = o->r[DST + 1] = 0;
+		flags = run (o, fpu_op (t[k].code, DST, 0, SRC1, 0), mode);
+
+		host_enter (t[k].trunc ? 3 : mode);
+		r = rint (x);
+		host_leave ();
+
+		range = t[k].wide ? fabs (r) < 0x1p63 :
+				    r >= INT32_MIN && r <= INT32_MAX;
+		ref = !range ? INT32_MIN : (int64_t) r;
+		ref_flags = !range ? FPU_INVALID : r != x ? FPU_INEXACT : 0;
+		got = t[k].wide ?
+		      (int64_t) ((uint64_t) o->r[DST + 1] << 32 | o->r[DST]) :
+		      (int32_t) o->r[DST];
+
+		if (!range && t[k].wide)
+			check (flags & FPU_INVALID, t[k].name, mode,
+			       "%.17g -> %02x, expected invalid", x, flags);
+		else
+			check (got == ref && flags == ref_flags, t[k].name,
+			       mode, "%.17g -> %lld/%02x, expected %lld/%02x",
+			       x, (long long) got, flags, (long long) ref,
+			       ref_flags);
+	}
+}
+
+/*
+ * Moves are exact, value goes through fp register unchanged
+ */
+static void test_move (struct i960 *o)
+{
+	static const uint32_t e[][3] = {
+		{ 0x00000000, 0x80000000, 0x3fff },	/*  1.0		*/
+		{ 0xaaaaaaab, 0xaaaaaaaa, 0x3ffd },	/*  1/3		*/
+		{ 0x00000000, 0xc0000000, 0xc000 },	/* -3.0		*/
+		{ 0x00000001, 0x80000000, 0x7ffe },	/*  near max	*/
+	};
+	size_t i;
+
+	o->r[SRC1] = f32_bits (-7.125f);
+	run (o, fpu_op (0x6C9, DST, 0, SRC1, 0), 0);
+	check (o->r[DST] == o->r[SRC1], "movr", -1, "r -> r %08x", o->r[DST]);
+
+	o->r[DST] = 0;
+	run (o, fpu_op (0x6C9, 3, 0, SRC1, M3), 0);
+	run (o, fpu_op (0x6C9, DST, 0, 3, M1), 0);
+	check (o->r[DST] == o->r[SRC1], "movr", -1, "fp -> r %08x",
+	       o->r[DST]);
+
+	run (o, fpu_op (0x6C9, DST, 0, 0x16, M1), 0);
+	check (o->r[DST] == 0x3f800000, "movr", -1, "1.0 -> %08x",
+	       o->r[DST]);
+
+	f64_set (o, SRC1, 1.0 / 3);
+	f64_set (o, DST, 0);
+	run (o, fpu_op (0x6D9, 0, 0, SRC1, M3), 0);
+	run (o, fpu_op (0x6D9, DST, 0, 0, M1), 0);
+	check (f64_get (o, DST) == 1.0 / 3, "movrl", -1, "fp -> r %.17g",
+	       f64_get (o, DST));
+
+	for (i = 0; i < ARRAY_SIZE (e); ++i) {
+		memcpy (o->r + SRC1, e[i], sizeof (e[i]));
+		memset (o->r + DST, 0, sizeof (e[i]));
+		run (o, fpu_op (0x6E1, DST, 0, SRC1, 0), 0);
+		check (memcmp (o->r + DST, e[i], sizeof (e[i])) == 0,
+		       "movre", -1, "r -> r %04x %08x %08x", o->r[DST + 2],
+		       o->r[DST + 1], o->r[DST]);
+
+		memset (o->r + DST, 0, sizeof (e[i]));
+		run (o, fpu_op (0x6E1, 2, 0, SRC1, M3), 0);
+		run (o, fpu_op (0x6E1, DST, 0, 2, M1), 0);
+		check (memcmp (o->r + DST, e[i], sizeof (e[i])) == 0 &&
+		       i960_fpr_get (o->fp + 2) == f80_get (o, SRC1),
+		       "movre", -1, "fp -> r %04x %08x %08x", o->r[DST + 2],
+		       o->r[DST + 1], o->r[DST]);
+	}
+
+	/* 6E9 is not a move */
+	run (o, fpu_op (0x6E9, DST, 0, SRC1, 0), 0);
+	check (fault == 0x20001, "movre", -1, "6E9 -> fault %05x", fault);
+}
+
+/*
+ * Extended precision: float operands in fp registers give float result,
+ * extended destination keeps it exactly
+ */
+static void test_extended (struct i960 *o)
+{
+	const float ref = 1.0f / 3;
+
+	run (o, fpu_op (0x674, 1, 0, 3, M3 | M1), 0);	/* fp1 = 3 */
+	run (o, fpu_op (0x78B, 2, 0x16, 1, M3 | M2 | M1), 0);
+	run (o, fpu_op (0x6E1, DST, 0, 2, M1), 0);
+	check (f80_get (o, DST) == ref, "divr", -1,
+	       "fp -> fp %.20Lg, expected %.9g", f80_get (o, DST), ref);
+
+	run (o, fpu_op (0x79B, 2, 0x16, 1, M3 | M2 | M1), 0);
+	check (i960_fpr_get (o->fp + 2) == 1.0 / 3, "divrl", -1,
+	       "fp -> fp %.20Lg", i960_fpr_get (o->fp + 2));
+}
+
+/*
+ * Scale: src2 times two to the power of integer src1
+ */
+static void test_scaler (struct i960 *o)
+{
+	static const int n[] = { 0, 3, -2, 100, -100, 2000, -2000 };
+	static const double v[] = { 1.0, -1.5, 0.1, 3e10, INFINITY };
+	size_t i, j;
+	int mode;
+	unsigned flags, ref_flags;
+	float xs;
+	volatile float rs;
+	volatile double rd;
+
+	for (mode = 0; mode < 4; ++mode)
+	for (i = 0; i < ARRAY_SIZE (n); ++i)
+	for (j = 0; j < ARRAY_SIZE (v); ++j) {
+		xs = v[j];
+		o->r[SRC1] = n[i];
+		o->r[SRC2] = f32_bits (xs);
+		flags = run (o, fpu_op (0x677, DST, SRC2, SRC1, 0), mode);
+
+		host_enter (mode);
+		rs = scalbnf (xs, n[i]);
+		ref_flags = host_leave ();
+
+		check (same_s (f32_from (o->r[DST]), rs) &&
+		       flags == ref_flags, "scaler", mode,
+		       "%g * 2^%d -> %.9g/%02x, expected %.9g/%02x",
+		       xs, n[i], f32_from (o->r[DST]), flags, rs,
+		       ref_flags);
+
+		f64_set (o, SRC2, v[j]);
+		flags = run (o, fpu_op (0x676, DST, SRC2, SRC1, 0), mode);
+
+		host_enter (mode);
+		rd = scalbn (v[j], n[i]);
+		ref_flags = host_leave ();
+
+		check (same_d (f64_get (o, DST), rd) && flags == ref_flags,
+		       "scalerl", mode,
+		       "%g * 2^%d -> %.17g/%02x, expected %.17g/%02x",
+		       v[j], n[i], f64_get (o, DST), flags, rd, ref_flags);
+	}
+}
+
+/*
+ * Exceptions: masked one sets flag and stores result, unmasked one
+ * raises fault and keeps destination
+ */
+static void test_except (struct i960 *o)
+{
+	static const struct {
+		const char *name;
+		uint32_t code;
+		float x, y;		/* src1, src2 */
+		unsigned flag;
+		int type;
+	} t[] = {
+		{ "overflow",  0x78C, 1e30f,  1e30f,  FPU_OVERFLOW,  0x40001 },
+		{ "underflow", 0x78C, 1e-30f, 1e-30f, FPU_UNDERFLOW, 0x40002 },
+		{ "invalid",   0x688, -1.0f,  0.0f,   FPU_INVALID,   0x40004 },
+		{ "zdiv",      0x78B, 0.0f,   1.0f,   FPU_ZDIV,      0x40008 },
+		{ "inexact",   0x78B, 3.0f,   1.0f,   FPU_INEXACT,   0x40010 },
+	};
+	const uint32_t keep = 0x12345678;
+	size_t i;
+	unsigned flags;
+
+	for (i = 0; i < ARRAY_SIZE (t); ++i) {
+		o->r[SRC1] = f32_bits (t[i].x);
+		o->r[SRC2] = f32_bits (t[i].y);
+
+		o->r[DST] = keep;
+		flags = run (o, fpu_op (t[i].code, DST, SRC2, SRC1, 0), 0);
+
+		check ((flags & t[i].flag) != 0 && fault == 0 &&
+		       o->r[DST] != keep, t[i].name, -1,
+		       "masked -> flags %02x, fault %05x", flags, fault);
+
+		o->r[DST] = keep;
+		o->ac = (0x1fu & ~t[i].flag) << I960_FPM_POS;
+		fault = 0;
+		exec_op (o, fpu_op (t[i].code, DST, SRC2, SRC1, 0));
+
+		check (fault == t[i].type && o->r[DST] == keep, t[i].name, -1,
+		       "unmasked -> fault %05x, dst %08x", fault, o->r[DST]);
+	}
+}
+
+int main (int argc, char *argv[])
+{
+	struct i960 o = {};
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE (arith); ++i)
+		test_arith (&o, arith + i);
+
+	test_cmpr     (&o);
+	test_classr   (&o);
+	test_cvtir    (&o);
+	test_cvtri    (&o);
+	test_move     (&o);
+	test_extended (&o);
+	test_scaler   (&o);
+	test_except   (&o);
+
+	printf ("i960-fpu-test: %d passed, %d failed\n", passed, failed);
+	return failed == 0 ? 0 : 1;
+}
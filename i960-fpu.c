@@ -0,0 +1,908 @@
+/*
+ * 80960 Emulator Floating-Point Unit
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * 80960KB/SB real operations. Single and double precision operations on
+ * register operands run directly on host in round-to-nearest mode when
+ * inexact exception is masked and flagged already, and both operands and
+ * result are normal numbers: no other exception is possible then.
+ * Everything else (other rounding modes, zeros, denormals, infinities,
+ * NaNs, fp0-fp3 extended operands, unmasked exceptions) runs on host with
+ * rounding mode and exception flags managed through fenv(3).
+ *
+ * Registers fp0-fp3 keep values in host format they were produced in, so
+ * chains of real or long real operations over them stay on fast path.
+ */
+
+#include <fenv.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include <i960-emu.h>
+#include <i960-emu-bits.h>
+#include <i960-emu-compare.h>
+#include <i960-emu-faults.h>
+#include <i960-emu-fpr.h>
+#include <i960-emu-ops.h>
+#include <i960-fpu-fn.h>
+
+/*
+ * AC floating-point exception flag and mask bits
+ */
+#define FPU_OVERFLOW	1
+#define FPU_UNDERFLOW	2
+#define FPU_INVALID	4
+#define FPU_ZDIV	8
+#define FPU_INEXACT	16
+
+#define FPU_FAST_MASK	(3u << I960_RND_POS | FPU_INEXACT << I960_FPF_POS | \
+			 FPU_INEXACT << I960_FPM_POS)
+#define FPU_FAST	(FPU_INEXACT << I960_FPF_POS | FPU_INEXACT << I960_FPM_POS)
+
+enum fpu_prec {
+	FPU_S,				/* real, 32-bit			*/
+	FPU_D,				/* long real, 64-bit		*/
+	FPU_E,				/* extended real, 80-bit	*/
+};
+
+enum fpu_fn {
+	FPU_ADD, FPU_SUB, FPU_MUL, FPU_DIV, FPU_REM,
+	FPU_SQRT, FPU_LOGB, FPU_ROUND,	/* unary, operand is src1	*/
+};
+
+/* keeps compiler from moving FP operations out of fenv brackets */
+#define fpu_barrier(x)	__asm__ volatile ("" : "+m" (x))
+
+static inline int fpu_fast (const struct i960 *o)
+{
+	return (o->ac & FPU_FAST_MASK) == FPU_FAST;
+}
+
+/*
+ * Host Formats
+ */
+static inline float f32_from (uint32_t x)
+{
+	float r;
+
+	memcpy (&r, &x, sizeof (r));
+	return r;
+}
+
+static inline uint32_t f32_bits (float x)
+{
+	uint32_t r;
+
+	memcpy (&r, &x, sizeof (r));
+	return r;
+}
+
+static inline double f64_from (uint32_t lo, uint32_t hi)
+{
+	const uint64_t x = (uint64_t) hi << 32 | lo;
+	double r;
+
+	memcpy (&r, &x, sizeof (r));
+	return r;
+}
+
+static inline uint64_t f64_bits (double x)
+{
+	uint64_t r;
+
+	memcpy (&r, &x, sizeof (r));
+	return r;
+}
+
+static inline int f32_normal (uint32_t x)
+{
+	return (((x >> 23) + 1) & 0xff) > 1;
+}
+
+static inline int f64_normal (uint64_t x)
+{
+	return (((x >> 52) + 1) & 0x7ff) > 1;
+}
+
+/*
+ * Extended real: words 0 and 1 hold significand with explicit integer
+ * bit, low half of word 2 holds sign and 15-bit exponent
+ */
+static long double f80_from (uint32_t lo, uint32_t hi, uint32_t se)
+{
+	const uint64_t m = (uint64_t) hi << 32 | lo;
+#if LDBL_MANT_DIG == 64
+	unsigned char b[sizeof (long double)] = {};
+	const uint16_t s = se;
+	long double r;
+
+	memcpy (b, &m, 8);
+	memcpy (b + 8, &s, 2);
+	memcpy (&r, b, sizeof (r));
+	return r;
+#else
+	const int e = se & 0x7fff;
+	long double r;
+
+	if (e == 0x7fff)
+		r = (m << 1) == 0 ? INFINITY : NAN;
+	else
+		r = ldexpl (m, (e == 0 ? 1 : e) - 16383 - 63);
+
+	return se & 0x8000 ? -r : r;
+#endif
+}
+
+static void f80_bits (long double x, uint32_t *w)
+{
+	uint64_t m;
+#if LDBL_MANT_DIG == 64
+	unsigned char b[sizeof (long double)];
+	uint16_t se;
+
+	memcpy (b, &x, sizeof (x));
+	memcpy (&m, b, 8);
+	memcpy (&se, b + 8, 2);
+#else
+	uint32_t se = signbit (x) ? 0x8000 : 0;
+	int e;
+
+	x = fabsl (x);
+
+	if (isnan (x))
+		se |= 0x7fff, m = 3ull << 62;
+	else if (isinf (x))
+		se |= 0x7fff, m = 1ull << 63;
+	else if (x == 0)
+		m = 0;
+	else {
+		x = frexpl (x, &e);
+		e += 16382;
+
+		if (e <= 0)
+			x = ldexpl (x, e - 1), e = 0;
+
+		se |= e;
+		m = ldexpl (x, 64);
+	}
+#endif
+	w[0] = m;
+	w[1] = m >> 32;
+	w[2] = se;
+}
+
+/*
+ * Operands: if M bit is set then field selects fp0-fp3 or constant
+ * +0.0 (10000) or +1.0 (10110), otherwise register, pair or triple
+ */
+#define FPU_M1(op)	u32_bit_select (op, 11)
+#define FPU_M2(op)	u32_bit_select (op, 12)
+#define FPU_M3(op)	u32_bit_select (op, 13)
+
+static long double fpu_load (const struct i960 *o, size_t i, int prec)
+{
+	switch (prec) {
+	case FPU_S:  return f32_from (o->r[i]);
+	case FPU_D:  return f64_from (o->r[i | 0], o->r[i | 1]);
+	}
+
+	return f80_from (o->r[i | 0], o->r[i | 1], o->r[i | 2]);
+}
+
+static int fpu_fits (long double x, int prec)
+{
+	switch (prec) {
+	case FPU_S:  return (float)  x == x || isnan (x);
+	case FPU_D:  return (double) x == x || isnan (x);
+	}
+
+	return 1;
+}
+
+static long double fpu_src (const struct i960 *o, uint32_t op, int slot,
+			    int prec, int *ok, int *fit)
+{
+	const uint32_t i = slot ? u32_extract (op, 14, 5) : op & 31;
+	const int m = slot ? FPU_M2 (op) : FPU_M1 (op);
+	long double x;
+
+	if (!m)
+		return fpu_load (o, i, prec);
+
+	switch (i) {
+	case 0x00: case 0x01: case 0x02: case 0x03:
+		x = i960_fpr_get (o->fp + i);
+		*fit &= o->fp[i].fmt <= prec || fpu_fits (x, prec);
+		return x;
+	case 0x10:
+		return 0.0L;
+	case 0x16:
+		return 1.0L;
+	}
+
+	*ok = 0;
+	return 0;
+}
+
+static int fpu_dst_ok (uint32_t op)
+{
+	return !FPU_M3 (op) || u32_extract (op, 19, 5) < 4;
+}
+
+/*
+ * Result rounded to instruction precision, value and register words
+ */
+struct fpu_res {
+	long double x;
+	uint32_t w[3];
+};
+
+static void fpu_round (struct fpu_res *r, int prec)
+{
+	float s;
+	double d;
+	uint64_t b;
+
+	switch (prec) {
+	case FPU_S:
+		s = r->x;
+		fpu_barrier (s);
+		r->x = s;
+		r->w[0] = f32_bits (s);
+		break;
+	case FPU_D:
+		d = r->x;
+		fpu_barrier (d);
+		r->x = d;
+		b = f64_bits (d);
+		r->w[0] = b;
+		r->w[1] = b >> 32;
+		break;
+	default:
+		f80_bits (r->x, r->w);
+	}
+}
+
+static void fpu_put (struct i960 *o, uint32_t op, int prec,
+		     const struct fpu_res *r)
+{
+	const size_t c = u32_extract (op, 19, 5);
+
+	if (FPU_M3 (op)) {
+		switch (prec) {
+		case FPU_S:  i960_fpr_set_s (o->fp + c, r->x);  break;
+		case FPU_D:  i960_fpr_set_d (o->fp + c, r->x);  break;
+		default:     i960_fpr_set_e (o->fp + c, r->x);
+		}
+
+		return;
+	}
+
+	switch (prec) {
+	case FPU_E:  o->r[c | 2] = r->w[2];	/* fall through */
+	case FPU_D:  o->r[c | 1] = r->w[1];	/* fall through */
+	default:     o->r[c | 0] = r->w[0];
+	}
+}
+
+/*
+ * Exceptions: host rounding mode follows AC between enter and leave,
+ * host flags raised there are merged into AC or raised as fault. Host
+ * flags are not preserved, rounding mode is restored to nearest.
+ */
+static void fpu_enter (const struct i960 *o, int *mode)
+{
+	static const int host[4] = {
+		FE_TONEAREST, FE_DOWNWARD, FE_UPWARD, FE_TOWARDZERO,
+	};
+
+	*mode = u32_extract (o->ac, I960_RND_POS, 2);
+	feclearexcept (FE_ALL_EXCEPT);
+
+	if (*mode != 0)
+		fesetround (host[*mode]);
+}
+
+static unsigned fpu_leave (int *mode)
+{
+	const int e = fetestexcept (FE_ALL_EXCEPT);
+
+	if (*mode != 0)
+		fesetround (FE_TONEAREST);
+
+	return	(e & FE_OVERFLOW  ? FPU_OVERFLOW  : 0) |
+		(e & FE_UNDERFLOW ? FPU_UNDERFLOW : 0) |
+		(e & FE_INVALID   ? FPU_INVALID   : 0) |
+		(e & FE_DIVBYZERO ? FPU_ZDIV      : 0) |
+		(e & FE_INEXACT   ? FPU_INEXACT   : 0);
+}
+
+/*
+ * Returns 1 if result should be stored: all exceptions raised are masked
+ */
+static int fpu_except (struct i960 *o, unsigned flags)
+{
+	const unsigned trap = flags & ~u32_extract (o->ac, I960_FPM_POS, 5);
+
+	if (trap == 0) {
+		o->ac |= flags << I960_FPF_POS;
+		return 1;
+	}
+
+	if      (trap & FPU_INVALID)	i960_raise (o, 0x40004);
+	else if (trap & FPU_ZDIV)	i960_raise (o, 0x40008);
+	else if (trap & FPU_OVERFLOW)	i960_raise (o, 0x40001);
+	else if (trap & FPU_UNDERFLOW)	i960_raise (o, 0x40002);
+	else				i960_raise (o, 0x40010);
+
+	return 0;
+}
+
+static void fpu_result (struct i960 *o, uint32_t op, int prec,
+			long double x)
+{
+	struct fpu_res r = { .x = x };
+	int mode;
+
+	fpu_enter (o, &mode);
+	fpu_round (&r, prec);
+
+	if (fpu_except (o, fpu_leave (&mode)))
+		fpu_put (o, op, prec, &r);
+}
+
+/*
+ * Arithmetic kernels, binary operations compute src2 op src1
+ */
+#define FPU_KERNEL(name, T, sfx)					\
+static inline T name (int fn, T x, T y)					\
+{									\
+	switch (fn) {							\
+	case FPU_ADD:	return y + x;					\
+	case FPU_SUB:	return y - x;					\
+	case FPU_MUL:	return y * x;					\
+	case FPU_DIV:	return y / x;					\
+	case FPU_REM:	return fmod##sfx (y, x);			\
+	case FPU_SQRT:	return sqrt##sfx (x);				\
+	case FPU_LOGB:	return logb##sfx (x);				\
+	default:	return rint##sfx (x);				\
+	}								\
+}
+
+FPU_KERNEL (fpu_kernel_s, float,       f)
+FPU_KERNEL (fpu_kernel_d, double,       )
+FPU_KERNEL (fpu_kernel_e, long double, l)
+
+/*
+ * Fast path operands: normal number in register (value a passed by step
+ * for real) or in fp0-fp3 held in instruction format or narrower
+ */
+static inline int fpu_fast_src_s (const struct i960 *o, uint32_t op, int slot,
+				  uint32_t a, float *x)
+{
+	const uint32_t i = slot ? u32_extract (op, 14, 5) : op & 31;
+
+	if (!(slot ? FPU_M2 (op) : FPU_M1 (op)))
+		*x = f32_from (a);
+	else if (i >= 4 || !i960_fpr_get_s (o->fp + i, x))
+		return 0;
+
+	return f32_normal (f32_bits (*x));
+}
+
+static inline int fpu_fast_src_d (const struct i960 *o, uint32_t op, int slot,
+				  double *x)
+{
+	const uint32_t i = slot ? u32_extract (op, 14, 5) : op & 31;
+
+	if (!(slot ? FPU_M2 (op) : FPU_M1 (op)))
+		*x = f64_from (o->r[i | 0], o->r[i | 1]);
+	else if (i >= 4 || !i960_fpr_get_d (o->fp + i, x))
+		return 0;
+
+	return f64_normal (f64_bits (*x));
+}
+
+static inline int fpu_fast_s (struct i960 *o, uint32_t op, int fn,
+			      uint32_t a, uint32_t b)
+{
+	const size_t c = u32_extract (op, 19, 5);
+	float x, y = 0, r;
+
+	if ((FPU_M3 (op) && c >= 4) || !fpu_fast_src_s (o, op, 0, a, &x) ||
+	    (fn < FPU_SQRT && !fpu_fast_src_s (o, op, 1, b, &y)))
+		return 0;
+
+	r = fpu_kernel_s (fn, x, y);
+
+	if (!f32_normal (f32_bits (r)))
+		return 0;
+
+	if (FPU_M3 (op))
+		i960_fpr_set_s (o->fp + c, r);
+	else
+		o->r[c] = f32_bits (r);
+
+	return 1;
+}
+
+static inline int fpu_fast_d (struct i960 *o, uint32_t op, int fn)
+{
+	const size_t c = u32_extract (op, 19, 5);
+	double x, y = 0, r;
+
+	if ((FPU_M3 (op) && c >= 4) || !fpu_fast_src_d (o, op, 0, &x) ||
+	    (fn < FPU_SQRT && !fpu_fast_src_d (o, op, 1, &y)))
+		return 0;
+
+	r = fpu_kernel_d (fn, x, y);
+
+	if (!f64_normal (f64_bits (r)))
+		return 0;
+
+	if (FPU_M3 (op))
+		i960_fpr_set_d (o->fp + c, r);
+	else {
+		o->r[c | 0] = f64_bits (r);
+		o->r[c | 1] = f64_bits (r) >> 32;
+	}
+
+	return 1;
+}
+
+static void fpu_arith (struct i960 *o, uint32_t op, int fn, int prec)
+{
+	const int unary = fn >= FPU_SQRT;
+	int ok = 1, fit = 1;
+	long double x, y;
+	struct fpu_res r;
+	int mode;
+
+	x = fpu_src (o, op, 0, prec, &ok, &fit);
+	y = unary ? 0 : fpu_src (o, op, 1, prec, &ok, &fit);
+
+	if (!ok || !fpu_dst_ok (op)) {
+		i960_on_undef (o);
+		return;
+	}
+
+	fpu_enter (o, &mode);
+	fpu_barrier (x);
+	fpu_barrier (y);
+
+	if (fit && prec == FPU_S)
+		r.x = fpu_kernel_s (fn, x, y);
+	else if (fit && prec == FPU_D)
+		r.x = fpu_kernel_d (fn, x, y);
+	else
+		r.x = fpu_kernel_e (fn, x, y);
+
+	fpu_round (&r, prec);
+
+	if (fpu_except (o, fpu_leave (&mode)))
+		fpu_put (o, op, prec, &r);
+}
+
+/*
+ * Basic arithmetic: host float or double when fpu_fast holds and operands
+ * and result are normal, full path otherwise
+ */
+static inline void fpu_basic (struct i960 *o, uint32_t op, int fn, int prec,
+			      uint32_t a, uint32_t b)
+{
+	if (fpu_fast (o) &&
+	    (prec ? fpu_fast_d (o, op, fn) : fpu_fast_s (o, op, fn, a, b)))
+		return;
+
+	fpu_arith (o, op, fn, prec);
+}
+
+static void fpu_scale (struct i960 *o, uint32_t op, int32_t n, int prec)
+{
+	int ok = 1, fit = 1;
+	long double y = fpu_src (o, op, 1, prec, &ok, &fit);
+	struct fpu_res r;
+	int mode;
+
+	if (!ok || !fpu_dst_ok (op)) {
+		i960_on_undef (o);
+		return;
+	}
+
+	fpu_enter (o, &mode);
+	fpu_barrier (y);
+	r.x = scalbnl (y, n);
+	fpu_round (&r, prec);
+
+	if (fpu_except (o, fpu_leave (&mode)))
+		fpu_put (o, op, prec, &r);
+}
+
+/*
+ * Functions: double precision kernel if operands fit instruction format,
+ * host long double otherwise and for arguments out of kernel domain.
+ * Kernel runs before rounding mode is set, result is within one ulp of
+ * double; logarithms are scaled by src2 in instruction rounding mode.
+ */
+#define FPU_LN2	0.693147180559945309417232121458176568L
+
+static long double fpu_func_e (int fn, long double x, long double y)
+{
+	switch (fn) {
+	case I960_FN_ATAN:	return atan2l (y, x);
+	case I960_FN_LOGEP:	return y * (log1pl (x) / FPU_LN2);
+	case I960_FN_LOG:	return y * log2l (x);
+	case I960_FN_EXP:	return fabsl (x) < 1 ? expm1l (x * FPU_LN2) :
+						       exp2l (x) - 1;
+	case I960_FN_SIN:	return sinl (x);
+	case I960_FN_COS:	return cosl (x);
+	}
+
+	return tanl (x);
+}
+
+static void fpu_func (struct i960 *o, uint32_t op, int fn, int prec)
+{
+	const int binary = fn == I960_FN_ATAN || fn == I960_FN_LOGEP ||
+			   fn == I960_FN_LOG;
+	const int scale  = binary && fn != I960_FN_ATAN;
+	int ok = 1, fit = 1;
+	long double x, y;
+	double yd, r;
+	int s = I960_FN_OUT;
+	struct fpu_res res;
+	int mode;
+
+	x = fpu_src (o, op, 0, prec, &ok, &fit);
+	y = binary ? fpu_src (o, op, 1, prec, &ok, &fit) : 0;
+
+	if (!ok || !fpu_dst_ok (op)) {
+		i960_on_undef (o);
+		return;
+	}
+
+	if (fit) {
+		yd = y;
+		s  = i960_fpu_fn (fn, x, yd, &r);
+	}
+
+	if (s != I960_FN_OUT && fpu_fast (o)) {
+		res.x = scale ? yd * r : r;
+		fpu_round (&res, prec);
+
+		if (prec == FPU_S ? f32_normal (res.w[0]) :
+				    f64_normal (f64_bits (res.x))) {
+			fpu_put (o, op, prec, &res);
+			return;
+		}
+	}
+
+	fpu_enter (o, &mode);
+	fpu_barrier (x);
+	fpu_barrier (y);
+
+	if (s == I960_FN_OUT)
+		res.x = fpu_func_e (fn, x, y);
+	else {
+		if (s == I960_FN_INEXACT)
+			feraiseexcept (FE_INEXACT);
+
+		fpu_barrier (r);
+		res.x = scale ? yd * r : r;
+	}
+
+	fpu_round (&res, prec);
+
+	if (fpu_except (o, fpu_leave (&mode)))
+		fpu_put (o, op, prec, &res);
+}
+
+/*
+ * Compare and Classify
+ */
+static int fpu_class (const struct i960 *o, uint32_t op, int slot, int prec,
+		      int *sign)
+{
+	const uint32_t i = slot ? u32_extract (op, 14, 5) : op & 31;
+	uint32_t w[3];
+	uint64_t m;
+	int e;
+
+	if (slot ? FPU_M2 (op) : FPU_M1 (op)) {
+		if (i >= 4) {
+			*sign = 0;
+			return i == 0x16 ? 2 : 0;	/* normal +1.0, +0.0 */
+		}
+
+		f80_bits (i960_fpr_get (o->fp + i), w);	/* as extended */
+		prec = FPU_E;
+	}
+	else {
+		w[0] = o->r[i | 0];
+		w[1] = o->r[i | 1];
+		w[2] = o->r[i | 2];
+	}
+
+	switch (prec) {
+	case FPU_S:
+		*sign = w[0] >> 31;
+		e = (w[0] >> 23) & 0xff;
+		m = w[0] & 0x7fffff;
+
+		if (e == 0)	return m == 0 ? 0 : 1;
+		if (e == 0xff)	return m == 0 ? 3 : (m >> 22) ? 4 : 5;
+		return 2;
+	case FPU_D:
+		*sign = w[1] >> 31;
+		e = (w[1] >> 20) & 0x7ff;
+		m = (uint64_t) (w[1] & 0xfffff) << 32 | w[0];
+
+		if (e == 0)	return m == 0 ? 0 : 1;
+		if (e == 0x7ff)	return m == 0 ? 3 : (m >> 51) ? 4 : 5;
+		return 2;
+	}
+
+	*sign = (w[2] >> 15) & 1;
+	e = w[2] & 0x7fff;
+	m = (uint64_t) w[1] << 32 | w[0];
+
+	if (e == 0)		return m == 0 ? 0 : 1;
+	if ((m >> 63) == 0)	return 6;		/* unnormal, pseudo-NaN */
+	if (e == 0x7fff)	return (m << 1) == 0 ? 3 : (m >> 62) & 1 ? 4 : 5;
+	return 2;
+}
+
+/*
+ * Arithmetic status: AC[6] is sign, AC[5:3] is class: 0 -- zero,
+ * 1 -- denormal, 2 -- normal, 3 -- infinity, 4 -- quiet NaN, 5 --
+ * signaling NaN, 6 -- reserved encoding
+ */
+static void fpu_classr (struct i960 *o, uint32_t op, int prec)
+{
+	int sign, cls;
+
+	if (FPU_M1 (op) && (op & 31) >= 4 && (op & 31) != 0x10 &&
+	    (op & 31) != 0x16) {
+		i960_on_undef (o);
+		return;
+	}
+
+	cls = fpu_class (o, op, 0, prec, &sign);
+	o->ac = (o->ac & ~(0xfu << I960_AS_POS)) |
+		(sign << 3 | cls) << I960_AS_POS;
+}
+
+/*
+ * Condition code: 100 -- src1 < src2, 010 -- equal, 001 -- src1 > src2,
+ * 000 -- unordered; invalid operation for unordered if cmpor or if any
+ * operand is signaling NaN
+ */
+static void fpu_cmpr (struct i960 *o, uint32_t op, int prec, int ordered)
+{
+	int ok = 1, fit = 1, s;
+	const long double x = fpu_src (o, op, 0, prec, &ok, &fit);
+	const long double y = fpu_src (o, op, 1, prec, &ok, &fit);
+
+	if (!ok) {
+		i960_on_undef (o);
+		return;
+	}
+
+	if (isless (x, y))		i960_set_cond (o, 4);
+	else if (isgreater (x, y))	i960_set_cond (o, 1);
+	else if (x == y)		i960_set_cond (o, 2);
+	else {
+		if ((ordered || fpu_class (o, op, 0, prec, &s) == 5 ||
+				fpu_class (o, op, 1, prec, &s) == 5) &&
+		    !fpu_except (o, FPU_INVALID))
+			return;
+
+		i960_set_cond (o, 0);
+	}
+}
+
+/*
+ * Conversions and Moves
+ */
+static void fpu_cvtir (struct i960 *o, uint32_t op, uint32_t a, int wide)
+{
+	const size_t i = op & 31;
+	const uint32_t lo = FPU_M1 (op) ? a : o->r[i | 0];
+	const uint32_t hi = FPU_M1 (op) ? 0 : o->r[i | 1];
+	const int prec = FPU_M3 (op) ? FPU_E : wide ? FPU_D : FPU_S;
+	long double x;
+
+	if (!fpu_dst_ok (op)) {
+		i960_on_undef (o);
+		return;
+	}
+
+	x = wide ? (int64_t) ((uint64_t) hi << 32 | lo) : (int32_t) a;
+	fpu_result (o, op, prec, x);
+}
+
+static void fpu_cvtri (struct i960 *o, uint32_t op, int wide, int trunc)
+{
+	const size_t c = u32_extract (op, 19, 5);
+	int ok = 1, fit = 1;
+	long double x = fpu_src (o, op, 0, wide ? FPU_D : FPU_S, &ok, &fit);
+	long long r;
+	int mode;
+
+	if (!ok || FPU_M3 (op)) {
+		i960_on_undef (o);
+		return;
+	}
+
+	fpu_enter (o, &mode);
+	fpu_barrier (x);
+
+	r = llrintl (trunc ? truncl (x) : x);
+
+	if (trunc && truncl (x) != x)
+		feraiseexcept (FE_INEXACT);
+
+	if (!wide && (r < INT32_MIN || r > INT32_MAX)) {
+		feraiseexcept (FE_INVALID);
+		r = INT32_MIN;
+	}
+
+	if (!fpu_except (o, fpu_leave (&mode)))
+		return;
+
+	o->r[c | 0] = r;
+
+	if (wide)
+		o->r[c | 1] = (unsigned long long) r >> 32;
+}
+
+/*
+ * Move without rounding: value of instruction format or narrower goes to
+ * fp0-fp3 as is and to registers widened exactly. NaNs and constants
+ * take general path for signaling NaN handling.
+ */
+static int fpu_move_fast (struct i960 *o, uint32_t op, int prec)
+{
+	const size_t i = op & 31, c = u32_extract (op, 19, 5);
+	struct i960_fpr f;
+	uint32_t w[3];
+	uint64_t b;
+
+	if (!FPU_M1 (op))
+		switch (prec) {
+		case FPU_S:
+			i960_fpr_set_s (&f, f32_from (o->r[i]));
+			break;
+		case FPU_D:
+			i960_fpr_set_d (&f, f64_from (o->r[i | 0], o->r[i | 1]));
+			break;
+		default:
+			i960_fpr_set_e (&f, f80_from (o->r[i | 0], o->r[i | 1],
+						      o->r[i | 2]));
+		}
+	else if (i < 4 && o->fp[i].fmt <= prec)
+		f = o->fp[i];
+	else
+		return 0;
+
+	if (isnan (i960_fpr_get (&f)) || (FPU_M3 (op) && c >= 4))
+		return 0;
+
+	if (FPU_M3 (op)) {
+		o->fp[c] = f;
+		return 1;
+	}
+
+	switch (prec) {
+	case FPU_S:
+		o->r[c] = f32_bits (f.v.s);
+		break;
+	case FPU_D:
+		b = f64_bits (f.fmt == I960_FPR_S ? f.v.s : f.v.d);
+		o->r[c | 0] = b;
+		o->r[c | 1] = b >> 32;
+		break;
+	default:
+		f80_bits (i960_fpr_get (&f), w);
+		o->r[c | 0] = w[0];
+		o->r[c | 1] = w[1];
+		o->r[c | 2] = w[2];
+	}
+
+	return 1;
+}
+
+static void fpu_move (struct i960 *o, uint32_t op, int prec)
+{
+	const size_t i = op & 31, c = u32_extract (op, 19, 5);
+	int ok = 1, fit = 1;
+	long double x;
+
+	if ((op & 0x2800) == 0) {		/* register to register */
+		switch (prec) {
+		case FPU_E:  o->r[c | 2] = o->r[i | 2];	/* fall through */
+		case FPU_D:  o->r[c | 1] = o->r[i | 1];	/* fall through */
+		default:     o->r[c | 0] = o->r[i | 0];
+		}
+
+		return;
+	}
+
+	if (fpu_move_fast (o, op, prec))
+		return;
+
+	x = fpu_src (o, op, 0, prec, &ok, &fit);
+
+	if (!ok || !fpu_dst_ok (op))
+		i960_on_undef (o);
+	else
+		fpu_result (o, op, prec, x);
+}
+
+static void fpu_cpysre (struct i960 *o, uint32_t op, int reverse)
+{
+	int ok = 1, fit = 1;
+	const long double x = fpu_src (o, op, 0, FPU_E, &ok, &fit);
+	const long double y = fpu_src (o, op, 1, FPU_E, &ok, &fit);
+
+	if (!ok || !fpu_dst_ok (op))
+		i960_on_undef (o);
+	else
+		fpu_result (o, op, FPU_E,
+			    copysignl (x, (signbit (y) != 0) ^ reverse ? -1 : 1));
+}
+
+/*
+ * Entry point for ops 674..677, 680..69F, 6C0..6EF, 78B..79F
+ */
+void i960_fpu (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
+{
+	const uint32_t code = (op >> 20 & 0xff0) | (op >> 7 & 15);
+	const int prec = (code >> 4) & 1;	/* long real forms */
+
+	switch (code) {
+	case 0x78F:  case 0x79F:  fpu_basic (o, op, FPU_ADD,  prec, a, b);  return;
+	case 0x78D:  case 0x79D:  fpu_basic (o, op, FPU_SUB,  prec, a, b);  return;
+	case 0x78C:  case 0x79C:  fpu_basic (o, op, FPU_MUL,  prec, a, b);  return;
+	case 0x78B:  case 0x79B:  fpu_basic (o, op, FPU_DIV,  prec, a, b);  return;
+	case 0x688:  case 0x698:  fpu_basic (o, op, FPU_SQRT, prec, a, b);  return;
+
+	case 0x680:  case 0x690:  fpu_func (o, op, I960_FN_ATAN,  prec);  return;
+	case 0x681:  case 0x691:  fpu_func (o, op, I960_FN_LOGEP, prec);  return;
+	case 0x682:  case 0x692:  fpu_func (o, op, I960_FN_LOG,   prec);  return;
+	case 0x689:  case 0x699:  fpu_func (o, op, I960_FN_EXP,   prec);  return;
+	case 0x68C:  case 0x69C:  fpu_func (o, op, I960_FN_SIN,   prec);  return;
+	case 0x68D:  case 0x69D:  fpu_func (o, op, I960_FN_COS,   prec);  return;
+	case 0x68E:  case 0x69E:  fpu_func (o, op, I960_FN_TAN,   prec);  return;
+
+	case 0x683:  case 0x693:  fpu_arith (o, op, FPU_REM,   prec);  return;
+	case 0x68A:  case 0x69A:  fpu_arith (o, op, FPU_LOGB,  prec);  return;
+	case 0x68B:  case 0x69B:  fpu_arith (o, op, FPU_ROUND, prec);  return;
+
+	case 0x684:  case 0x694:  fpu_cmpr   (o, op, prec, 1);  return;
+	case 0x685:  case 0x695:  fpu_cmpr   (o, op, prec, 0);  return;
+	case 0x68F:  case 0x69F:  fpu_classr (o, op, prec);	return;
+
+	case 0x674:  fpu_cvtir (o, op, a, 0);		return;
+	case 0x675:  fpu_cvtir (o, op, a, 1);		return;
+	case 0x676:  fpu_scale (o, op, a, FPU_D);	return;
+	case 0x677:  fpu_scale (o, op, a, FPU_S);	return;
+
+	case 0x6C0:  fpu_cvtri (o, op, 0, 0);	return;
+	case 0x6C1:  fpu_cvtri (o, op, 1, 0);	return;
+	case 0x6C2:  fpu_cvtri (o, op, 0, 1);	return;
+	case 0x6C3:  fpu_cvtri (o, op, 1, 1);	return;
+
+	case 0x6C9:  fpu_move (o, op, FPU_S);	return;
+	case 0x6D9:  fpu_move (o, op, FPU_D);	return;
+	case 0x6E1:  fpu_move (o, op, FPU_E);	return;
+	case 0x6E2:  fpu_cpysre (o, op, 0);	return;
+	case 0x6E3:  fpu_cpysre (o, op, 1);	return;
+	}
+
+	i960_on_undef (o);
+}
@@ -0,0 +1,303 @@
+/*
+ * 80960 Emulator Memory Heat Map
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <i960-heat.h>
+
+int i960_heat_init (struct i960_heat *o, unsigned period)
+{
+	memset (o, 0, sizeof (*o));
+
+	o->period = period == 0 ? 1 : period;
+	return 1;
+}
+
+void i960_heat_fini (struct i960_heat *o)
+{
+	size_t i;
+
+	for (i = 0; i < o->count; ++i)
+		free (o->regions[i].name);
+
+	free (o->regions);
+	free (o->pages);
+	o->regions = NULL;
+	o->pages   = NULL;
+}
+
+int i960_heat_region (struct i960_heat *o, uint32_t base, uint32_t size,
+		      const char *name)
+{
+	const size_t n = o->avail == 0 ? 16 : o->avail * 2;
+	struct i960_region *v;
+	size_t i;
+
+	if (size == 0) {
+		errno = EINVAL;
+		return 0;
+	}
+
+	if (o->count == o->avail) {
+		if ((v = realloc (o->regions, n * sizeof (v[0]))) == NULL)
+			return 0;
+
+		o->regions = v;
+		o->avail   = n;
+	}
+
+	for (i = o->count; i > 0 && o->regions[i - 1].base > base; --i)
+		o->regions[i] = o->regions[i - 1];
+
+	v = o->regions + i;
+	memset (v, 0, sizeof (*v));
+	v->base = base;
+	v->size = size;
+
+	if ((v->name = strdup (name)) == NULL) {
+		memmove (v, v + 1, (o->count - i) * sizeof (v[0]));
+		return 0;
+	}
+
+	++o->count;
+	return 1;
+}
+
+static struct i960_region *region_find (struct i960_heat *o, uint32_t addr)
+{
+	size_t lo = 0, hi = o->count, i;
+
+	while (lo < hi) {
+		i = lo + (hi - lo) / 2;
+
+		if (addr < o->regions[i].base)
+			hi = i;
+		else if (addr - o->regions[i].base >= o->regions[i].size)
+			lo = i + 1;
+		else
+			return o->regions + i;
+	}
+
+	return NULL;
+}
+
+static size_t page_hash (uint32_t page, size_t mask)
+{
+	return (page * 0x9e3779b1u) & mask;
+}
+
+static struct i960_heat_page *
+page_slot (struct i960_heat_page *v, size_t size, uint32_t page)
+{
+	const size_t mask = size - 1;
+	size_t i;
+
+	for (i = page_hash (page, mask); v[i].page != 0; i = (i + 1) & mask)
+		if (v[i].page == page)
+			break;
+
+	return v + i;
+}
+
+/*
+ * Pages are stored biased by one: zero marks free slot
+ */
+static int page_grow (struct i960_heat *o)
+{
+	const size_t n = o->size == 0 ? 1024 : o->size * 2;
+	struct i960_heat_page *v;
+	size_t i;
+
+	if ((v = calloc (n, sizeof (v[0]))) == NULL)
+		return 0;
+
+	for (i = 0; i < o->size; ++i)
+		if (o->pages[i].page != 0)
+			*page_slot (v, n, o->pages[i].page) = o->pages[i];
+
+	free (o->pages);
+	o->pages = v;
+	o->size  = n;
+	o->last  = NULL;
+	return 1;
+}
+
+static struct i960_heat_page *page_get (struct i960_heat *o, uint32_t addr)
+{
+	const uint32_t page = (addr >> I960_HEAT_SHIFT) + 1;
+	struct i960_heat_page *p;
+
+	if (o->last != NULL && o->last->page == page)
+		return o->last;
+
+	if (o->used * 2 >= o->size && !page_grow (o))
+		return NULL;
+
+	if ((p = page_slot (o->pages, o->size, page))->page == 0) {
+		p->page = page;
+		++o->used;
+	}
+
+	return o->last = p;
+}
+
+void i960_heat_feed (void *ctx, const struct i960_access *v, size_t count)
+{
+	struct i960_heat *o = ctx;
+	struct i960_heat_page *p;
+	struct i960_region *r;
+	size_t i;
+
+	for (i = 0; i < count; ++i) {
+		if (v[i].kind > I960_ACC_STORE)
+			continue;
+
+		if ((p = page_get (o, v[i].addr)) != NULL)
+			++p->n[v[i].kind];
+
+		if ((r = region_find (o, v[i].addr)) != NULL)
+			++r->n[v[i].kind];
+	}
+}
+
+void i960_heat_alog (struct i960_heat *o, struct i960_alog *a,
+		     struct i960_access *v, size_t size)
+{
+	memset (a, 0, sizeof (*a));
+	a->v      = v;
+	a->size   = size;
+	a->period = o->period;
+	a->flush  = i960_heat_feed;
+	a->ctx    = o;
+}
+
+/*
+ * Report
+ */
+static int page_by_addr (const void *a, const void *b)
+{
+	const struct i960_heat_page *x = *(const struct i960_heat_page **) a;
+	const struct i960_heat_page *y = *(const struct i960_heat_page **) b;
+
+	return x->page < y->page ? -1 : x->page > y->page;
+}
+
+static uint64_t page_total (const struct i960_heat_page *p)
+{
+	return p->n[0] + p->n[1] + p->n[2];
+}
+
+/*
+ * Cell shade: logarithmic scale relative to the hottest page, one step
+ * per factor of four
+ */
+static char heat_cell (uint64_t x, uint64_t max)
+{
+	static const char shade[] = ".:-=+*#%@";
+	int i;
+
+	if (x == 0)
+		return ' ';
+
+	for (i = 8; i > 0 && (x << 2) <= max; --i)
+		x <<= 2;
+
+	return shade[i];
+}
+
+static void heat_map (FILE *to, const struct i960_heat_page **v, size_t n)
+{
+	uint64_t max = 0;
+	uint32_t row, col;
+	size_t i, j;
+
+	for (i = 0; i < n; ++i)
+		if (page_total (v[i]) > max)
+			max = page_total (v[i]);
+
+	fprintf (to, "# %-8s  %-16s  scale: \" .:-=+*#%%@\", @ = %llu\n",
+		 "base", "4 KiB pages", (unsigned long long) max);
+
+	for (i = 0; i < n; i = j) {
+		row = (v[i]->page - 1) >> 4;
+		fprintf (to, "%08x  ", row << (I960_HEAT_SHIFT + 4));
+
+		for (col = 0, j = i; col < 16; ++col)
+			if (j < n && v[j]->page - 1 == (row << 4 | col))
+				fputc (heat_cell (page_total (v[j++]), max), to);
+			else
+				fputc (' ', to);
+
+		fputc ('\n', to);
+	}
+}
+
+static void heat_csv (FILE *to, const struct i960_heat_page **v, size_t n,
+		      unsigned period)
+{
+	size_t i;
+
+	fprintf (to, "page,fetches,loads,stores\n");
+
+	for (i = 0; i < n; ++i)
+		fprintf (to, "0x%08x,%llu,%llu,%llu\n",
+			 (v[i]->page - 1) << I960_HEAT_SHIFT,
+			 (unsigned long long) v[i]->n[0] * period,
+			 (unsigned long long) v[i]->n[1] * period,
+			 (unsigned long long) v[i]->n[2] * period);
+}
+
+static void heat_regions (FILE *to, const struct i960_heat *o)
+{
+	const struct i960_region *r;
+	size_t i;
+
+	if (o->count == 0)
+		return;
+
+	fprintf (to, "\n# %-8s %10s %14s %14s %14s  %s\n", "base", "size",
+		 "fetches", "loads", "stores", "region");
+
+	for (i = 0; i < o->count; ++i) {
+		r = o->regions + i;
+
+		fprintf (to, "%08x %10u %14llu %14llu %14llu  %s\n",
+			 r->base, r->size,
+			 (unsigned long long) r->n[0] * o->period,
+			 (unsigned long long) r->n[1] * o->period,
+			 (unsigned long long) r->n[2] * o->period, r->name);
+	}
+}
+
+void i960_heat_report (FILE *to, const struct i960_heat *o, int format)
+{
+	const struct i960_heat_page **v;
+	size_t i, n;
+
+	if ((v = malloc ((o->used + 1) * sizeof (v[0]))) == NULL)
+		return;
+
+	for (i = 0, n = 0; i < o->size; ++i)
+		if (o->pages[i].page != 0)
+			v[n++] = o->pages + i;
+
+	qsort (v, n, sizeof (v[0]), page_by_addr);
+
+	if (format == I960_HEAT_CSV) {
+		heat_csv (to, v, n, o->period);
+	}
+	else {
+		fprintf (to, "# sampled 1/%u accesses\n", o->period);
+		heat_map (to, v, n);
+		heat_regions (to, o);
+	}
+
+	free (v);
+}
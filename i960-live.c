@@ -0,0 +1,162 @@
+/*
+ * 80960 Emulator Live Statistics Page
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <i960-live.h>
+
+static const char live_magic[8] = "I960LIV\1";
+
+static int live_name (struct i960_live *o, const char *name)
+{
+	int len;
+
+	if (name == NULL)
+		len = snprintf (o->name, sizeof (o->name), "/i960-%ld",
+				(long) getpid ());
+	else
+		len = snprintf (o->name, sizeof (o->name), "%s%s",
+				name[0] == '/' ? "" : "/", name);
+
+	if (len < 0 || (size_t) len >= sizeof (o->name)) {
+		errno = ENAMETOOLONG;
+		return 0;
+	}
+
+	return 1;
+}
+
+int i960_live_open (struct i960_live *o, const char *name, unsigned slots)
+{
+	struct timespec ts;
+	void *p;
+	int fd;
+
+	memset (o, 0, sizeof (*o));
+
+	if (slots == 0) {
+		errno = EINVAL;
+		return 0;
+	}
+
+	if (!live_name (o, name))
+		return 0;
+
+	o->size = sizeof (*o->page) + slots * sizeof (o->page->slot[0]);
+
+	if ((fd = shm_open (o->name, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0)
+		return 0;
+
+	if (ftruncate (fd, o->size) != 0)
+		goto no_size;
+
+	p = mmap (NULL, o->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if (p == MAP_FAILED)
+		goto no_size;
+
+	close (fd);
+
+	o->page  = p;
+	o->owner = 1;
+
+	clock_gettime (CLOCK_REALTIME, &ts);
+
+	o->page->nslots = slots;
+	o->page->pid    = getpid ();
+	o->page->start  = ts.tv_sec * 1000000000ull + ts.tv_nsec;
+
+	__atomic_thread_fence (__ATOMIC_RELEASE);
+	memcpy (o->page->magic, live_magic, sizeof (live_magic));
+	return 1;
+no_size:
+	close (fd);
+	shm_unlink (o->name);
+	return 0;
+}
+
+void i960_live_close (struct i960_live *o)
+{
+	if (o->page != NULL)
+		munmap (o->page, o->size);
+
+	if (o->owner)
+		shm_unlink (o->name);
+
+	o->page = NULL;
+}
+
+int i960_live_map (struct i960_live *o, const char *name)
+{
+	struct stat st;
+	void *p;
+	int fd;
+
+	memset (o, 0, sizeof (*o));
+
+	if (!live_name (o, name))
+		return 0;
+
+	if ((fd = shm_open (o->name, O_RDONLY, 0)) < 0)
+		return 0;
+
+	if (fstat (fd, &st) != 0)
+		goto no_map;
+
+	if ((size_t) st.st_size < sizeof (*o->page)) {
+		errno = EILSEQ;
+		goto no_map;
+	}
+
+	o->size = st.st_size;
+	p = mmap (NULL, o->size, PROT_READ, MAP_SHARED, fd, 0);
+
+	if (p == MAP_FAILED)
+		goto no_map;
+
+	close (fd);
+	o->page = p;
+
+	if (memcmp (o->page->magic, live_magic, sizeof (live_magic)) != 0 ||
+	    o->size < sizeof (*o->page) +
+		      o->page->nslots * sizeof (o->page->slot[0])) {
+		i960_live_close (o);
+		errno = EILSEQ;
+		return 0;
+	}
+
+	return 1;
+no_map:
+	close (fd);
+	return 0;
+}
+
+struct i960_live_slot *i960_live_slot (struct i960_live *o)
+{
+	struct i960_live_slot *s;
+	uint32_t i;
+
+	i = __atomic_fetch_add (&o->page->used, 1, __ATOMIC_RELAXED);
+
+	if (i >= o->page->nslots) {
+		__atomic_fetch_sub (&o->page->used, 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+
+	s = o->page->slot + i;
+	__atomic_store_n (&s->tid, syscall (SYS_gettid), __ATOMIC_RELAXED);
+	return s;
+}
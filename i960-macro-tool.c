@@ -0,0 +1,988 @@
+/*
+ * 80960 Emulator Macro-benchmarks: Guest Kernels
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <i960-emu-acct.h>
+#include <i960-emu-bstat.h>
+#include <i960-emu-ops.h>
+#include <i960-emu-stat.h>
+#include <i960-pmu.h>
+#include <i960-results.h>
+#include <i960-sample.h>
+
+#include "i960-host.h"
+
+/*
+ * Guest memory map: image is entered at LOAD with call to main followed
+ * by halt loop (b .) at LOAD + 4, data buffers above, stack grows up
+ */
+#define LOAD		0x01000
+#define HALT		(LOAD + 4)
+#define SRC		0x20000
+#define DST		0x40000
+#define STACK		0x80000
+
+/*
+ * Tiny assembler: operands are given in i960 assembler order, literals
+ * are marked with LIT, forward references resolved by fixups
+ */
+#define R(n)		(n)
+#define G(n)		(16 + (n))
+#define LIT		0x100
+
+#define MAX_WORDS	1024
+#define MAX_LABELS	32
+#define MAX_FIXUPS	128
+
+enum fix_kind { FIX_CTRL, FIX_COBR, FIX_WORD };
+
+struct as {
+	uint32_t v[MAX_WORDS];
+	size_t n;
+	uint32_t label[MAX_LABELS];
+	struct fixup { size_t at; int kind, label; } fix[MAX_FIXUPS];
+	size_t nfix;
+};
+
+static void emit (struct as *a, uint32_t w)
+{
+	a->v[a->n++] = w;
+}
+
+static uint32_t here (struct as *a)
+{
+	return LOAD + 4 * a->n;
+}
+
+static void label (struct as *a, int l)
+{
+	a->label[l] = here (a);
+}
+
+static void fixup (struct as *a, int kind, int l)
+{
+	a->fix[a->nfix++] = (struct fixup) { a->n, kind, l };
+}
+
+static void ctrl (struct as *a, uint32_t opc, int l)
+{
+	fixup (a, FIX_CTRL, l);
+	emit (a, opc << 24);
+}
+
+static void cobr (struct as *a, uint32_t opc, uint32_t s1, uint32_t s2, int l)
+{
+	fixup (a, FIX_COBR, l);
+	emit (a, opc << 24 | (s1 & 31) << 19 | (s2 & 31) << 14 |
+		 (s1 & LIT ? 1 << 13 : 0));
+}
+
+static void reg (struct as *a, uint32_t opc, uint32_t s1, uint32_t s2,
+		 uint32_t dst)
+{
+	emit (a, (opc >> 4) << 24 | (dst & 31) << 19 | (s2 & 31) << 14 |
+		 (s2 & LIT ? 1 << 12 : 0) | (s1 & LIT ? 1 << 11 : 0) |
+		 (opc & 15) << 7 | (s1 & 31));
+}
+
+static void ret (struct as *a)
+{
+	emit (a, 0x0A << 24);
+}
+
+static void mov (struct as *a, uint32_t src, uint32_t dst)
+{
+	reg (a, 0x5CC, src, 0, dst);
+}
+
+/* opc r, offset (abase): MEMA for short offsets, MEMB otherwise */
+static void mem_at (struct as *a, uint32_t opc, uint32_t r, uint32_t abase,
+		    uint32_t offset)
+{
+	if (offset < 4096) {
+		emit (a, opc << 24 | r << 19 | abase << 14 | 2 << 12 | offset);
+		return;
+	}
+
+	emit (a, opc << 24 | r << 19 | abase << 14 | 0xD << 10);
+	emit (a, offset);
+}
+
+/* opc r, (abase) [index * 2^scale] */
+static void mem_ix (struct as *a, uint32_t opc, uint32_t r, uint32_t abase,
+		    uint32_t index, uint32_t scale)
+{
+	emit (a, opc << 24 | r << 19 | abase << 14 | 7 << 10 | scale << 7 |
+		 index);
+}
+
+/* lda value, r */
+static void ldc (struct as *a, uint32_t value, uint32_t r)
+{
+	emit (a, 0x8C << 24 | r << 19 | 0xC << 10);
+	emit (a, value);
+}
+
+/* lda label, r */
+static void lda (struct as *a, int l, uint32_t r)
+{
+	emit (a, 0x8C << 24 | r << 19 | 0xC << 10);
+	fixup (a, FIX_WORD, l);
+	emit (a, 0);
+}
+
+/* bx (abase) */
+static void bx (struct as *a, uint32_t abase)
+{
+	emit (a, 0x84 << 24 | abase << 14 | 4 << 10);
+}
+
+static void word (struct as *a, int l)
+{
+	fixup (a, FIX_WORD, l);
+	emit (a, 0);
+}
+
+static void ascii (struct as *a, const char *s)
+{
+	const size_t len = strlen (s) + 1;
+	size_t i;
+	uint32_t w;
+
+	for (i = 0; i < len; i += 4) {
+		w = 0;
+		memcpy (&w, s + i, len - i < 4 ? len - i : 4);
+		emit (a, w);
+	}
+}
+
+static void resolve (struct as *a)
+{
+	struct fixup *f;
+	uint32_t ip, to;
+	size_t i;
+
+	for (i = 0; i < a->nfix; ++i) {
+		f  = a->fix + i;
+		ip = LOAD + 4 * f->at;
+		to = a->label[f->label];
+
+		switch (f->kind) {
+		case FIX_CTRL:  a->v[f->at] |= (to - ip) & 0xfffffc;	break;
+		case FIX_COBR:  a->v[f->at] |= (to - ip) & 0x1ffc;	break;
+		case FIX_WORD:  a->v[f->at]  = to;			break;
+		}
+	}
+}
+
+/*
+ * Common code: entry stub and LCG buffer fill
+ *
+ * fill (g0 = addr, g1 = words, g2 = seed): x = x * 1664525 + 1013904223
+ */
+enum { L_HALT, L_MAIN, L_FILL, L_F1, L_F2, L_K };
+
+#define LCG_A		1664525u
+#define LCG_C		1013904223u
+
+static void start (struct as *a)
+{
+	memset (a, 0, sizeof (*a));
+
+	ctrl (a, 0x09, L_MAIN);			/* call main	*/
+	label (a, L_HALT);
+	ctrl (a, 0x08, L_HALT);			/* b .		*/
+
+	label (a, L_FILL);
+	ldc (a, LCG_A, R(4));
+	ldc (a, LCG_C, R(5));
+	label (a, L_F1);
+	cobr (a, 0x32, LIT | 0, G(1), L_F2);	/* cmpobe 0, g1, F2	*/
+	reg  (a, 0x701, R(4), G(2), G(2));	/* mulo r4, g2, g2	*/
+	reg  (a, 0x590, R(5), G(2), G(2));	/* addo r5, g2, g2	*/
+	mem_at (a, 0x92, G(2), G(0), 0);	/* st g2, (g0)		*/
+	reg  (a, 0x590, LIT | 4, G(0), G(0));
+	reg  (a, 0x592, LIT | 1, G(1), G(1));
+	ctrl (a, 0x08, L_F1);
+	label (a, L_F2);
+	ret (a);
+}
+
+static void fill_call (struct as *a, uint32_t addr, uint32_t words,
+		       uint32_t seed)
+{
+	ldc (a, addr,  G(0));
+	ldc (a, words, G(1));
+	ldc (a, seed,  G(2));
+	ctrl (a, 0x09, L_FILL);
+}
+
+static void host_fill (uint32_t *v, size_t words, uint32_t x)
+{
+	size_t i;
+
+	for (i = 0; i < words; ++i)
+		v[i] = x = x * LCG_A + LCG_C;
+}
+
+static uint32_t peek (uint32_t addr)
+{
+	return i960_read_w (NULL, addr);
+}
+
+/*
+ * CRC-32 (reflected, bitwise) of a buffer, main xors results of all
+ * repetitions
+ */
+#define CRC_BYTES	4096
+#define CRC_REPS	16
+
+enum { C_LOOP = L_K, C_BIT, C_SKIP, C_M1, C_CRC };
+
+static void build_crc (struct as *a)
+{
+	start (a);
+
+	label (a, L_MAIN);
+	fill_call (a, SRC, CRC_BYTES / 4, 1);
+	ldc (a, CRC_REPS, R(3));
+	mov (a, LIT | 0, R(6));
+	label (a, C_M1);
+	ldc (a, SRC, G(0));
+	ldc (a, CRC_BYTES, G(1));
+	ctrl (a, 0x09, C_CRC);
+	reg  (a, 0x586, G(0), R(6), R(6));	/* xor g0, r6, r6	*/
+	reg  (a, 0x592, LIT | 1, R(3), R(3));
+	cobr (a, 0x35, LIT | 0, R(3), C_M1);	/* cmpobne 0, r3, M1	*/
+	mov (a, R(6), G(0));
+	ret (a);
+
+	label (a, C_CRC);			/* g0 = buf, g1 = len	*/
+	ldc (a, 0xffffffff, R(4));
+	ldc (a, 0xedb88320, R(11));
+	mov (a, G(0), R(5));
+	reg  (a, 0x590, G(1), G(0), R(6));	/* addo g1, g0, r6	*/
+	label (a, C_LOOP);
+	mem_at (a, 0x80, R(7), R(5), 0);	/* ldob (r5), r7	*/
+	reg  (a, 0x590, LIT | 1, R(5), R(5));
+	reg  (a, 0x586, R(7), R(4), R(4));	/* xor r7, r4, r4	*/
+	mov (a, LIT | 8, R(8));
+	label (a, C_BIT);
+	reg  (a, 0x598, LIT | 1, R(4), R(9));	/* shro 1, r4, r9	*/
+	reg  (a, 0x581, LIT | 1, R(4), R(10));	/* and 1, r4, r10	*/
+	cobr (a, 0x32, LIT | 0, R(10), C_SKIP);	/* cmpobe 0, r10, SKIP	*/
+	reg  (a, 0x586, R(11), R(9), R(9));
+	label (a, C_SKIP);
+	mov (a, R(9), R(4));
+	reg  (a, 0x592, LIT | 1, R(8), R(8));
+	cobr (a, 0x35, LIT | 0, R(8), C_BIT);
+	cobr (a, 0x35, R(5), R(6), C_LOOP);	/* cmpobne r5, r6, LOOP	*/
+	reg  (a, 0x58A, R(4), 0, G(0));		/* not r4, g0		*/
+	ret (a);
+}
+
+static int check_crc (struct i960 *o)
+{
+	uint32_t v[CRC_BYTES / 4], crc, x = 0;
+	const uint8_t *p = (const void *) v;
+	int i, k, rep;
+
+	host_fill (v, CRC_BYTES / 4, 1);
+
+	for (rep = 0; rep < CRC_REPS; ++rep) {
+		for (crc = ~0u, i = 0; i < CRC_BYTES; ++i)
+			for (crc ^= p[i], k = 0; k < 8; ++k)
+				crc = crc >> 1 ^ (crc & 1 ? 0xedb88320 : 0);
+
+		x ^= ~crc;
+	}
+
+	return o->r[G(0)] == x;
+}
+
+/*
+ * Block copy with quad loads and stores
+ */
+#define COPY_BYTES	0x10000
+#define COPY_REPS	16
+
+enum { M_LOOP = L_K, M_M1, M_COPY };
+
+static void build_copy (struct as *a)
+{
+	start (a);
+
+	label (a, L_MAIN);
+	fill_call (a, SRC, COPY_BYTES / 4, 2);
+	ldc (a, COPY_REPS, R(3));
+	label (a, M_M1);
+	ldc (a, DST, G(0));
+	ldc (a, SRC, G(1));
+	ldc (a, COPY_BYTES, G(2));
+	ctrl (a, 0x09, M_COPY);
+	reg  (a, 0x592, LIT | 1, R(3), R(3));
+	cobr (a, 0x35, LIT | 0, R(3), M_M1);
+	ret (a);
+
+	label (a, M_COPY);			/* g0 = dst, g1 = src, g2 = len */
+	reg  (a, 0x590, G(2), G(1), R(4));	/* addo g2, g1, r4	*/
+	label (a, M_LOOP);
+	mem_at (a, 0xB0, R(8),  G(1), 0);	/* ldq (g1), r8		*/
+	mem_at (a, 0xB0, R(12), G(1), 16);	/* ldq 16 (g1), r12	*/
+	reg  (a, 0x590, LIT | 16, G(1), G(1));
+	reg  (a, 0x590, LIT | 16, G(1), G(1));
+	mem_at (a, 0xB2, R(8),  G(0), 0);	/* stq r8, (g0)		*/
+	mem_at (a, 0xB2, R(12), G(0), 16);	/* stq r12, 16 (g0)	*/
+	reg  (a, 0x590, LIT | 16, G(0), G(0));
+	reg  (a, 0x590, LIT | 16, G(0), G(0));
+	cobr (a, 0x34, G(1), R(4), M_LOOP);	/* cmpobl g1, r4, LOOP	*/
+	ret (a);
+}
+
+static int check_copy (struct i960 *o)
+{
+	static uint32_t v[COPY_BYTES / 4];
+	size_t i;
+
+	host_fill (v, COPY_BYTES / 4, 2);
+
+	for (i = 0; i < COPY_BYTES / 4; ++i)
+		if (peek (DST + 4 * i) != v[i])
+			return 0;
+
+	return 1;
+}
+
+/*
+ * Recursive quicksort (Lomuto partition) of unsigned words
+ */
+#define SORT_WORDS	4096
+#define SORT_REPS	4
+
+enum { Q_LOOP = L_K, Q_NEXT, Q_PART, Q_DONE, Q_M1, Q_SORT };
+
+static void build_sort (struct as *a)
+{
+	start (a);
+
+	label (a, L_MAIN);
+	ldc (a, SORT_REPS, R(3));
+	label (a, Q_M1);
+	ldc (a, SRC, G(0));
+	ldc (a, SORT_WORDS, G(1));
+	mov (a, R(3), G(2));
+	ctrl (a, 0x09, L_FILL);
+	ldc (a, SRC, G(0));
+	ldc (a, SRC + 4 * (SORT_WORDS - 1), G(1));
+	ctrl (a, 0x09, Q_SORT);
+	reg  (a, 0x592, LIT | 1, R(3), R(3));
+	cobr (a, 0x35, LIT | 0, R(3), Q_M1);
+	ret (a);
+
+	label (a, Q_SORT);			/* g0 = lo, g1 = hi	*/
+	cobr (a, 0x33, G(0), G(1), Q_DONE);	/* cmpobge g0, g1, DONE	*/
+	mov (a, G(0), R(4));
+	mov (a, G(1), R(5));
+	mem_at (a, 0x90, R(6), R(5), 0);	/* ld (r5), r6: pivot	*/
+	reg  (a, 0x592, LIT | 4, R(4), R(7));	/* subo 4, r4, r7: i	*/
+	mov (a, R(4), R(8));			/* j			*/
+	label (a, Q_LOOP);
+	cobr (a, 0x32, R(8), R(5), Q_PART);	/* cmpobe r8, r5, PART	*/
+	mem_at (a, 0x90, R(9), R(8), 0);
+	cobr (a, 0x31, R(9), R(6), Q_NEXT);	/* cmpobg r9, r6, NEXT	*/
+	reg  (a, 0x590, LIT | 4, R(7), R(7));
+	mem_at (a, 0x90, R(10), R(7), 0);
+	mem_at (a, 0x92, R(9),  R(7), 0);
+	mem_at (a, 0x92, R(10), R(8), 0);
+	label (a, Q_NEXT);
+	reg  (a, 0x590, LIT | 4, R(8), R(8));
+	ctrl (a, 0x08, Q_LOOP);
+	label (a, Q_PART);
+	reg  (a, 0x590, LIT | 4, R(7), R(7));
+	mem_at (a, 0x90, R(10), R(7), 0);
+	mem_at (a, 0x92, R(6),  R(7), 0);
+	mem_at (a, 0x92, R(10), R(5), 0);
+	mov (a, R(4), G(0));
+	reg  (a, 0x592, LIT | 4, R(7), G(1));
+	ctrl (a, 0x09, Q_SORT);
+	reg  (a, 0x590, LIT | 4, R(7), G(0));
+	mov (a, R(5), G(1));
+	ctrl (a, 0x09, Q_SORT);
+	label (a, Q_DONE);
+	ret (a);
+}
+
+static int cmp_word (const void *a, const void *b)
+{
+	const uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+
+	return x < y ? -1 : x > y;
+}
+
+static int check_sort (struct i960 *o)
+{
+	static uint32_t v[SORT_WORDS];
+	size_t i;
+
+	host_fill (v, SORT_WORDS, 1);		/* last repetition */
+	qsort (v, SORT_WORDS, sizeof (v[0]), cmp_word);
+
+	for (i = 0; i < SORT_WORDS; ++i)
+		if (peek (SRC + 4 * i) != v[i])
+			return 0;
+
+	return 1;
+}
+
+/*
+ * State machine dispatched through jump table with bx
+ */
+#define SM_BYTES	8192
+#define SM_REPS		8
+
+enum {
+	S_LOOP = L_K, S_OUT, S_TAB, S_M1, S_RUN,
+	S_C0, S_C1, S_C2, S_C3, S_C4, S_C5, S_C6, S_C7,
+};
+
+static void build_switch (struct as *a)
+{
+	int i;
+
+	start (a);
+
+	label (a, L_MAIN);
+	fill_call (a, SRC, SM_BYTES / 4, 3);
+	ldc (a, SM_REPS, R(3));
+	mov (a, LIT | 0, R(6));
+	label (a, S_M1);
+	ldc (a, SRC, G(0));
+	ldc (a, SM_BYTES, G(1));
+	ctrl (a, 0x09, S_RUN);
+	reg  (a, 0x590, G(0), R(6), R(6));
+	reg  (a, 0x592, LIT | 1, R(3), R(3));
+	cobr (a, 0x35, LIT | 0, R(3), S_M1);
+	mov (a, R(6), G(0));
+	ret (a);
+
+	label (a, S_RUN);			/* g0 = buf, g1 = len	*/
+	mov (a, LIT | 0, R(4));
+	reg  (a, 0x590, G(1), G(0), R(5));
+	mov (a, G(0), R(6));
+	lda (a, S_TAB, R(12));
+	label (a, S_LOOP);
+	cobr (a, 0x32, R(6), R(5), S_OUT);
+	mem_at (a, 0x80, R(7), R(6), 0);	/* ldob (r6), r7	*/
+	reg  (a, 0x590, LIT | 1, R(6), R(6));
+	reg  (a, 0x581, LIT | 7, R(7), R(8));	/* and 7, r7, r8	*/
+	mem_ix (a, 0x90, R(9), R(12), R(8), 2);	/* ld (r12)[r8*4], r9	*/
+	bx (a, R(9));
+	label (a, S_C0);
+	reg  (a, 0x590, R(7), R(4), R(4));	/* addo r7, r4, r4	*/
+	ctrl (a, 0x08, S_LOOP);
+	label (a, S_C1);
+	reg  (a, 0x586, R(7), R(4), R(4));	/* xor r7, r4, r4	*/
+	ctrl (a, 0x08, S_LOOP);
+	label (a, S_C2);
+	reg  (a, 0x59C, LIT | 1, R(4), R(4));	/* shlo 1, r4, r4	*/
+	ctrl (a, 0x08, S_LOOP);
+	label (a, S_C3);
+	reg  (a, 0x59D, LIT | 3, R(4), R(4));	/* rotate 3, r4, r4	*/
+	ctrl (a, 0x08, S_LOOP);
+	label (a, S_C4);
+	reg  (a, 0x592, R(7), R(4), R(4));	/* subo r7, r4, r4	*/
+	ctrl (a, 0x08, S_LOOP);
+	label (a, S_C5);
+	reg  (a, 0x701, LIT | 3, R(4), R(4));	/* mulo 3, r4, r4	*/
+	ctrl (a, 0x08, S_LOOP);
+	label (a, S_C6);
+	reg  (a, 0x58A, R(4), 0, R(4));		/* not r4, r4		*/
+	ctrl (a, 0x08, S_LOOP);
+	label (a, S_C7);
+	reg  (a, 0x590, LIT | 7, R(4), R(4));
+	reg  (a, 0x598, LIT | 1, R(4), R(4));	/* shro 1, r4, r4	*/
+	ctrl (a, 0x08, S_LOOP);
+	label (a, S_OUT);
+	mov (a, R(4), G(0));
+	ret (a);
+
+	label (a, S_TAB);
+	for (i = 0; i < 8; ++i)
+		word (a, S_C0 + i);
+}
+
+static int check_switch (struct i960 *o)
+{
+	uint32_t v[SM_BYTES / 4], acc, sum = 0, x;
+	const uint8_t *p = (const void *) v;
+	int i, rep;
+
+	host_fill (v, SM_BYTES / 4, 3);
+
+	for (rep = 0; rep < SM_REPS; ++rep) {
+		for (acc = 0, i = 0; i < SM_BYTES; ++i)
+			switch ((x = p[i]) & 7) {
+			case 0:  acc += x;				break;
+			case 1:  acc ^= x;				break;
+			case 2:  acc <<= 1;				break;
+			case 3:  acc = acc << 3 | acc >> 29;		break;
+			case 4:  acc -= x;				break;
+			case 5:  acc *= 3;				break;
+			case 6:  acc = ~acc;				break;
+			case 7:  acc = (acc + 7) >> 1;			break;
+			}
+
+		sum += acc;
+	}
+
+	return o->r[G(0)] == sum;
+}
+
+/*
+ * Dhrystone-like mix: procedure calls with arguments, record copy,
+ * indexed array update, division, signed compare and string compare
+ */
+#define DHRY_REPS	20000
+#define DHRY_ARR	(SRC + 0x1000)
+#define DHRY_REC1	(SRC + 0x2000)
+#define DHRY_REC2	(SRC + 0x2040)
+
+static const char dhry_s1[] = "DHRYSTONE PROGRAM, 1'ST STRING";
+static const char dhry_s2[] = "DHRYSTONE PROGRAM, 2'ND STRING";
+
+enum {
+	D_M1 = L_K, D_SKIP, D_P1, D_COPY, D_CMP, D_CL, D_CD, D_S1, D_S2,
+};
+
+static void build_dhry (struct as *a)
+{
+	start (a);
+
+	label (a, L_MAIN);
+	fill_call (a, DHRY_ARR, 64, 7);
+	ldc (a, DHRY_REPS, R(3));
+	mov (a, LIT | 0, R(4));			/* acc			*/
+	mov (a, LIT | 0, R(5));			/* i			*/
+	ldc (a, 63, R(7));
+	ldc (a, DHRY_ARR, R(10));
+	label (a, D_M1);
+	mov (a, R(5), G(0));
+	mov (a, R(4), G(1));
+	ctrl (a, 0x09, D_P1);			/* acc = p1 (i, acc)	*/
+	mov (a, G(0), R(4));
+	ldc (a, DHRY_REC2, G(0));
+	ldc (a, DHRY_REC1, G(1));
+	ctrl (a, 0x09, D_COPY);
+	ldc (a, DHRY_REC1, R(11));
+	mem_at (a, 0x92, R(4), R(11), 0);	/* rec1.f0 = acc	*/
+	mem_at (a, 0x92, R(5), R(11), 20);	/* rec1.f5 = i		*/
+	reg  (a, 0x581, R(7), R(5), R(8));	/* and r7, r5, r8	*/
+	mem_ix (a, 0x90, R(6), R(10), R(8), 2);
+	reg  (a, 0x590, R(6), R(4), R(4));	/* acc += arr[i & 63]	*/
+	reg  (a, 0x701, LIT | 7, R(5), R(9));
+	reg  (a, 0x581, R(7), R(9), R(9));
+	mem_ix (a, 0x92, R(4), R(10), R(9), 2);	/* arr[i * 7 & 63] = acc */
+	reg  (a, 0x708, LIT | 13, R(4), R(11));	/* remo 13, r4, r11	*/
+	reg  (a, 0x70B, LIT | 3, R(4), R(9));	/* divo 3, r4, r9	*/
+	reg  (a, 0x590, R(11), R(9), R(4));
+	reg  (a, 0x5A1, R(4), R(6), 0);		/* cmpi r4, r6		*/
+	ctrl (a, 0x14, D_SKIP);			/* bl SKIP		*/
+	reg  (a, 0x586, R(5), R(4), R(4));
+	label (a, D_SKIP);
+	lda (a, D_S1, G(0));
+	lda (a, D_S2, G(1));
+	ctrl (a, 0x09, D_CMP);
+	reg  (a, 0x590, G(0), R(4), R(4));
+	reg  (a, 0x590, LIT | 1, R(5), R(5));
+	reg  (a, 0x592, LIT | 1, R(3), R(3));
+	cobr (a, 0x35, LIT | 0, R(3), D_M1);
+	mov (a, R(4), G(0));
+	ret (a);
+
+	label (a, D_P1);			/* g0 = g1 * 5 + g0	*/
+	reg  (a, 0x59C, LIT | 2, G(1), R(4));
+	reg  (a, 0x590, G(1), R(4), R(4));
+	reg  (a, 0x590, G(0), R(4), G(0));
+	ret (a);
+
+	label (a, D_COPY);			/* 32-byte record	*/
+	mem_at (a, 0xB0, R(4), G(1), 0);
+	mem_at (a, 0xB2, R(4), G(0), 0);
+	mem_at (a, 0xB0, R(8), G(1), 16);
+	mem_at (a, 0xB2, R(8), G(0), 16);
+	ret (a);
+
+	label (a, D_CMP);			/* index of difference	*/
+	mov (a, LIT | 0, R(4));
+	label (a, D_CL);
+	mem_at (a, 0x80, R(5), G(0), 0);
+	mem_at (a, 0x80, R(6), G(1), 0);
+	cobr (a, 0x35, R(5), R(6), D_CD);
+	cobr (a, 0x32, LIT | 0, R(5), D_CD);
+	reg  (a, 0x590, LIT | 1, G(0), G(0));
+	reg  (a, 0x590, LIT | 1, G(1), G(1));
+	reg  (a, 0x590, LIT | 1, R(4), R(4));
+	ctrl (a, 0x08, D_CL);
+	label (a, D_CD);
+	mov (a, R(4), G(0));
+	ret (a);
+
+	label (a, D_S1);
+	ascii (a, dhry_s1);
+	label (a, D_S2);
+	ascii (a, dhry_s2);
+}
+
+static int check_dhry (struct i960 *o)
+{
+	uint32_t arr[64], acc = 0, i, x, diff;
+
+	host_fill (arr, 64, 7);
+
+	for (diff = 0; dhry_s1[diff] == dhry_s2[diff]; ++diff) {}
+
+	for (i = 0; i < DHRY_REPS; ++i) {
+		acc  = acc * 5 + i;
+		acc += x = arr[i & 63];
+		arr[i * 7 & 63] = acc;
+		acc  = acc % 13 + acc / 3;
+
+		if (!((int32_t) acc < (int32_t) x))
+			acc ^= i;
+
+		acc += diff;
+	}
+
+	return o->r[G(0)] == acc;
+}
+
+/*
+ * Runner
+ */
+struct kernel {
+	const char *name;
+	void (*build) (struct as *a);
+	int  (*check) (struct i960 *o);
+};
+
+static const struct kernel kernels[] = {
+	{ "crc32",	build_crc,	check_crc	},
+	{ "copy",	build_copy,	check_copy	},
+	{ "qsort",	build_sort,	check_sort	},
+	{ "switch",	build_switch,	check_switch	},
+	{ "dhry",	build_dhry,	check_dhry	},
+};
+
+#define NKERNELS	(sizeof (kernels) / sizeof (kernels[0]))
+
+/*
+ * Engine modes: the interpreter alone and with each optional per
+ * instruction instrumentation attached
+ */
+#define MODE_PLAIN	0
+#define MODE_STAT	1
+#define MODE_BSTAT	2
+#define MODE_ACCT	3
+#define MODE_COUNT	4
+
+static const char *mode_name[MODE_COUNT] = {
+	"plain", "stat", "bstat", "acct",
+};
+
+struct image {
+	const char *name;
+	const uint32_t *v;
+	size_t n;
+};
+
+#define RUN_LIMIT	(1ull << 28)
+
+static struct i960_pmu pmu;
+static struct i960_acct run_acct;		/* over runs of one mode */
+static FILE *store;				/* results file or NULL */
+
+/*
+ * Load image into clean memory and run it to halt, returns elapsed time
+ */
+static double run (struct i960 *o, const struct image *im, int mode,
+		   uint64_t *insns)
+{
+	static struct i960_stat   stat;
+	static struct i960_bstat  bstat;
+	double t;
+
+	memset (host_mem, 0, sizeof (host_mem));
+	memcpy (host_mem + LOAD, im->v, im->n * 4);
+
+	memset (o, 0, sizeof (*o));
+	o->ac = 1 << I960_OM_POS;		/* mask integer overflow */
+	o->ip = LOAD;
+	o->r[I960_FP] = STACK;
+	o->r[I960_SP] = STACK + 64;
+
+	switch (mode) {
+	case MODE_STAT:
+		memset (&stat, 0, sizeof (stat));
+		o->stat = &stat;
+		break;
+	case MODE_BSTAT:
+		i960_bstat_fini (&bstat);
+		memset (&bstat, 0, sizeof (bstat));
+		o->bstat = &bstat;
+		break;
+	case MODE_ACCT:
+		o->acct = &run_acct;
+		break;
+	}
+
+	host_faults = 0;
+
+	i960_pmu_start (&pmu);
+	t = host_now ();
+	*insns = i960_run (o, HALT, RUN_LIMIT);
+	t = host_now () - t;
+	i960_pmu_stop (&pmu);
+
+	return t;
+}
+
+static void report (const struct image *im, int mode, int ok, uint64_t insns,
+		    const double *t, unsigned runs, int first)
+{
+	struct i960_sample s;
+	double *x = malloc (runs * sizeof (x[0]));
+	unsigned i;
+
+	for (i = 0; i < runs; ++i)
+		x[i] = insns / t[i] / 1e6;
+
+	i960_sample_stat (&s, x, runs);
+
+	if (store != NULL)
+		i960_results_put (store, im->name, mode_name[mode], x, runs);
+
+	free (x);
+
+	printf ("%s\n    {\n"
+		"      \"kernel\": \"%s\",\n"
+		"      \"mode\": \"%s\",\n"
+		"      \"ok\": %s,\n"
+		"      \"insns\": %llu,\n"
+		"      \"mips\": { \"mean\": %.2f, \"stddev\": %.2f, "
+		"\"ci95\": [%.2f, %.2f], \"max\": %.2f },\n"
+		"      \"host_per_insn\": ",
+		first ? "" : ",", im->name, mode_name[mode],
+		ok < 0 ? "null" : ok ? "true" : "false",
+		(unsigned long long) insns,
+		s.mean, s.sd, s.lo, s.hi, s.max);
+
+	i960_pmu_report (stdout, &pmu, insns * runs);
+	printf ("\n    }");
+}
+
+static int measure (const struct image *im, const struct kernel *k,
+		    unsigned modes, unsigned runs, int first)
+{
+	double *t = malloc (runs * sizeof (t[0]));
+	uint64_t insns = 0;
+	struct i960 o;
+	unsigned i;
+	int mode, ok, bad = 0;
+
+	if (t == NULL) {
+		perror ("i960-macro");
+		exit (1);
+	}
+
+	for (mode = 0; mode < MODE_COUNT; ++mode) {
+		if ((modes & (1u << mode)) == 0)
+			continue;
+
+		i960_pmu_reset (&pmu);
+
+		if (mode == MODE_ACCT)
+			i960_acct_init (&run_acct);
+
+		for (i = 0, ok = 1; i < runs; ++i) {
+			t[i] = run (&o, im, mode, &insns);
+			ok &= o.ip == HALT && host_faults == 0;
+		}
+
+		if (ok && k != NULL)
+			ok = k->check (&o);
+		else if (ok)
+			ok = -1;		/* external image, unknown */
+
+		report (im, mode, ok, insns, t, runs, first);
+		fflush (stdout);
+		bad |= !ok;
+		first = 0;
+	}
+
+	free (t);
+	return bad;
+}
+
+static int write_image (const char *dir, const struct image *im)
+{
+	char path[4096];
+	FILE *f;
+	int ok;
+
+	snprintf (path, sizeof (path), "%s/%s.img", dir, im->name);
+
+	if ((f = fopen (path, "wb")) == NULL)
+		return 0;
+
+	ok = fwrite (im->v, 4, im->n, f) == im->n;
+	return fclose (f) == 0 && ok;
+}
+
+static int read_image (const char *path, struct as *a, struct image *im)
+{
+	FILE *f;
+
+	errno = 0;
+
+	if ((f = fopen (path, "rb")) == NULL)
+		return 0;
+
+	a->n = fread (a->v, 4, MAX_WORDS, f);
+	fclose (f);
+
+	im->name = path;
+	im->v    = a->v;
+	im->n    = a->n;
+	return a->n > 0;
+}
+
+static unsigned parse_modes (const char *s)
+{
+	unsigned modes = 0;
+	size_t len;
+	int i;
+
+	for (; *s != '\0'; s += len + (s[len] == ',')) {
+		len = strcspn (s, ",");
+
+		for (i = 0; i < MODE_COUNT; ++i)
+			if (strlen (mode_name[i]) == len &&
+			    strncmp (s, mode_name[i], len) == 0)
+				modes |= 1u << i;
+	}
+
+	return modes;
+}
+
+static int usage (void)
+{
+	fprintf (stderr, "usage:\n\ti960-macro [-r runs] "
+			 "[-m plain,stat,bstat,acct] [-w dir] [-o dir] "
+			 "[kernel | image.img ...]\n");
+	return 1;
+}
+
+int main (int argc, char *argv[])
+{
+	static struct as a;
+	const char *dir = NULL, *out = NULL;
+	char path[256];
+	unsigned runs = 5, modes = (1u << MODE_COUNT) - 1;
+	struct image im;
+	int opt, i, first = 1, bad = 0;
+	size_t k;
+
+	while ((opt = getopt (argc, argv, "r:m:w:o:")) != -1)
+		switch (opt) {
+		case 'r':  runs  = atoi (optarg);		break;
+		case 'm':  modes = parse_modes (optarg);	break;
+		case 'w':  dir   = optarg;			break;
+		case 'o':  out   = optarg;			break;
+		default:
+			return usage ();
+		}
+
+	if (runs == 0 || modes == 0)
+		return usage ();
+
+	argc -= optind;
+	argv += optind;
+
+	if (dir == NULL && out != NULL &&
+	    (store = i960_results_create (out, "i960-macro", path,
+					  sizeof (path))) == NULL) {
+		perror (out);
+		return 1;
+	}
+
+	if (dir == NULL && i960_pmu_open (&pmu) == 0)
+		fprintf (stderr, "i960-macro: no host performance counters\n");
+
+	if (dir == NULL)
+		printf ("{\n  \"format\": \"i960-macro/1\",\n"
+			"  \"runs\": %u,\n  \"results\": [", runs);
+
+	for (k = 0; k < NKERNELS; ++k) {
+		if (!host_selected (kernels[k].name, argc, argv))
+			continue;
+
+		kernels[k].build (&a);
+		resolve (&a);
+		im = (struct image) { kernels[k].name, a.v, a.n };
+
+		if (dir != NULL) {
+			if (!write_image (dir, &im)) {
+				perror (dir);
+				return 1;
+			}
+		}
+		else {
+			bad |= measure (&im, kernels + k, modes, runs, first);
+			first = 0;
+		}
+	}
+
+	for (i = 0; dir == NULL && i < argc; ++i) {
+		for (k = 0; k < NKERNELS; ++k)
+			if (strcmp (argv[i], kernels[k].name) == 0)
+				break;
+
+		if (k < NKERNELS)
+			continue;
+
+		if (!read_image (argv[i], &a, &im)) {
+			fprintf (stderr, "i960-macro: cannot load %s: %s\n",
+				 argv[i], errno ? strerror (errno) : "empty");
+			return 1;
+		}
+
+		bad |= measure (&im, NULL, modes, runs, first);
+		first = 0;
+	}
+
+	if (dir == NULL) {
+		printf ("\n  ]\n}\n");
+		i960_pmu_close (&pmu);
+	}
+
+	if (store != NULL) {
+		if (fclose (store) != 0) {
+			perror (path);
+			return 1;
+		}
+
+		fprintf (stderr, "i960-macro: results saved to %s\n", path);
+	}
+
+	return bad;
+}
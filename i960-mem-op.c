@@ -12,7 +12,7 @@
  * A0  ldt	A2  stt
  * B0  ldq	B2  stq
  *
- * 84  bx	85  balx	86  callx	8C  lda
+ * 84  bx	85  balx	86  callx	8C  lda		AC  dcinva
  *
  * C1    -- store vs load
  * C2    -- funcs vs transfer
@@ -21,29 +21,89 @@
  */
 
 #include <i960-emu.h>
+#include <i960-emu-acct.h>
+#include <i960-emu-alog.h>
 #include <i960-emu-bits.h>
 #include <i960-emu-branch.h>
 #include <i960-emu-faults.h>
+#include <i960-emu-ops.h>
+#include <i960-emu-stat.h>
+
+/*
+ * Logged Memory Access
+ */
+static inline uint32_t mem_read_b (struct i960 *o, uint32_t efa)
+{
+	const uint32_t x = i960_read_b (o, efa);
+
+	i960_alog (o, I960_ACC_LOAD, efa, 1, x);
+	return x;
+}
+
+static inline uint32_t mem_read_s (struct i960 *o, uint32_t efa)
+{
+	const uint32_t x = i960_read_s (o, efa);
+
+	i960_alog (o, I960_ACC_LOAD, efa, 2, x);
+	return x;
+}
+
+static inline uint32_t mem_read_w (struct i960 *o, uint32_t efa)
+{
+	const uint32_t x = i960_read_w (o, efa);
+
+	i960_alog (o, I960_ACC_LOAD, efa, 4, x);
+	return x;
+}
+
+static inline void mem_write_b (struct i960 *o, uint32_t efa, uint32_t x)
+{
+	i960_alog (o, I960_ACC_STORE, efa, 1, x);
+	i960_write_b (o, efa, x);
+}
+
+static inline void mem_write_s (struct i960 *o, uint32_t efa, uint32_t x)
+{
+	i960_alog (o, I960_ACC_STORE, efa, 2, x);
+	i960_write_s (o, efa, x);
+}
+
+static inline void mem_write_w (struct i960 *o, uint32_t efa, uint32_t x)
+{
+	i960_alog (o, I960_ACC_STORE, efa, 4, x);
+	i960_write_w (o, efa, x);
+}
 
 /*
  * Non-memory Access Functions
  *
  * decoder height = 3
  */
+static inline
+void mem_dcinva (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
+{
+	i960_alog (o, I960_ACC_DCINVA, efa, 4, 0);  /* no data cache here */
+}
+
 static void mem_funcs (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 {
 	const int C3 = u32_bit_select (op, 24 + 3);      /* ---- x1-- */
+	const int C5 = u32_bit_select (op, 24 + 5);      /* --x- 11-- */
 	const uint32_t i = u32_extract (op, 24 + 0, 2);  /* ---- 01xx */
 
 	if (C3)
-		o->r[c] = efa;				/* 11--  lda	*/
-	else
+		if (C5)	mem_dcinva (o, op, efa, c);	/* AC  dcinva	*/
+		else	o->r[c] = efa;			/* 8C  lda	*/
+	else {
+		i960_bstat_indirect (o, op, efa);
+
 		switch (i) {
-		case 0:  i960_b    (o, efa);     break;	/* 0100  bx	*/
+		case 0:  i960_bx   (o, efa);     break;	/* 0100  bx	*/
 		case 1:  i960_bal  (o, efa, c);  break;	/* 0101  balx	*/
 		case 2:  i960_call (o, efa);     break;	/* 011-  callx	*/
 		case 3:  i960_call (o, efa);     break;	/* 011-  filler	*/
 		}
+	}
 }
 
 /*
@@ -54,7 +114,7 @@ static void mem_funcs (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 static inline void mem_ldb (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 {
 	const int C6 = u32_bit_select (op, 24 + 6);  /* -x00 000- */
-	const uint8_t x = i960_read_b (o, efa);
+	const uint8_t x = mem_read_b (o, efa);
 
 	o->r[c] = C6 ? (int8_t) x : x;  /* if integer then sign-extend */
 }
@@ -62,35 +122,35 @@ static inline void mem_ldb (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 static inline void mem_lds (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 {
 	const int C6 = u32_bit_select (op, 24 + 6);  /* -x00 100- */
-	const uint16_t x = i960_read_s (o, efa);
+	const uint16_t x = mem_read_s (o, efa);
 
 	o->r[c] = C6 ? (int16_t) x : x;  /* if integer then sign-extend */
 }
 
 static inline void mem_ld (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 {
-	o->r[c] = i960_read_w (o, efa);
+	o->r[c] = mem_read_w (o, efa);
 }
 
 static inline void mem_ldl (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 {
-	o->r[c | 0] = i960_read_w (o, efa + 0);
-	o->r[c | 1] = i960_read_w (o, efa + 4);
+	o->r[c | 0] = mem_read_w (o, efa + 0);
+	o->r[c | 1] = mem_read_w (o, efa + 4);
 }
 
 static inline void mem_ldt (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 {
-	o->r[c | 0] = i960_read_w (o, efa + 0);
-	o->r[c | 1] = i960_read_w (o, efa + 4);
-	o->r[c | 2] = i960_read_w (o, efa + 8);
+	o->r[c | 0] = mem_read_w (o, efa + 0);
+	o->r[c | 1] = mem_read_w (o, efa + 4);
+	o->r[c | 2] = mem_read_w (o, efa + 8);
 }
 
 static inline void mem_ldq (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 {
-	o->r[c | 0] = i960_read_w (o, efa + 0);
-	o->r[c | 1] = i960_read_w (o, efa + 4);
-	o->r[c | 2] = i960_read_w (o, efa + 8);
-	o->r[c | 3] = i960_read_w (o, efa + 12);
+	o->r[c | 0] = mem_read_w (o, efa + 0);
+	o->r[c | 1] = mem_read_w (o, efa + 4);
+	o->r[c | 2] = mem_read_w (o, efa + 8);
+	o->r[c | 3] = mem_read_w (o, efa + 12);
 }
 
 static void mem_load (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
@@ -119,7 +179,7 @@ static inline void mem_stb (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 	const int C6 = u32_bit_select (op, 24 + 6);  /* -x00 001- */
 	const int32_t x = o->r[c];
 
-	i960_write_b (o, efa, x);
+	mem_write_b (o, efa, x);
 
 	if (C6 && x != (int8_t) x)	/* if integer then check for overflow */
 		i960_on_overflow (o);
@@ -130,7 +190,7 @@ static inline void mem_sts (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 	const int C6 = u32_bit_select (op, 24 + 6);  /* -x00 101- */
 	const int32_t x = o->r[c];
 
-	i960_write_s (o, efa, x);
+	mem_write_s (o, efa, x);
 
 	if (C6 && x != (int16_t) x)	/* if integer then check for overflow */
 		i960_on_overflow (o);
@@ -138,28 +198,28 @@ static inline void mem_sts (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 
 static inline void mem_st (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 {
-	i960_write_w (o, efa, o->r[c]);
+	mem_write_w (o, efa, o->r[c]);
 }
 
 static inline void mem_stl (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 {
-	i960_write_w (o, efa +  0, o->r[c | 0]);
-	i960_write_w (o, efa +  4, o->r[c | 1]);
+	mem_write_w (o, efa +  0, o->r[c | 0]);
+	mem_write_w (o, efa +  4, o->r[c | 1]);
 }
 
 static inline void mem_stt (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 {
-	i960_write_w (o, efa +  0, o->r[c | 0]);
-	i960_write_w (o, efa +  4, o->r[c | 1]);
-	i960_write_w (o, efa +  8, o->r[c | 2]);
+	mem_write_w (o, efa +  0, o->r[c | 0]);
+	mem_write_w (o, efa +  4, o->r[c | 1]);
+	mem_write_w (o, efa +  8, o->r[c | 2]);
 }
 
 static inline void mem_stq (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 {
-	i960_write_w (o, efa +  0, o->r[c | 0]);
-	i960_write_w (o, efa +  4, o->r[c | 1]);
-	i960_write_w (o, efa +  8, o->r[c | 2]);
-	i960_write_w (o, efa + 12, o->r[c | 3]);
+	mem_write_w (o, efa +  0, o->r[c | 0]);
+	mem_write_w (o, efa +  4, o->r[c | 1]);
+	mem_write_w (o, efa +  8, o->r[c | 2]);
+	mem_write_w (o, efa + 12, o->r[c | 3]);
 }
 
 static void mem_store (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
@@ -188,7 +248,12 @@ void mem_op (struct i960 *o, uint32_t op, uint32_t efa, size_t c)
 	const int C1 = u32_bit_select (op, 24 + 1);  /* ---- --x- */
 	const int C2 = u32_bit_select (op, 24 + 2);  /* ---- -x-- */
 
+	i960_stat_mem (o, op);
+	i960_acct_enter (o, I960_ACCT_MEM);
+
 	if (C2)		mem_funcs (o, op, efa, c);  /* ---- -1-- */
 	else if (C1)	mem_store (o, op, efa, c);  /* ---- -01- */
 	else		mem_load  (o, op, efa, c);  /* ---- -00- */
+
+	i960_acct_leave (o);
 }
@@ -0,0 +1,515 @@
+/*
+ * 80960 Image Disassembler
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <i960-dasm.h>
+#include <i960-decode.h>
+#include <i960-sym.h>
+
+/*
+ * Image is split into chunks disassembled in parallel, each worker
+ * assumes an instruction starts at its chunk start. Main thread writes
+ * chunks in order and resynchronizes when a long MEMB instruction of
+ * previous chunk spills over the boundary. Last chunk runs to the end of
+ * image, bytes past the last whole word are written as .byte.
+ */
+#define CHUNK_SIZE	(64 * 1024)
+#define WINDOW		4		/* chunks in flight per thread */
+
+struct text {
+	char *v;
+	size_t len, avail;
+};
+
+struct chunk {
+	uint32_t start, end;		/* image offsets		*/
+	uint32_t stop;			/* end of last instruction	*/
+	struct text text;
+	uint32_t *starts;		/* instruction offsets		*/
+	size_t *pos;			/* their text positions		*/
+	size_t count;
+	int done;
+};
+
+struct job {
+	const uint8_t *image;
+	uint32_t size, base;
+	struct i960_syms *syms;		/* sorted already or NULL	*/
+
+	struct chunk *chunks;
+	size_t nchunks, next, written;
+	size_t window;			/* chunks ahead of writer	*/
+
+	pthread_mutex_t lock;
+	pthread_cond_t  ready, space;
+};
+
+static void *xrealloc (void *p, size_t size)
+{
+	if ((p = realloc (p, size)) == NULL) {
+		perror ("i960-objdump");
+		exit (1);
+	}
+
+	return p;
+}
+
+static char *text_reserve (struct text *t, size_t n)
+{
+	size_t avail = t->avail == 0 ? 4096 : t->avail;
+
+	if (t->len + n > t->avail) {
+		while (t->len + n > avail)
+			avail *= 2;
+
+		t->v     = xrealloc (t->v, avail);
+		t->avail = avail;
+	}
+
+	return t->v + t->len;
+}
+
+/*
+ * Formatting
+ */
+static char *put_hex (char *p, uint32_t x, int width)
+{
+	int i;
+
+	for (i = width - 1; i >= 0; --i, x >>= 4)
+		p[i] = "0123456789abcdef"[x & 15];
+
+	return p + width;
+}
+
+static char *put_off (char *p, uint32_t x)
+{
+	int width = 1;
+
+	while (width < 8 && (x >> 4 * width) != 0)
+		++width;
+
+	return put_hex (p, x, width);
+}
+
+static char *put_sym (char *p, const struct i960_sym *s, uint32_t addr)
+{
+	const size_t len = strlen (s->name);
+
+	*p++ = '<';
+	memcpy (p, s->name, len);
+	p += len;
+
+	if (addr != s->addr) {
+		memcpy (p, "+0x", 3);
+		p = put_off (p + 3, addr - s->addr);
+	}
+
+	*p++ = '>';
+	return p;
+}
+
+static uint32_t word_at (const struct job *j, uint32_t off)
+{
+	const uint8_t *p = j->image + off;
+
+	return off + 4 > j->size ? 0 :
+	       p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+/*
+ * Stores branch target of a decoded instruction, returns 0 if it has none
+ */
+static int insn_target (const struct i960_insn *in, uint32_t ip,
+			uint32_t *target)
+{
+	const uint32_t op = in->op;
+
+	switch (in->format) {
+	case I960_FMT_CTRL:
+		*target = ip + in->disp;
+		return (op >> 24) >= 0x08 && (op >> 24) < 0x18 &&
+		       (op >> 24) != 0x0a;		/* not ret, fault */
+	case I960_FMT_COBR:
+		*target = ip + in->disp;
+		return (op >> 28) & 1;			/* compare and branch */
+	case I960_FMT_REG:
+		return 0;
+	default:
+		if ((in->code & 0x7f) < 0x04 || (in->code & 0x7f) > 0x06)
+			return 0;			/* not bx, balx, callx */
+
+		switch (in->mode) {
+		case 0x0:
+		case 0xC:  *target = in->disp;		return 1;
+		case 0x5:  *target = ip + 8 + in->disp;	return 1;
+		default:   return 0;
+		}
+	}
+}
+
+/*
+ * Format trailing bytes of image, less than a word, into text
+ */
+static uint32_t format_bytes (const struct job *j, uint32_t off,
+			      struct text *t)
+{
+	const uint32_t n = j->size - off;
+	char *p = text_reserve (t, 64);
+	uint32_t i;
+
+	p = put_hex (p, j->base + off, 8);
+	memcpy (p, ":\t", 2), p += 2;
+
+	for (i = 0; i < n; ++i)
+		p = put_hex (p, j->image[off + i], 2);
+
+	memset (p, ' ', 17 - 2 * n), p += 17 - 2 * n;
+	memcpy (p, "\t.byte\t", 7), p += 7;
+
+	for (i = 0; i < n; ++i) {
+		if (i > 0)
+			memcpy (p, ", ", 2), p += 2;
+
+		memcpy (p, "0x", 2);
+		p = put_hex (p + 2, j->image[off + i], 2);
+	}
+
+	*p++ = '\n';
+	t->len = p - t->v;
+	return n;
+}
+
+/*
+ * Format one instruction at image offset into text, returns its length
+ */
+static uint32_t format (const struct job *j, uint32_t off, struct text *t)
+{
+	const uint32_t ip = j->base + off;
+	const uint32_t op = word_at (j, off);
+	const uint32_t disp = word_at (j, off + 4);
+	const struct i960_sym *s = NULL, *ts = NULL;
+	struct i960_insn in;
+	uint32_t len, target;
+	int tail;
+	size_t need = 2 * I960_DASM_MAX;
+	char *p;
+
+	if (j->size - off < 4)
+		return format_bytes (j, off, t);
+
+	len  = i960_decode (&in, op, disp);
+	tail = off + len > j->size;		/* truncated long MEMB	*/
+	len  = tail ? 4 : len;
+
+	if (j->syms != NULL) {
+		if ((s = i960_syms_lookup (j->syms, ip)) != NULL &&
+		    s->addr != ip)
+			s = NULL;
+
+		if (insn_target (&in, ip, &target))
+			ts = i960_syms_lookup (j->syms, target);
+
+		need += s  != NULL ? strlen (s->name)  : 0;
+		need += ts != NULL ? strlen (ts->name) : 0;
+	}
+
+	p = text_reserve (t, need);
+
+	if (s != NULL) {
+		*p++ = '\n';
+		p = put_hex (p, ip, 8);
+		*p++ = ' ';
+		p = put_sym (p, s, ip);
+		memcpy (p, ":\n", 2), p += 2;
+	}
+
+	p = put_hex (p, ip, 8);
+	memcpy (p, ":\t", 2), p += 2;
+	p = put_hex (p, op, 8);
+	*p++ = ' ';
+
+	if (len == 8)
+		p = put_hex (p, disp, 8);
+	else
+		memset (p, ' ', 8), p += 8;
+
+	*p++ = '\t';
+
+	if (tail) {
+		memcpy (p, ".word\t0x", 8);
+		p = put_hex (p + 8, op, 8);
+	}
+	else {
+		i960_dasm_insn (p, I960_DASM_MAX, ip, &in);
+		p += strlen (p);
+	}
+
+	if (ts != NULL && !tail) {
+		*p++ = '\t';
+		p = put_sym (p, ts, target);
+	}
+
+	*p++ = '\n';
+	t->len = p - t->v;
+	return len;
+}
+
+static void chunk_run (const struct job *j, struct chunk *c)
+{
+	size_t avail = 0;
+	uint32_t off;
+
+	for (off = c->start; off < c->end; off += format (j, off, &c->text)) {
+		if (c->count == avail) {
+			avail = avail == 0 ? CHUNK_SIZE / 4 : avail * 2;
+			c->starts = xrealloc (c->starts, avail * sizeof (c->starts[0]));
+			c->pos    = xrealloc (c->pos,    avail * sizeof (c->pos[0]));
+		}
+
+		c->starts[c->count] = off;
+		c->pos[c->count]    = c->text.len;
+		++c->count;
+	}
+
+	c->stop = off;
+}
+
+/*
+ * Workers take chunks in order, staying at most window chunks ahead of
+ * the writer
+ */
+static void *worker (void *cookie)
+{
+	struct job *j = cookie;
+	struct chunk *c;
+
+	for (;;) {
+		pthread_mutex_lock (&j->lock);
+
+		while (j->next < j->nchunks && j->next >= j->written + j->window)
+			pthread_cond_wait (&j->space, &j->lock);
+
+		if (j->next >= j->nchunks) {
+			pthread_mutex_unlock (&j->lock);
+			return NULL;
+		}
+
+		c = j->chunks + j->next++;
+		pthread_mutex_unlock (&j->lock);
+
+		chunk_run (j, c);
+
+		pthread_mutex_lock (&j->lock);
+		c->done = 1;
+		pthread_cond_broadcast (&j->ready);
+		pthread_mutex_unlock (&j->lock);
+	}
+}
+
+static size_t find_start (const struct chunk *c, uint32_t off)
+{
+	size_t lo = 0, hi = c->count, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+
+		if (c->starts[mid] < off)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/*
+ * Write chunk starting at offset next, returns offset past its last
+ * instruction
+ */
+static uint32_t chunk_write (const struct job *j, struct chunk *c,
+			     uint32_t next, FILE *to)
+{
+	struct text fix = {};
+	size_t i;
+
+	/*
+	 * resync: disassemble from real boundary until paths converge or
+	 * chunk ends
+	 */
+	while ((i = find_start (c, next)) < c->count ? c->starts[i] != next :
+						      next < c->end)
+		next += format (j, next, &fix);
+
+	fwrite (fix.v, 1, fix.len, to);
+	free (fix.v);
+
+	if (i < c->count) {
+		fwrite (c->text.v + c->pos[i], 1, c->text.len - c->pos[i], to);
+		next = c->stop;
+	}
+
+	return next;
+}
+
+static int disassemble (struct job *j, unsigned threads, FILE *to)
+{
+	pthread_t *tv = xrealloc (NULL, threads * sizeof (tv[0]));
+	struct chunk *c;
+	uint32_t next = 0;
+	unsigned i, n;
+	int e;
+
+	j->window = WINDOW * threads;
+
+	for (n = 0; n < threads; ++n)
+		if ((e = pthread_create (tv + n, NULL, worker, j)) != 0) {
+			errno = e;
+			perror ("i960-objdump: pthread_create");
+			break;
+		}
+
+	if (n == 0)
+		return 0;
+
+	for (i = 0; i < j->nchunks; ++i) {
+		c = j->chunks + i;
+
+		pthread_mutex_lock (&j->lock);
+
+		while (!c->done)
+			pthread_cond_wait (&j->ready, &j->lock);
+
+		pthread_mutex_unlock (&j->lock);
+
+		next = chunk_write (j, c, next, to);
+
+		free (c->text.v);
+		free (c->starts);
+		free (c->pos);
+
+		pthread_mutex_lock (&j->lock);
+		++j->written;
+		pthread_cond_broadcast (&j->space);
+		pthread_mutex_unlock (&j->lock);
+	}
+
+	while (n > 0)
+		pthread_join (tv[--n], NULL);
+
+	free (tv);
+	return 1;
+}
+
+static uint8_t *load (const char *path, uint32_t *size)
+{
+	uint8_t *v = NULL;
+	size_t len = 0, avail = 0, n;
+	FILE *f;
+
+	if ((f = fopen (path, "rb")) == NULL)
+		return NULL;
+
+	do {
+		if (len == avail) {
+			avail = avail == 0 ? 1 << 20 : avail * 2;
+			v = xrealloc (v, avail);
+		}
+
+		len += n = fread (v + len, 1, avail - len, f);
+	}
+	while (n > 0);
+
+	if (ferror (f) || len > UINT32_MAX) {
+		errno = ferror (f) ? errno : EFBIG;
+		fclose (f);
+		free (v);
+		return NULL;
+	}
+
+	fclose (f);
+	*size = len;
+	return v;
+}
+
+static int usage (void)
+{
+	fprintf (stderr, "usage:\n\ti960-objdump [-b base] [-s symbols] "
+			 "[-j threads] image\n");
+	return 1;
+}
+
+int main (int argc, char *argv[])
+{
+	struct job j = {};
+	struct i960_syms syms;
+	const char *sympath = NULL;
+	long threads = sysconf (_SC_NPROCESSORS_ONLN);
+	size_t i;
+	int opt, ok;
+
+	while ((opt = getopt (argc, argv, "b:s:j:")) != -1)
+		switch (opt) {
+		case 'b':  j.base  = strtoul (optarg, NULL, 0);	break;
+		case 's':  sympath = optarg;			break;
+		case 'j':  threads = atoi (optarg);		break;
+		default:
+			return usage ();
+		}
+
+	if (argc - optind != 1 || threads < 1)
+		return usage ();
+
+	if ((j.image = load (argv[optind], &j.size)) == NULL) {
+		perror (argv[optind]);
+		return 1;
+	}
+
+	i960_syms_init (&syms);
+
+	if (sympath != NULL) {
+		if (!i960_syms_load (&syms, sympath)) {
+			perror (sympath);
+			return 1;
+		}
+
+		i960_syms_lookup (&syms, 0);	/* sort before sharing */
+		j.syms = &syms;
+	}
+
+	j.nchunks = (j.size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	j.chunks  = xrealloc (NULL, (j.nchunks + 1) * sizeof (j.chunks[0]));
+
+	for (i = 0; i < j.nchunks; ++i) {
+		memset (j.chunks + i, 0, sizeof (j.chunks[0]));
+		j.chunks[i].start = i * CHUNK_SIZE;
+		j.chunks[i].end   = i + 1 < j.nchunks ? (i + 1) * CHUNK_SIZE :
+						       j.size;
+	}
+
+	pthread_mutex_init (&j.lock, NULL);
+	pthread_cond_init (&j.ready, NULL);
+	pthread_cond_init (&j.space, NULL);
+
+	ok = disassemble (&j, threads, stdout) && fflush (stdout) == 0;
+
+	pthread_cond_destroy (&j.space);
+	pthread_cond_destroy (&j.ready);
+	pthread_mutex_destroy (&j.lock);
+
+	free (j.chunks);
+	free ((void *) j.image);
+	i960_syms_fini (&syms);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/*
+ * 80960 Emulator Linux perf Code Map
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <i960-perf-map.h>
+
+#define JIT_MAGIC	0x4A695444	/* "JiTD"			*/
+#define JIT_VERSION	1
+#define JIT_CODE_LOAD	0
+#define JIT_CODE_CLOSE	3
+
+#if defined (__x86_64__)
+#define JIT_MACH	62		/* EM_X86_64			*/
+#elif defined (__aarch64__)
+#define JIT_MACH	183		/* EM_AARCH64			*/
+#elif defined (__i386__)
+#define JIT_MACH	3		/* EM_386			*/
+#else
+#define JIT_MACH	0
+#endif
+
+struct jit_header {
+	uint32_t magic, version, size, mach, pad, pid;
+	uint64_t timestamp, flags;
+};
+
+struct jit_record {
+	uint32_t id, size;
+	uint64_t timestamp;
+};
+
+struct jit_code_load {
+	struct jit_record head;
+	uint32_t pid, tid;
+	uint64_t vma, code, size, index;
+};
+
+static uint64_t jit_time (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static FILE *perf_open (const char *kind, const char *mode)
+{
+	char path[64];
+
+	snprintf (path, sizeof (path), "/tmp/%s-%ld.%s", kind,
+		  (long) getpid (), kind[0] == 'p' ? "map" : "dump");
+
+	return fopen (path, mode);
+}
+
+static int jit_open (struct i960_perf_map *o)
+{
+	const long page = sysconf (_SC_PAGESIZE);
+	struct jit_header h;
+
+	if ((o->dump = perf_open ("jit", "w+b")) == NULL)
+		return 0;
+
+	memset (&h, 0, sizeof (h));
+	h.magic     = JIT_MAGIC;
+	h.version   = JIT_VERSION;
+	h.size      = sizeof (h);
+	h.mach      = JIT_MACH;
+	h.pid       = getpid ();
+	h.timestamp = jit_time ();
+
+	if (fwrite (&h, sizeof (h), 1, o->dump) != 1 || fflush (o->dump) != 0)
+		return 0;
+
+	/*
+	 * perf record notices jitdump file by executable mapping of it
+	 */
+	o->marker = mmap (NULL, page, PROT_READ | PROT_EXEC, MAP_PRIVATE,
+			  fileno (o->dump), 0);
+
+	return o->marker != MAP_FAILED;
+}
+
+int i960_perf_map_open (struct i960_perf_map *o, int flags,
+			struct i960_syms *syms)
+{
+	memset (o, 0, sizeof (*o));
+	o->marker = MAP_FAILED;
+	o->syms   = syms;
+
+	if ((flags & I960_PERF_MAP) != 0) {
+		if ((o->map = perf_open ("perf", "w")) == NULL)
+			goto no_map;
+
+		setvbuf (o->map, NULL, _IOLBF, 0);
+	}
+
+	if ((flags & I960_PERF_JITDUMP) != 0 && !jit_open (o))
+		goto no_dump;
+
+	return 1;
+no_dump:
+	i960_perf_map_close (o);
+no_map:
+	return 0;
+}
+
+void i960_perf_map_close (struct i960_perf_map *o)
+{
+	struct jit_record r = { JIT_CODE_CLOSE, sizeof (r), jit_time () };
+
+	if (o->dump != NULL) {
+		fwrite (&r, sizeof (r), 1, o->dump);
+		fclose (o->dump);
+	}
+
+	if (o->marker != MAP_FAILED)
+		munmap (o->marker, sysconf (_SC_PAGESIZE));
+
+	if (o->map != NULL)
+		fclose (o->map);
+
+	memset (o, 0, sizeof (*o));
+	o->marker = MAP_FAILED;
+}
+
+static void perf_name (char *name, size_t len, struct i960_perf_map *o,
+		       uint32_t guest)
+{
+	const struct i960_sym *s;
+
+	s = o->syms == NULL ? NULL : i960_syms_lookup (o->syms, guest);
+
+	if (s == NULL)
+		snprintf (name, len, "i960:0x%08x", guest);
+	else if (s->addr == guest)
+		snprintf (name, len, "i960:0x%08x %s", guest, s->name);
+	else
+		snprintf (name, len, "i960:0x%08x %s+0x%x", guest, s->name,
+			  guest - s->addr);
+}
+
+static int jit_add (struct i960_perf_map *o, const void *code, size_t size,
+		    const char *name)
+{
+	const size_t len = strlen (name) + 1;
+	struct jit_code_load r;
+
+	r.head.id        = JIT_CODE_LOAD;
+	r.head.size      = sizeof (r) + len + size;
+	r.head.timestamp = jit_time ();
+	r.pid   = getpid ();
+	r.tid   = syscall (SYS_gettid);
+	r.vma   = (uintptr_t) code;
+	r.code  = (uintptr_t) code;
+	r.size  = size;
+
+	flockfile (o->dump);
+
+	r.index = o->index++;
+
+	fwrite (&r, sizeof (r), 1, o->dump);
+	fwrite (name, len, 1, o->dump);
+	fwrite (code, size, 1, o->dump);
+
+	funlockfile (o->dump);
+	return !ferror (o->dump);
+}
+
+int i960_perf_map_add (struct i960_perf_map *o, const void *code, size_t size,
+		       uint32_t guest)
+{
+	char name[256];
+	int ok = 1;
+
+	perf_name (name, sizeof (name), o, guest);
+
+	if (o->map != NULL)
+		ok = fprintf (o->map, "%lx %zx %s\n",
+			      (unsigned long) (uintptr_t) code, size, name) > 0;
+
+	if (o->dump != NULL)
+		ok &= jit_add (o, code, size, name);
+
+	return ok;
+}
@@ -0,0 +1,244 @@
+/*
+ * 80960 Emulator Host Performance Counters
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include <i960-pmu.h>
+
+#ifdef __linux__
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#define CACHE_MISS(cache, op)						\
+	((cache) | (PERF_COUNT_HW_CACHE_OP_##op << 8) |			\
+	 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct pmu_event {
+	uint32_t type;
+	uint64_t config;
+} events[I960_PMU_COUNT] = {
+	[I960_PMU_INSNS]   = { PERF_TYPE_HARDWARE,
+			       PERF_COUNT_HW_INSTRUCTIONS },
+	[I960_PMU_CYCLES]  = { PERF_TYPE_HARDWARE,
+			       PERF_COUNT_HW_CPU_CYCLES },
+	[I960_PMU_BMISSES] = { PERF_TYPE_HARDWARE,
+			       PERF_COUNT_HW_BRANCH_MISSES },
+	[I960_PMU_L1I]     = { PERF_TYPE_HW_CACHE,
+			       CACHE_MISS (PERF_COUNT_HW_CACHE_L1I, READ) },
+	[I960_PMU_L1D]     = { PERF_TYPE_HW_CACHE,
+			       CACHE_MISS (PERF_COUNT_HW_CACHE_L1D, READ) },
+	[I960_PMU_ITLB]    = { PERF_TYPE_HW_CACHE,
+			       CACHE_MISS (PERF_COUNT_HW_CACHE_ITLB, READ) },
+};
+
+static int pmu_event_open (const struct pmu_event *e, int group, int single)
+{
+	struct perf_event_attr a;
+
+	memset (&a, 0, sizeof (a));
+	a.size		= sizeof (a);
+	a.type		= e->type;
+	a.config	= e->config;
+	a.disabled	= !single && group < 0;
+	a.exclude_kernel = 1;
+	a.exclude_hv	= 1;
+	a.read_format	= (single ? 0 : PERF_FORMAT_GROUP) |
+			  PERF_FORMAT_TOTAL_TIME_ENABLED |
+			  PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	return syscall (SYS_perf_event_open, &a, 0, -1, group, 0);
+}
+
+static uint64_t pmu_scale (uint64_t x, uint64_t enabled, uint64_t running)
+{
+	return running == 0 ? 0 :
+	       running < enabled ? (double) x * enabled / running : x;
+}
+
+/*
+ * Read counters scaled to the full enabled time and time each counter
+ * was running, values of counters not opened are left as is. Returns
+ * zero on failure, -1 if group was enabled but never scheduled.
+ */
+static int pmu_read (const struct i960_pmu *o, uint64_t *v, uint64_t *time)
+{
+	uint64_t b[3 + I960_PMU_COUNT];	/* nr, enabled, running, values */
+	const ssize_t head = 3 * sizeof (b[0]);
+	ssize_t len;
+	int i, k;
+
+	if (o->split) {			/* one by one: value, enabled, running */
+		for (i = 0; i < I960_PMU_COUNT; ++i)
+			if (o->fd[i] >= 0 &&
+			    read (o->fd[i], b, head) == head) {
+				v[i]    = pmu_scale (b[0], b[1], b[2]);
+				time[i] = b[2];
+			}
+
+		return 1;
+	}
+
+	if (o->group < 0 || (len = read (o->group, b, sizeof (b))) < head ||
+	    len < head + (ssize_t) (b[0] * sizeof (b[0])))
+		return 0;
+
+	if (b[1] > 0 && b[2] == 0)
+		return -1;
+
+	for (i = 0, k = 3; i < I960_PMU_COUNT; ++i)
+		if (o->fd[i] >= 0) {
+			v[i]    = pmu_scale (b[k++], b[1], b[2]);
+			time[i] = b[2];
+		}
+
+	return 1;
+}
+
+/*
+ * Group larger than free hardware counters (NMI watchdog holds one) is
+ * accepted but never scheduled. Count events one by one then, each one
+ * multiplexed and scaled on its own.
+ */
+static int pmu_split (struct i960_pmu *o)
+{
+	int i, n;
+
+	i960_pmu_close (o);
+	o->split = 1;
+
+	for (i = 0, n = 0; i < I960_PMU_COUNT; ++i)
+		n += (o->fd[i] = pmu_event_open (events + i, -1, 1)) >= 0;
+
+	return n;
+}
+
+/*
+ * All counters form one group led by the first one opened, thus kernel
+ * schedules them together and they count the same code
+ */
+int i960_pmu_open (struct i960_pmu *o)
+{
+	uint64_t v[I960_PMU_COUNT], time[I960_PMU_COUNT];
+	int i, n;
+
+	memset (o, 0, sizeof (*o));
+	o->group = -1;
+
+	for (i = 0, n = 0; i < I960_PMU_COUNT; ++i)
+		if ((o->fd[i] = pmu_event_open (events + i, o->group, 0)) >= 0 &&
+		    n++ == 0)
+			o->group = o->fd[i];
+
+	if (n == 0)
+		return 0;
+
+	ioctl (o->group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	return pmu_read (o, v, time) < 0 ? pmu_split (o) : n;
+}
+
+#else  /* no perf events */
+
+int i960_pmu_open (struct i960_pmu *o)
+{
+	int i;
+
+	memset (o, 0, sizeof (*o));
+	o->group = -1;
+
+	for (i = 0; i < I960_PMU_COUNT; ++i)
+		o->fd[i] = -1;
+
+	return 0;
+}
+
+static int pmu_read (const struct i960_pmu *o, uint64_t *v, uint64_t *time)
+{
+	return 0;
+}
+
+static int pmu_split (struct i960_pmu *o)
+{
+	return 0;
+}
+
+#endif
+
+void i960_pmu_close (struct i960_pmu *o)
+{
+	int i;
+
+	for (i = 0; i < I960_PMU_COUNT; ++i)
+		if (o->fd[i] >= 0) {
+			close (o->fd[i]);
+			o->fd[i] = -1;
+		}
+
+	o->group = -1;
+}
+
+void i960_pmu_start (struct i960_pmu *o)
+{
+	if (pmu_read (o, o->start, o->start_time) < 0 && pmu_split (o) > 0)
+		pmu_read (o, o->start, o->start_time);
+}
+
+void i960_pmu_stop (struct i960_pmu *o)
+{
+	uint64_t v[I960_PMU_COUNT], time[I960_PMU_COUNT];
+	int i, ok;
+
+	memcpy (v, o->start, sizeof (v));	/* zero delta if not read */
+	memcpy (time, o->start_time, sizeof (time));
+
+	if ((ok = pmu_read (o, v, time)) <= 0) {
+		if (ok < 0)
+			pmu_split (o);	/* lost this run, count next ones */
+
+		return;
+	}
+
+	for (i = 0; i < I960_PMU_COUNT; ++i)
+		if (o->fd[i] >= 0) {
+			o->v[i]    += v[i] - o->start[i];
+			o->time[i] += time[i] - o->start_time[i];
+		}
+}
+
+void i960_pmu_reset (struct i960_pmu *o)
+{
+	memset (o->v, 0, sizeof (o->v));
+	memset (o->time, 0, sizeof (o->time));
+}
+
+const char *i960_pmu_name (int i)
+{
+	static const char *names[I960_PMU_COUNT] = {
+		"insns", "cycles", "branch_misses", "l1i_misses",
+		"l1d_misses", "itlb_misses",
+	};
+
+	return i >= 0 && i < I960_PMU_COUNT ? names[i] : NULL;
+}
+
+void i960_pmu_report (FILE *to, const struct i960_pmu *o, uint64_t insns)
+{
+	const char *sep = "{ ";
+	int i;
+
+	for (i = 0; i < I960_PMU_COUNT; ++i, sep = ", ")
+		if (!i960_pmu_valid (o, i) || insns == 0)
+			fprintf (to, "%s\"%s\": null", sep, i960_pmu_name (i));
+		else
+			fprintf (to, "%s\"%s\": %.4f", sep, i960_pmu_name (i),
+				 (double) o->v[i] / insns);
+
+	fprintf (to, " }");
+}
@@ -0,0 +1,239 @@
+/*
+ * 80960 Emulator Sampling Profiler
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <i960-prof.h>
+
+static __thread struct i960_prof *prof_self;
+
+static void prof_sample (int sig)
+{
+	struct i960_prof *p = prof_self;
+	size_t head, tail;
+
+	if (p == NULL)
+		return;
+
+	head = p->head;
+	tail = __atomic_load_n (&p->tail, __ATOMIC_ACQUIRE);
+
+	if (head - tail > p->mask) {
+		++p->lost;
+		return;
+	}
+
+	p->ring[head & p->mask] = p->cpu->ip;
+	__atomic_store_n (&p->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static int prof_timer (unsigned hz)
+{
+	struct itimerval t;
+
+	t.it_interval.tv_sec  = 0;
+	t.it_interval.tv_usec = hz == 0 ? 0 : hz > 1000000 ? 1 : 1000000 / hz;
+	t.it_value = t.it_interval;
+
+	return setitimer (ITIMER_PROF, &t, NULL) == 0;
+}
+
+int i960_prof_start (unsigned hz)
+{
+	struct sigaction sa;
+
+	if (hz == 0) {
+		errno = EINVAL;
+		return 0;
+	}
+
+	memset (&sa, 0, sizeof (sa));
+	sa.sa_handler = prof_sample;
+	sa.sa_flags   = SA_RESTART;
+	sigemptyset (&sa.sa_mask);
+
+	if (sigaction (SIGPROF, &sa, NULL) != 0)
+		return 0;
+
+	return prof_timer (hz);
+}
+
+void i960_prof_stop (void)
+{
+	prof_timer (0);
+}
+
+int i960_prof_attach (struct i960_prof *p, struct i960 *o, size_t size)
+{
+	size_t n;
+
+	for (n = 64; n < size; n *= 2) {}
+
+	memset (p, 0, sizeof (*p));
+
+	if ((p->ring = malloc (n * sizeof (p->ring[0]))) == NULL)
+		return 0;
+
+	p->cpu  = o;
+	p->mask = n - 1;
+
+	__atomic_store_n (&prof_self, p, __ATOMIC_RELEASE);
+	return 1;
+}
+
+void i960_prof_detach (struct i960_prof *p)
+{
+	if (prof_self == p)
+		__atomic_store_n (&prof_self, NULL, __ATOMIC_RELEASE);
+
+	free (p->ring);
+	free (p->bins);
+	p->ring  = NULL;
+	p->mask  = p->head = p->tail = 0;
+	p->bins  = NULL;
+	p->nbins = p->used = 0;
+}
+
+/*
+ * Sample Histogram
+ */
+static size_t bin_hash (uint32_t ip, size_t mask)
+{
+	return ((ip >> 2) * 0x9e3779b1u) & mask;
+}
+
+static struct i960_prof_bin *bin_get (struct i960_prof *p, uint32_t ip)
+{
+	const size_t mask = p->nbins - 1;
+	size_t i;
+
+	for (i = bin_hash (ip, mask); p->bins[i].count != 0; i = (i + 1) & mask)
+		if (p->bins[i].ip == ip)
+			return p->bins + i;
+
+	p->bins[i].ip = ip;
+	++p->used;
+	return p->bins + i;
+}
+
+static int bin_grow (struct i960_prof *p)
+{
+	struct i960_prof_bin *old = p->bins;
+	const size_t n = p->nbins;
+	size_t i;
+
+	p->nbins = n == 0 ? 1024 : n * 2;
+	p->used  = 0;
+
+	if ((p->bins = calloc (p->nbins, sizeof (p->bins[0]))) == NULL) {
+		p->bins  = old;
+		p->nbins = n;
+		return 0;
+	}
+
+	for (i = 0; i < n; ++i)
+		if (old[i].count != 0)
+			bin_get (p, old[i].ip)->count = old[i].count;
+
+	free (old);
+	return 1;
+}
+
+int i960_prof_collect (struct i960_prof *p)
+{
+	const size_t head = __atomic_load_n (&p->head, __ATOMIC_ACQUIRE);
+	size_t tail;
+
+	for (tail = p->tail; tail != head; ++tail) {
+		if (p->used * 2 >= p->nbins && !bin_grow (p))
+			break;
+
+		++bin_get (p, p->ring[tail & p->mask])->count;
+	}
+
+	__atomic_store_n (&p->tail, tail, __ATOMIC_RELEASE);
+	return tail == head;
+}
+
+/*
+ * Report
+ */
+struct prof_line {
+	const struct i960_sym *sym;
+	uint32_t ip;
+	uint64_t count;
+};
+
+static int line_by_ip (const void *a, const void *b)
+{
+	const struct prof_line *x = a, *y = b;
+
+	return x->ip < y->ip ? -1 : x->ip > y->ip;
+}
+
+static int line_by_count (const void *a, const void *b)
+{
+	const struct prof_line *x = a, *y = b;
+
+	return x->count > y->count ? -1 : x->count < y->count;
+}
+
+void i960_prof_report (FILE *to, struct i960_prof *p, struct i960_syms *s)
+{
+	struct prof_line *v;
+	const struct i960_sym *sym;
+	uint64_t total = 0;
+	size_t i, m, n = 0;
+
+	i960_prof_collect (p);
+
+	if ((v = malloc ((p->used + 1) * sizeof (v[0]))) == NULL)
+		return;
+
+	for (i = 0; i < p->nbins; ++i)
+		if (p->bins[i].count != 0) {
+			v[n].ip    = p->bins[i].ip;
+			v[n].count = p->bins[i].count;
+			total += v[n++].count;
+		}
+
+	qsort (v, n, sizeof (v[0]), line_by_ip);
+
+	for (i = 0, m = n, n = 0; i < m; ++i) {  /* fold by symbol */
+		sym = s == NULL ? NULL : i960_syms_lookup (s, v[i].ip);
+
+		if (n > 0 && sym != NULL && v[n - 1].sym == sym) {
+			v[n - 1].count += v[i].count;
+			continue;
+		}
+
+		v[n] = v[i];
+		v[n++].sym = sym;
+	}
+
+	qsort (v, n, sizeof (v[0]), line_by_count);
+
+	fprintf (to, "# %llu samples, %llu lost\n",
+		 (unsigned long long) total, (unsigned long long) p->lost);
+
+	for (i = 0; i < n; ++i)
+		if (v[i].sym != NULL)
+			fprintf (to, "%10llu %6.2f%%  %s\n",
+				 (unsigned long long) v[i].count,
+				 100.0 * v[i].count / total, v[i].sym->name);
+		else
+			fprintf (to, "%10llu %6.2f%%  0x%08x\n",
+				 (unsigned long long) v[i].count,
+				 100.0 * v[i].count / total, v[i].ip);
+
+	free (v);
+}
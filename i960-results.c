@@ -0,0 +1,248 @@
+/*
+ * 80960 Emulator Benchmark Result Store
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <i960-results.h>
+
+#ifndef I960_REVISION
+#define I960_REVISION	""
+#endif
+
+#if defined (__clang__)
+#define I960_COMPILER	__VERSION__
+#elif defined (__GNUC__)
+#define I960_COMPILER	"gcc " __VERSION__
+#else
+#define I960_COMPILER	"unknown"
+#endif
+
+static void host_cpu (char *buf, size_t size)
+{
+	FILE *f;
+	char line[256], *p;
+
+	snprintf (buf, size, "unknown");
+
+	if ((f = fopen ("/proc/cpuinfo", "r")) == NULL)
+		return;
+
+	while (fgets (line, sizeof (line), f) != NULL)
+		if (strncmp (line, "model name", 10) == 0 &&
+		    (p = strchr (line, ':')) != NULL) {
+			p += strspn (p + 1, " \t") + 1;
+			p[strcspn (p, "\n")] = '\0';
+			snprintf (buf, size, "%s", p);
+			break;
+		}
+
+	fclose (f);
+}
+
+FILE *i960_results_create (const char *dir, const char *tool, char *path,
+			   size_t size)
+{
+	const char *rev = I960_REVISION[0] != '\0' ? I960_REVISION : "unknown";
+	const time_t now = time (NULL);
+	char stamp[32], cpu[128];
+	struct tm tm;
+	FILE *f;
+
+	if (mkdir (dir, 0777) != 0 && errno != EEXIST)
+		return NULL;
+
+	gmtime_r (&now, &tm);
+	strftime (stamp, sizeof (stamp), "%Y%m%d-%H%M%S", &tm);
+	snprintf (path, size, "%s/%s-%s-%s.res", dir, tool, stamp, rev);
+
+	if ((f = fopen (path, "w")) == NULL)
+		return NULL;
+
+	strftime (stamp, sizeof (stamp), "%Y-%m-%dT%H:%M:%SZ", &tm);
+	host_cpu (cpu, sizeof (cpu));
+
+	fprintf (f, "i960-results 1\ntool %s\ndate %s\ncpu %s\n"
+		    "compiler %s\nrevision %s\n",
+		 tool, stamp, cpu, I960_COMPILER, rev);
+	return f;
+}
+
+void i960_results_put (FILE *to, const char *name, const char *mode,
+		       const double *v, unsigned n)
+{
+	unsigned i;
+
+	fprintf (to, "sample %s %s", name, mode);
+
+	for (i = 0; i < n; ++i)
+		fprintf (to, " %.6g", v[i]);
+
+	fputc ('\n', to);
+}
+
+/*
+ * Reader
+ */
+static int add_sample (struct i960_results *o, char *line)
+{
+	const size_t avail = o->avail == 0 ? 16 : o->avail * 2;
+	struct i960_result *r;
+	char *name, *mode, *p, *end;
+	double *v;
+
+	if ((name = strtok_r (line, " \t\n", &p)) == NULL ||
+	    (mode = strtok_r (NULL, " \t\n", &p)) == NULL)
+		goto inval;
+
+	if (o->count == o->avail) {
+		if ((r = realloc (o->v, avail * sizeof (r[0]))) == NULL)
+			return 0;
+
+		o->v = r;
+		o->avail = avail;
+	}
+
+	r = o->v + o->count;
+	memset (r, 0, sizeof (*r));
+
+	if ((v = malloc ((strlen (p) + 1) * sizeof (v[0]))) == NULL)
+		return 0;
+
+	for (r->v = v;; ++r->n, p = end) {
+		v[r->n] = strtod (p, &end);
+
+		if (end == p)
+			break;
+	}
+
+	if (r->n == 0) {
+		free (v);
+		goto inval;
+	}
+
+	r->name = strdup (name);
+	r->mode = strdup (mode);
+
+	if (r->name == NULL || r->mode == NULL) {
+		free (r->name);
+		free (r->mode);
+		free (v);
+		return 0;
+	}
+
+	++o->count;
+	return 1;
+inval:
+	errno = EINVAL;
+	return 0;
+}
+
+static int set_field (char **field, const char *value)
+{
+	char *s;
+
+	if ((s = strdup (value)) == NULL)
+		return 0;
+
+	s[strcspn (s, "\n")] = '\0';
+	free (*field);
+	*field = s;
+	return 1;
+}
+
+static int parse_line (struct i960_results *o, char *line)
+{
+	static const struct { const char *key; size_t off; } fields[] = {
+		{ "tool ",	offsetof (struct i960_results, tool)	 },
+		{ "date ",	offsetof (struct i960_results, date)	 },
+		{ "cpu ",	offsetof (struct i960_results, cpu)	 },
+		{ "compiler ",	offsetof (struct i960_results, compiler) },
+		{ "revision ",	offsetof (struct i960_results, revision) },
+	};
+	size_t i, len;
+
+	if (strncmp (line, "sample ", 7) == 0)
+		return add_sample (o, line + 7);
+
+	for (i = 0; i < sizeof (fields) / sizeof (fields[0]); ++i) {
+		len = strlen (fields[i].key);
+
+		if (strncmp (line, fields[i].key, len) == 0)
+			return set_field ((char **) ((char *) o +
+						     fields[i].off),
+					  line + len);
+	}
+
+	return 1;				/* unknown field, skip */
+}
+
+int i960_results_load (struct i960_results *o, const char *path)
+{
+	char line[4096];
+	FILE *f;
+	int ok = 1;
+
+	memset (o, 0, sizeof (*o));
+
+	if ((f = fopen (path, "r")) == NULL)
+		return 0;
+
+	if (fgets (line, sizeof (line), f) == NULL ||
+	    strncmp (line, "i960-results 1", 14) != 0) {
+		fclose (f);
+		errno = EINVAL;
+		return 0;
+	}
+
+	while (ok && fgets (line, sizeof (line), f) != NULL)
+		ok = parse_line (o, line);
+
+	fclose (f);
+
+	if (!ok)
+		i960_results_fini (o);
+
+	return ok;
+}
+
+void i960_results_fini (struct i960_results *o)
+{
+	size_t i;
+
+	for (i = 0; i < o->count; ++i) {
+		free (o->v[i].name);
+		free (o->v[i].mode);
+		free (o->v[i].v);
+	}
+
+	free (o->v);
+	free (o->tool);
+	free (o->date);
+	free (o->cpu);
+	free (o->compiler);
+	free (o->revision);
+	memset (o, 0, sizeof (*o));
+}
+
+const struct i960_result *
+i960_results_find (const struct i960_results *o, const char *name,
+		   const char *mode)
+{
+	size_t i;
+
+	for (i = 0; i < o->count; ++i)
+		if (strcmp (o->v[i].name, name) == 0 &&
+		    strcmp (o->v[i].mode, mode) == 0)
+			return o->v + i;
+
+	return NULL;
+}
@@ -0,0 +1,157 @@
+/*
+ * 80960 Emulator Benchmark Sample Statistics
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <i960-sample.h>
+
+/*
+ * Two-sided 95% Student t quantiles for 1..30 degrees of freedom
+ */
+static double t95 (unsigned df)
+{
+	static const double t[] = {
+		12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+		 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+		 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+		 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+	};
+
+	return df == 0 ? 0.0 : df <= 30 ? t[df - 1] : 1.960;
+}
+
+void i960_sample_stat (struct i960_sample *s, const double *v, unsigned n)
+{
+	double sum = 0, sq = 0, h;
+	unsigned i;
+
+	s->n   = n;
+	s->min = n > 0 ? v[0] : 0.0;
+	s->max = s->min;
+
+	for (i = 0; i < n; ++i) {
+		sum += v[i];
+		s->min = v[i] < s->min ? v[i] : s->min;
+		s->max = v[i] > s->max ? v[i] : s->max;
+	}
+
+	s->mean = n > 0 ? sum / n : 0.0;
+
+	for (i = 0; i < n; ++i)			/* two-pass: no cancellation */
+		sq += (v[i] - s->mean) * (v[i] - s->mean);
+
+	s->sd = n < 2 ? 0.0 : sqrt (sq / (n - 1));
+	h     = n < 2 ? 0.0 : t95 (n - 1) * s->sd / sqrt (n);
+	s->lo = s->mean - h;
+	s->hi = s->mean + h;
+}
+
+static int cmp_double (const void *a, const void *b)
+{
+	const double x = *(const double *) a, y = *(const double *) b;
+
+	return x < y ? -1 : x > y;
+}
+
+double i960_sample_median (const double *v, unsigned n)
+{
+	double *x, m;
+
+	if (n == 0 || (x = malloc (n * sizeof (x[0]))) == NULL)
+		return 0.0;
+
+	memcpy (x, v, n * sizeof (x[0]));
+	qsort (x, n, sizeof (x[0]), cmp_double);
+
+	m = n & 1 ? x[n / 2] : (x[n / 2 - 1] + x[n / 2]) / 2;
+	free (x);
+	return m;
+}
+
+/*
+ * Exact P(U <= u): the number of arrangements with given U is the
+ * coefficient of q^U in Gaussian binomial [n + m, n], computed as the
+ * product of (1 - q^(m + i)) / (1 - q^i) for i = 1..n
+ */
+#define MWU_EXACT_MAX	400		/* n * m limit for exact test */
+
+static double mwu_exact_cdf (unsigned n, unsigned m, double u)
+{
+	const unsigned size = n * m + 1;
+	double c[MWU_EXACT_MAX + 1], total = 0, below = 0;
+	unsigned i, j;
+
+	memset (c, 0, size * sizeof (c[0]));
+	c[0] = 1;
+
+	for (i = 1; i <= n; ++i) {
+		for (j = size - 1; j >= m + i; --j)
+			c[j] -= c[j - (m + i)];
+
+		for (j = i; j < size; ++j)
+			c[j] += c[j - i];
+	}
+
+	for (j = 0; j < size; ++j) {
+		total += c[j];
+		below += j <= u ? c[j] : 0;
+	}
+
+	return below / total;
+}
+
+double i960_sample_mwu (const double *x, unsigned n, const double *y,
+			unsigned m)
+{
+	const unsigned N = n + m;
+	struct rank { double v; int first; } *r;
+	double r1 = 0, ties = 0, u, mu, sigma, z, p;
+	unsigned i, j, k;
+
+	if (n == 0 || m == 0 || (r = malloc (N * sizeof (r[0]))) == NULL)
+		return 1.0;
+
+	for (i = 0; i < n; ++i)
+		r[i] = (struct rank) { x[i], 1 };
+
+	for (i = 0; i < m; ++i)
+		r[n + i] = (struct rank) { y[i], 0 };
+
+	qsort (r, N, sizeof (r[0]), cmp_double);  /* v is the first field */
+
+	for (i = 0; i < N; i = j) {
+		for (j = i + 1; j < N && r[j].v == r[i].v; ++j) {}
+
+		for (k = i; k < j; ++k)		/* mid-rank of the tie group */
+			r1 += r[k].first ? (i + j + 1) / 2.0 : 0;
+
+		ties += (double) (j - i) * (j - i) * (j - i) - (j - i);
+	}
+
+	free (r);
+
+	u = r1 - n * (n + 1) / 2.0;
+
+	if (ties == 0 && n * m <= MWU_EXACT_MAX) {
+		p = mwu_exact_cdf (n, m, u);
+		p = p < 1 - mwu_exact_cdf (n, m, u - 1) ?
+		    p : 1 - mwu_exact_cdf (n, m, u - 1);
+		return 2 * p < 1 ? 2 * p : 1;
+	}
+
+	mu    = n * m / 2.0;
+	sigma = sqrt (n * m / 12.0 * ((N + 1) - ties / ((double) N * (N - 1))));
+
+	if (sigma == 0)
+		return 1.0;
+
+	z = (fabs (u - mu) - 0.5) / sigma;	/* continuity correction */
+	return z <= 0 ? 1.0 : erfc (z / sqrt (2));
+}
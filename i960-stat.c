@@ -0,0 +1,71 @@
+/*
+ * 80960 Emulator Instruction Statistics
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <i960-dasm.h>
+#include <i960-emu-stat.h>
+
+struct stat_ctx {
+	FILE *to;
+	int format, count;
+	uint64_t total;
+};
+
+static void stat_entry (struct stat_ctx *c, uint32_t op, uint32_t code,
+			int width, uint64_t n)
+{
+	const char *name = i960_dasm_name (op);
+	const double share = 100.0 * n / c->total;
+
+	if (n == 0)
+		return;
+
+	if (name == NULL)
+		name = "?";
+
+	if (c->format == I960_STAT_JSON) {
+		fprintf (c->to, c->count == 0 ? "\n" : ",\n");
+		fprintf (c->to, "\t\t{\"opcode\": \"0x%0*x\", \"name\": \"%s\", "
+				"\"count\": %llu, \"share\": %.4f}",
+			 width, code, name, (unsigned long long) n,
+			 share);
+	}
+	else
+		fprintf (c->to, "0x%0*x,%s,%llu,%.4f\n",
+			 width, code, name, (unsigned long long) n,
+			 share);
+
+	++c->count;
+}
+
+void i960_stat_dump (FILE *to, const struct i960_stat *s, int format)
+{
+	struct stat_ctx c = { to, format, 0, s->insns > 0 ? s->insns : 1 };
+	uint32_t i;
+
+	if (format == I960_STAT_JSON)
+		fprintf (to, "{\n\t\"insns\": %llu,\n\t\"ops\": [",
+			 (unsigned long long) s->insns);
+	else
+		fprintf (to, "opcode,name,count,share\n");
+
+	for (i = 0; i < 32; ++i)
+		stat_entry (&c, i << 24, i, 2, s->ctrl[i]);
+
+	for (i = 0; i < 32; ++i)
+		stat_entry (&c, (0x20 | i) << 24, 0x20 | i, 2, s->cobr[i]);
+
+	for (i = 0; i < 1024; ++i)
+		stat_entry (&c, (0x40 | i >> 4) << 24 | (i & 15) << 7,
+			    0x400 | i, 3, s->reg[i]);
+
+	for (i = 0; i < 128; ++i)
+		stat_entry (&c, (0x80 | i) << 24, 0x80 | i, 2, s->mem[i]);
+
+	if (format == I960_STAT_JSON)
+		fprintf (to, "\n\t]\n}\n");
+}
@@ -0,0 +1,95 @@
+/*
+ * 80960 Emulator Instruction Fetch and Decode
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * 00..1F  CTRL		40..7F  REG		80..FF  MEM
+ * 20..3F  COBR
+ */
+
+#include <i960-decode.h>
+#include <i960-emu.h>
+#include <i960-emu-alog.h>
+#include <i960-emu-bits.h>
+#include <i960-emu-faults.h>
+#include <i960-emu-ops.h>
+#include <i960-trace.h>
+
+/*
+ * MEM Format Effective Address
+ *
+ * 0000  offset			0100  (abase)		1100  disp
+ * 1000  offset (abase)		0101  disp + 8 (ip)	1101  disp (abase)
+ *				0110  -			1110  disp [index]
+ *				0111  (abase) [index]	1111  disp (abase) [index]
+ */
+static int mem_efa (struct i960 *o, const struct i960_insn *in, uint32_t ip,
+		    uint32_t *efa)
+{
+	const uint32_t abase = o->r[in->val[1]];
+	const uint32_t index = o->r[in->val[0]] << in->scale;
+	const uint32_t disp  = in->disp;
+
+	switch (in->mode) {
+	case 0x0:  *efa = disp;			break;
+	case 0x4:  *efa = abase;		break;
+	case 0x5:  *efa = ip + 8 + disp;	break;
+	case 0x7:  *efa = abase + index;	break;
+	case 0x8:  *efa = abase + disp;		break;
+	case 0xC:  *efa = disp;			break;
+	case 0xD:  *efa = abase + disp;		break;
+	case 0xE:  *efa = index + disp;		break;
+	case 0xF:  *efa = abase + index + disp;	break;
+	default:   return 0;
+	}
+
+	return 1;
+}
+
+static void step_mem (struct i960 *o, const struct i960_insn *in, uint32_t ip)
+{
+	uint32_t efa;
+
+	if (mem_efa (o, in, ip, &efa))
+		mem_op (o, in->op, efa, in->val[2]);
+	else
+		i960_on_undef (o);
+}
+
+/*
+ * Instruction Entry Point
+ */
+void i960_step (struct i960 *o)
+{
+	const uint32_t ip = o->ip;
+	const uint32_t op = i960_read_w (o, ip);
+	const int      L  = i960_insn_len (op) == 8;
+	const uint32_t disp = L ? i960_read_w (o, ip + 4) : 0;
+	struct i960_insn in;
+
+	i960_alog_fetch (o, ip, op);
+	i960_trace_begin (o, ip, op, disp);
+
+	o->ip = ip + i960_decode (&in, op, disp);
+
+	switch (in.format) {
+	case I960_FMT_CTRL:  i960_ctrl (o, &in, ip);	break;	/* 00..1F */
+	case I960_FMT_COBR:  i960_cobr (o, &in, ip);	break;	/* 20..3F */
+	case I960_FMT_REG:   i960_reg  (o, &in);	break;	/* 40..7F */
+	default:             step_mem  (o, &in, ip);		/* 80..FF */
+	}
+
+	i960_trace_end (o);
+}
+
+uint64_t i960_run (struct i960 *o, uint32_t stop, uint64_t limit)
+{
+	uint64_t n;
+
+	for (n = 0; n < limit && o->ip != stop; ++n)
+		i960_step (o);
+
+	return n;
+}
@@ -0,0 +1,218 @@
+/*
+ * 80960 Emulator String and Block Operations
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * 603  cmpstr	src1, src2, len	-- compare bytes, set condition code
+ * 604  movqstr	dst, src, len	-- copy bytes, regions must not overlap
+ * 605  movstr	dst, src, len	-- copy bytes, regions may overlap
+ * 617  fill	dst, value, len	-- byte at A gets byte A mod 4 of value
+ *
+ * Block in host-backed RAM is processed in one go by host memmove,
+ * memcmp and memset. Other memory and logged accesses are walked in
+ * chunks through a bounded buffer.
+ *
+ * Instruction completes in one step and leaves its operand registers
+ * intact as any other REG instruction does: emulator takes no interrupts
+ * in the middle of instruction, thus there is no partial progress to
+ * keep.
+ */
+
+#include <string.h>
+
+#include <i960-emu.h>
+#include <i960-emu-acct.h>
+#include <i960-emu-alog.h>
+#include <i960-emu-bits.h>
+#include <i960-emu-compare.h>
+#include <i960-emu-faults.h>
+#include <i960-emu-ops.h>
+#include <i960-emu-stat.h>
+
+#define STR_CHUNK	256
+
+static inline void *
+str_map (struct i960 *o, uint32_t addr, uint32_t size, int write)
+{
+	if (o->alog != NULL || addr + size < addr)
+		return NULL;
+
+	return i960_map (o, addr, size, write);
+}
+
+/*
+ * Chunk Transfer with Logged Memory Access
+ */
+static void str_load (struct i960 *o, uint32_t addr, uint8_t *p, uint32_t n)
+{
+	uint32_t i, x;
+
+	for (i = 0; i < n;)
+		if ((addr + i) % 4 == 0 && n - i >= 4) {
+			x = i960_read_w (o, addr + i);
+			i960_alog (o, I960_ACC_LOAD, addr + i, 4, x);
+
+			p[i + 0] = x;
+			p[i + 1] = x >> 8;
+			p[i + 2] = x >> 16;
+			p[i + 3] = x >> 24;
+			i += 4;
+		}
+		else {
+			p[i] = x = i960_read_b (o, addr + i);
+			i960_alog (o, I960_ACC_LOAD, addr + i, 1, x);
+			++i;
+		}
+}
+
+static void
+str_store (struct i960 *o, uint32_t addr, const uint8_t *p, uint32_t n)
+{
+	uint32_t i, x;
+
+	for (i = 0; i < n;)
+		if ((addr + i) % 4 == 0 && n - i >= 4) {
+			x = p[i] | p[i + 1] << 8 | p[i + 2] << 16 |
+			    (uint32_t) p[i + 3] << 24;
+
+			i960_alog (o, I960_ACC_STORE, addr + i, 4, x);
+			i960_write_w (o, addr + i, x);
+			i += 4;
+		}
+		else {
+			i960_alog (o, I960_ACC_STORE, addr + i, 1, p[i]);
+			i960_write_b (o, addr + i, p[i]);
+			++i;
+		}
+}
+
+static inline uint32_t str_chunk (uint32_t len)
+{
+	return len < STR_CHUNK ? len : STR_CHUNK;
+}
+
+/*
+ * Byte sign of first difference to condition code: less, equal, greater
+ */
+static inline uint32_t str_cond (int diff)
+{
+	return diff < 0 ? 4 : diff == 0 ? 2 : 1;
+}
+
+static void str_cmp (struct i960 *o, uint32_t x, uint32_t y, uint32_t len)
+{
+	const void *p, *q;
+	uint8_t a[STR_CHUNK], b[STR_CHUNK];
+	uint32_t n;
+	int diff = 0;
+
+	i960_stat_string (o, len);
+
+	if ((p = str_map (o, x, len, 0)) != NULL &&
+	    (q = str_map (o, y, len, 0)) != NULL)
+		diff = memcmp (p, q, len);
+	else
+		for (; len > 0 && diff == 0; x += n, y += n, len -= n) {
+			n = str_chunk (len);
+
+			str_load (o, x, a, n);
+			str_load (o, y, b, n);
+
+			diff = memcmp (a, b, n);
+		}
+
+	i960_set_cond (o, str_cond (diff));
+}
+
+/*
+ * Overlapping copy to higher address goes backward from the end of block
+ */
+static void str_move (struct i960 *o, uint32_t dst, uint32_t src, uint32_t len,
+		      int overlap)
+{
+	const int back = overlap && dst != src && dst - src < len;
+	uint32_t n, at;
+	const void *q;
+	void *p;
+	uint8_t buf[STR_CHUNK];
+
+	i960_stat_string (o, len);
+
+	if ((p = str_map (o, dst, len, 1)) != NULL &&
+	    (q = str_map (o, src, len, 0)) != NULL) {
+		memmove (p, q, len);
+		return;
+	}
+
+	for (at = 0; len > 0; len -= n) {
+		n = str_chunk (len);
+
+		if (back)
+			at = len - n;
+
+		str_load  (o, src + at, buf, n);
+		str_store (o, dst + at, buf, n);
+
+		if (!back)
+			at += n;
+	}
+}
+
+/*
+ * Fill n bytes at address addr with value pattern: first word is placed
+ * by bytes, then pattern doubles while it fits
+ */
+static void str_pattern (uint8_t *p, uint32_t addr, uint32_t x, uint32_t n)
+{
+	uint32_t i;
+
+	for (i = 0; i < n && i < 4; ++i)
+		p[i] = x >> ((addr + i) % 4 * 8);
+
+	for (; i < n; i *= 2)
+		memcpy (p + i, p, n - i < i ? n - i : i);
+}
+
+static void str_fill (struct i960 *o, uint32_t dst, uint32_t x, uint32_t len)
+{
+	uint8_t buf[STR_CHUNK];
+	uint32_t n;
+	void *p;
+
+	i960_stat_string (o, len);
+
+	if ((p = str_map (o, dst, len, 1)) != NULL) {
+		if (x == (x & 0xff) * 0x01010101)
+			memset (p, x, len);
+		else
+			str_pattern (p, dst, x, len);
+
+		return;
+	}
+
+	for (; len > 0; dst += n, len -= n) {
+		n = str_chunk (len);
+
+		str_pattern (buf, dst, x, n);
+		str_store (o, dst, buf, n);
+	}
+}
+
+void i960_string (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c)
+{
+	const uint32_t i = u32_extract (op, 24, 1) << 4 | u32_extract (op, 7, 4);
+
+	i960_acct_enter (o, I960_ACCT_MEM);
+
+	switch (i) {
+	case 0x03:  str_cmp  (o, a, b, o->r[c]);	break;
+	case 0x04:  str_move (o, a, b, o->r[c], 0);	break;
+	case 0x05:  str_move (o, a, b, o->r[c], 1);	break;
+	case 0x17:  str_fill (o, a, b, o->r[c]);	break;
+	default:    i960_on_undef (o);
+	}
+
+	i960_acct_leave (o);
+}
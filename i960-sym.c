@@ -0,0 +1,111 @@
+/*
+ * 80960 Guest Symbol Table
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <i960-sym.h>
+
+void i960_syms_init (struct i960_syms *o)
+{
+	o->v      = NULL;
+	o->count  = 0;
+	o->avail  = 0;
+	o->sorted = 1;
+}
+
+void i960_syms_fini (struct i960_syms *o)
+{
+	size_t i;
+
+	for (i = 0; i < o->count; ++i)
+		free (o->v[i].name);
+
+	free (o->v);
+}
+
+int i960_syms_add (struct i960_syms *o, uint32_t addr, const char *name)
+{
+	const size_t avail = o->avail == 0 ? 64 : o->avail * 2;
+	struct i960_sym *v;
+	char *copy;
+
+	if (o->count == o->avail) {
+		if ((v = realloc (o->v, avail * sizeof (v[0]))) == NULL)
+			return 0;
+
+		o->v     = v;
+		o->avail = avail;
+	}
+
+	if ((copy = strdup (name)) == NULL)
+		return 0;
+
+	if (o->count > 0 && o->v[o->count - 1].addr > addr)
+		o->sorted = 0;
+
+	o->v[o->count].addr = addr;
+	o->v[o->count].name = copy;
+	++o->count;
+	return 1;
+}
+
+int i960_syms_load (struct i960_syms *o, const char *path)
+{
+	FILE *f;
+	char line[256], a[16], b[200], c[200];
+	unsigned long addr;
+	int n, ok = 1;
+
+	if ((f = fopen (path, "r")) == NULL)
+		return 0;
+
+	while (ok && fgets (line, sizeof (line), f) != NULL) {
+		n = sscanf (line, "%15s %199s %199s", a, b, c);
+
+		if (n < 2 || sscanf (a, "%lx", &addr) != 1)
+			continue;
+
+		ok = i960_syms_add (o, addr, n == 3 ? c : b);
+	}
+
+	if (ferror (f))
+		ok = 0;
+
+	fclose (f);
+	return ok;
+}
+
+static int sym_cmp (const void *a, const void *b)
+{
+	const struct i960_sym *x = a, *y = b;
+
+	return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+const struct i960_sym *i960_syms_lookup (struct i960_syms *o, uint32_t addr)
+{
+	size_t lo = 0, hi = o->count, mid;
+
+	if (!o->sorted) {
+		qsort (o->v, o->count, sizeof (o->v[0]), sym_cmp);
+		o->sorted = 1;
+	}
+
+	while (lo < hi) {		/* find first symbol above addr */
+		mid = (lo + hi) / 2;
+
+		if (o->v[mid].addr <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo == 0 ? NULL : o->v + lo - 1;
+}
@@ -0,0 +1,402 @@
+/*
+ * 80960 Emulator Instruction Timing Model
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Costs are cycle estimates for zero wait state memory taken from the
+ * part datasheets, good enough for sizing, not for cycle exact timing.
+ * Cycle count is computed from retired instruction counters after run,
+ * thus model costs nothing on the execution path.
+ */
+
+#include <string.h>
+#include <strings.h>
+
+#include <i960-dasm.h>
+#include <i960-timing.h>
+
+#define T(c)	[I960_T_##c]
+
+#define K_COSTS							\
+	T(UNDEF) = 50,	T(ALU) = 1,	T(MOVE) = 2,	T(SYS) = 10,	\
+	T(MUL) = 18,	T(DIV) = 37,	T(EMUL) = 20,	T(EDIV) = 38,	\
+	T(ATOMIC) = 12,	T(BRANCH) = 2,	T(BAL) = 2,	T(CALL) = 9,	\
+	T(RET) = 7,	T(CALLS) = 30,	T(STRING) = 10
+
+#define K_BUS32							\
+	T(LD1) = 3,	T(LD2) = 4,	T(LD3) = 5,	T(LD4) = 6,	\
+	T(ST1) = 3,	T(ST2) = 4,	T(ST3) = 5,	T(ST4) = 6
+
+#define K_BUS16							\
+	T(LD1) = 4,	T(LD2) = 6,	T(LD3) = 8,	T(LD4) = 10,	\
+	T(ST1) = 4,	T(ST2) = 6,	T(ST3) = 8,	T(ST4) = 10
+
+#define K_FPU								\
+	T(FADD) = 10,	T(FMUL) = 18,	T(FDIV) = 35,	T(FSQRT) = 104,	\
+	T(FMISC) = 6,	T(FTRANS) = 300
+
+static const struct i960_timing timing[I960_VARIANTS] = {
+	[I960_KA] = {
+		"ka", I960_F_KS, 4, 2, 20, 20,
+		{ K_COSTS, K_BUS32 },
+	},
+	[I960_KB] = {
+		"kb", I960_F_KS | I960_F_FPU, 4, 2, 20, 20,
+		{ K_COSTS, K_BUS32, K_FPU },
+	},
+	[I960_SA] = {
+		"sa", I960_F_KS, 4, 2, 36, 36,
+		{ K_COSTS, K_BUS16 },
+	},
+	[I960_SB] = {
+		"sb", I960_F_KS | I960_F_FPU, 4, 2, 36, 36,
+		{ K_COSTS, K_BUS16, K_FPU },
+	},
+	[I960_CA] = {
+		"ca", I960_F_C | I960_F_CJ, 5, 1, 16, 16,
+		{
+			T(UNDEF) = 40,	T(ALU) = 1,	T(MOVE) = 1,
+			T(SYS) = 8,	T(MUL) = 5,	T(DIV) = 35,
+			T(EMUL) = 5,	T(EDIV) = 36,	T(LD1) = 2,
+			T(LD2) = 2,	T(LD3) = 3,	T(LD4) = 3,
+			T(ST1) = 2,	T(ST2) = 2,	T(ST3) = 3,
+			T(ST4) = 3,	T(ATOMIC) = 8,	T(BRANCH) = 1,
+			T(BAL) = 1,	T(CALL) = 4,	T(RET) = 4,
+			T(CALLS) = 15,	T(STRING) = 8,
+		},
+	},
+	[I960_JF] = {
+		"jf", I960_F_CJ | I960_F_J, 8, 2, 18, 18,
+		{
+			T(UNDEF) = 40,	T(ALU) = 1,	T(MOVE) = 1,
+			T(SYS) = 8,	T(MUL) = 5,	T(DIV) = 37,
+			T(EMUL) = 5,	T(EDIV) = 37,	T(LD1) = 2,
+			T(LD2) = 3,	T(LD3) = 4,	T(LD4) = 4,
+			T(ST1) = 2,	T(ST2) = 3,	T(ST3) = 4,
+			T(ST4) = 4,	T(ATOMIC) = 10,	T(BRANCH) = 1,
+			T(BAL) = 1,	T(CALL) = 5,	T(RET) = 5,
+			T(CALLS) = 18,	T(STRING) = 8,
+		},
+	},
+	[I960_HD] = {
+		"hd", I960_F_CJ | I960_F_J, 16, 2, 24, 24,
+		{
+			T(UNDEF) = 40,	T(ALU) = 1,	T(MOVE) = 1,
+			T(SYS) = 8,	T(MUL) = 3,	T(DIV) = 23,
+			T(EMUL) = 3,	T(EDIV) = 23,	T(LD1) = 3,
+			T(LD2) = 4,	T(LD3) = 5,	T(LD4) = 5,
+			T(ST1) = 3,	T(ST2) = 4,	T(ST3) = 5,
+			T(ST4) = 5,	T(ATOMIC) = 12,	T(BRANCH) = 1,
+			T(BAL) = 1,	T(CALL) = 5,	T(RET) = 5,
+			T(CALLS) = 18,	T(STRING) = 8,
+		},
+	},
+};
+
+const struct i960_timing *i960_timing (int variant)
+{
+	if (variant < 0 || variant >= I960_VARIANTS)
+		return NULL;
+
+	return timing + variant;
+}
+
+const struct i960_timing *i960_timing_find (const char *name)
+{
+	int i;
+
+	if (strncmp (name, "80960", 5) == 0)
+		name += 5;
+
+	for (i = 0; i < I960_VARIANTS; ++i)
+		if (strcasecmp (name, timing[i].name) == 0)
+			return timing + i;
+
+	return NULL;
+}
+
+/*
+ * Instruction Classification
+ */
+static enum i960_tclass mem_class (uint32_t i, unsigned *need)
+{
+	static const enum i960_tclass ld[8] = {
+		I960_T_LD1, I960_T_LD1, I960_T_LD1, I960_T_LD2,
+		I960_T_LD3, I960_T_LD3, I960_T_LD4, I960_T_LD4,
+	};
+	static const enum i960_tclass st[8] = {
+		I960_T_ST1, I960_T_ST1, I960_T_ST1, I960_T_ST2,
+		I960_T_ST3, I960_T_ST3, I960_T_ST4, I960_T_ST4,
+	};
+
+	switch (i) {
+	case 0x04:  return I960_T_BRANCH;		/* bx		*/
+	case 0x05:  return I960_T_BAL;			/* balx		*/
+	case 0x06:  return I960_T_CALL;			/* callx	*/
+	case 0x0c:  return I960_T_ALU;			/* lda		*/
+	case 0x2c:  *need = I960_F_J; return I960_T_SYS;  /* dcinva	*/
+	}
+
+	return (i & 2) ? st[(i >> 3) & 7] : ld[(i >> 3) & 7];
+}
+
+static enum i960_tclass fpu_class (uint32_t f)		/* 68x, 69x */
+{
+	switch (f) {
+	case 0x3:  return I960_T_FDIV;			/* remr		*/
+	case 0x4:
+	case 0x5:  return I960_T_FADD;			/* cmpor, cmpr	*/
+	case 0x8:  return I960_T_FSQRT;
+	case 0xa:
+	case 0xb:
+	case 0xf:  return I960_T_FMISC;			/* logbn, round	*/
+	}
+
+	return I960_T_FTRANS;
+}
+
+static enum i960_tclass reg_class (uint32_t i, unsigned *need)
+{
+	const uint32_t f = i & 0xf;
+
+	switch (i >> 4) {
+	case 0x19:
+		if ((f & 0xc) == 0x4)
+			*need = I960_F_J;		/* cmpob..cmpis	*/
+		return I960_T_ALU;
+	case 0x1a:
+		if (f == 0xd)
+			*need = I960_F_J;		/* bswap	*/
+		return I960_T_ALU;
+	case 0x1b:
+		if (f & 4)
+			*need = I960_F_J;		/* intdis/inten	*/
+		return f & 4 ? I960_T_SYS : I960_T_ALU;
+	case 0x1c: case 0x1d: case 0x1e: case 0x1f:
+		if (f == 0x8) {
+			*need = I960_F_CJ;		/* eshro	*/
+			return I960_T_ALU;
+		}
+		return i == 0x1cc ? I960_T_ALU : I960_T_MOVE;
+	case 0x20:
+		if (f >= 3)
+			return I960_T_STRING;
+		*need = I960_F_KS;			/* synmov	*/
+		return I960_T_ATOMIC;
+	case 0x21:
+		return f == 0x7 ? I960_T_STRING :
+		       f == 0x0 || f == 0x2 ? I960_T_ATOMIC : I960_T_UNDEF;
+	case 0x23:
+		*need = I960_F_C;			/* sdma/udma	*/
+		return I960_T_SYS;
+	case 0x24:
+		if (f >= 2 && f <= 4)
+			*need = I960_F_KS;		/* decimal ops	*/
+		return f == 5 ? I960_T_SYS   :
+		       f == 6 ? I960_T_UNDEF : I960_T_ALU;	/* condrec: MC	*/
+	case 0x25:
+		if (f == 0x9)
+			*need = I960_F_CJ;		/* sysctl	*/
+		else if (f >= 8)
+			*need = I960_F_J;		/* intctl, ...	*/
+		return f <  2 ? I960_T_ALU   :
+		       f == 6 ? I960_T_UNDEF : I960_T_SYS;	/* receive: MC	*/
+	case 0x26:
+		return f == 0 ? I960_T_CALLS : f < 0xb ? I960_T_UNDEF :
+		       I960_T_SYS;
+	case 0x27:
+		if (f < 4)
+			return f == 0 ? I960_T_EMUL : f == 1 ? I960_T_EDIV :
+			       I960_T_UNDEF;		/* ldtime: MC	*/
+		*need = I960_F_FPU;
+		return I960_T_FMISC;
+	case 0x28: case 0x29:
+		*need = I960_F_FPU;
+		return fpu_class (f);
+	case 0x2c: case 0x2d: case 0x2e:
+		*need = I960_F_FPU;
+		return I960_T_FMISC;
+	case 0x30: case 0x34:
+		return f == 1 ? I960_T_MUL : I960_T_DIV;
+	case 0x38: case 0x39:
+		if (f > 4) {
+			*need = I960_F_FPU;
+			return f == 0xb ? I960_T_FDIV :
+			       f == 0xc ? I960_T_FMUL : I960_T_FADD;
+		}
+		/* fall through */
+	case 0x3a: case 0x3b: case 0x3c: case 0x3d: case 0x3e: case 0x3f:
+		*need = I960_F_J;			/* addcc, selcc	*/
+		return I960_T_ALU;
+	}
+
+	return I960_T_ALU;
+}
+
+static enum i960_tclass op_class (uint32_t op, unsigned *need)
+{
+	const uint32_t line = (op >> 28) & 15;
+	const uint32_t i = (op >> 24) & 0x1f;
+
+	if (line >= 8)
+		return mem_class ((op >> 24) & 127, need);
+
+	if (line >= 4)
+		return reg_class (i960_stat_reg_index (op), need);
+
+	if (line >= 2)
+		return i < 8 ? I960_T_ALU : I960_T_BRANCH;
+
+	switch (i) {
+	case 0x09:  return I960_T_CALL;
+	case 0x0a:  return I960_T_RET;
+	case 0x0b:  return I960_T_BAL;
+	}
+
+	return I960_T_BRANCH;
+}
+
+enum i960_tclass i960_timing_class (const struct i960_timing *t, uint32_t op)
+{
+	unsigned need = 0;
+	enum i960_tclass c;
+
+	if (i960_dasm_name (op) == NULL)
+		return I960_T_UNDEF;
+
+	c = op_class (op, &need);
+
+	if ((t->features & need) != need)
+		return I960_T_UNDEF;
+
+	return c;
+}
+
+void i960_timing_attach (struct i960 *o, struct i960_stat *s,
+			 const struct i960_timing *t)
+{
+	s->frames = t->frames;
+	s->cached = 0;
+	o->stat   = s;
+}
+
+/*
+ * Cycle Estimation
+ */
+struct timing_sum {
+	uint64_t count[I960_T_COUNT];
+	uint64_t cycles[I960_T_COUNT];
+};
+
+static void timing_add (struct timing_sum *sum, const struct i960_timing *t,
+			uint32_t op, uint64_t n)
+{
+	enum i960_tclass c;
+
+	if (n == 0)
+		return;
+
+	c = i960_timing_class (t, op);
+
+	sum->count[c]  += n;
+	sum->cycles[c] += n * t->cost[c];
+}
+
+/*
+ * String operations pay setup cost per instruction and one word load and
+ * store per four bytes covered
+ */
+static uint64_t timing_string (const struct i960_stat *s,
+			       const struct i960_timing *t)
+{
+	const unsigned word = t->cost[I960_T_LD1] + t->cost[I960_T_ST1];
+
+	return (s->strbytes + 3) / 4 * word;
+}
+
+static void timing_sum (struct timing_sum *sum, const struct i960_stat *s,
+			const struct i960_timing *t)
+{
+	uint32_t i;
+
+	memset (sum, 0, sizeof (*sum));
+
+	for (i = 0; i < 32; ++i)
+		timing_add (sum, t, i << 24, s->ctrl[i]);
+
+	for (i = 0; i < 32; ++i)
+		timing_add (sum, t, (0x20 | i) << 24, s->cobr[i]);
+
+	for (i = 0; i < 1024; ++i)
+		timing_add (sum, t, (0x40 | i >> 4) << 24 | (i & 15) << 7,
+			    s->reg[i]);
+
+	for (i = 0; i < 128; ++i)
+		timing_add (sum, t, (0x80 | i) << 24, s->mem[i]);
+
+	sum->cycles[I960_T_STRING] += timing_string (s, t);
+}
+
+static uint64_t timing_extra (const struct i960_stat *s,
+			      const struct i960_timing *t)
+{
+	return s->taken * t->taken + s->spills * t->spill + s->fills * t->fill;
+}
+
+uint64_t i960_cycles (const struct i960_stat *s, const struct i960_timing *t)
+{
+	struct timing_sum sum;
+	uint64_t total = timing_extra (s, t);
+	int i;
+
+	timing_sum (&sum, s, t);
+
+	for (i = 0; i < I960_T_COUNT; ++i)
+		total += sum.cycles[i];
+
+	return total;
+}
+
+void i960_timing_report (FILE *to, const struct i960_stat *s,
+			 const struct i960_timing *t)
+{
+	static const char *const name[I960_T_COUNT] = {
+		"undefined",	"alu",		"move",		"system",
+		"mul",		"div",		"emul",		"ediv",
+		"load-1",	"load-2",	"load-3",	"load-4",
+		"store-1",	"store-2",	"store-3",	"store-4",
+		"atomic",	"branch",	"bal",		"call",
+		"ret",		"calls",	"fp-add",	"fp-mul",
+		"fp-div",	"fp-sqrt",	"fp-misc",	"fp-trans",
+		"string",
+	};
+	struct timing_sum sum;
+	const uint64_t total = i960_cycles (s, t);
+	int i;
+
+	timing_sum (&sum, s, t);
+
+	fprintf (to, "# 80960%s: %llu instructions, %llu cycles, CPI %.3f\n",
+		 t->name, (unsigned long long) s->insns,
+		 (unsigned long long) total,
+		 s->insns == 0 ? 0.0 : (double) total / s->insns);
+
+	for (i = 0; i < I960_T_COUNT; ++i)
+		if (sum.count[i] > 0)
+			fprintf (to, "%-12s %14llu %14llu %6.2f%%\n", name[i],
+				 (unsigned long long) sum.count[i],
+				 (unsigned long long) sum.cycles[i],
+				 100.0 * sum.cycles[i] / total);
+
+	fprintf (to, "%-12s %14llu %14llu\n", "taken",
+		 (unsigned long long) s->taken,
+		 (unsigned long long) s->taken * t->taken);
+	fprintf (to, "%-12s %14llu %14llu\n", "spills",
+		 (unsigned long long) s->spills,
+		 (unsigned long long) s->spills * t->spill);
+	fprintf (to, "%-12s %14llu %14llu\n", "fills",
+		 (unsigned long long) s->fills,
+		 (unsigned long long) s->fills * t->fill);
+}
@@ -0,0 +1,161 @@
+/*
+ * 80960 Emulator Live Statistics Monitor
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <dirent.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <i960-live.h>
+
+#define MAX_PAGES	256
+
+struct instance {
+	char name[NAME_MAX + 2];
+	uint64_t v[I960_LIVE_COUNTERS];		/* previous sample	*/
+	int seen;
+};
+
+static struct instance pages[MAX_PAGES];
+static size_t npages;
+
+static int sample (const char *name, uint64_t *v, unsigned *threads)
+{
+	struct i960_live o;
+	const struct i960_live_slot *s;
+	uint32_t i, n;
+	int k;
+
+	if (!i960_live_map (&o, name))
+		return 0;
+
+	memset (v, 0, I960_LIVE_COUNTERS * sizeof (v[0]));
+
+	n = __atomic_load_n (&o.page->used, __ATOMIC_RELAXED);
+	n = n < o.page->nslots ? n : o.page->nslots;
+
+	for (i = 0; i < n; ++i)
+		for (s = o.page->slot + i, k = 0; k < I960_LIVE_COUNTERS; ++k)
+			v[k] += i960_live_get (s, k);
+
+	*threads = n;
+	i960_live_close (&o);
+	return 1;
+}
+
+static struct instance *instance (const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < npages; ++i)
+		if (strcmp (pages[i].name, name) == 0)
+			return pages + i;
+
+	if (npages == MAX_PAGES)
+		return NULL;
+
+	snprintf (pages[npages].name, sizeof (pages[0].name), "%s", name);
+	return pages + npages++;
+}
+
+static double ratio (uint64_t a, uint64_t b)
+{
+	return b == 0 ? 0.0 : 100.0 * a / b;
+}
+
+static void show (struct instance *p, const char *name, double dt)
+{
+	uint64_t v[I960_LIVE_COUNTERS], d[I960_LIVE_COUNTERS];
+	unsigned threads;
+	int k;
+
+	if (!sample (name, v, &threads))
+		return;
+
+	for (k = 0; k < I960_LIVE_COUNTERS; ++k)
+		d[k] = p->seen ? v[k] - p->v[k] : 0;
+
+	printf ("%-16s %3u %14llu %9.2f %6.2f%% %10.0f %8llu %10llu\n",
+		name + 1, threads,
+		(unsigned long long) v[I960_LIVE_INSNS],
+		d[I960_LIVE_INSNS] / dt / 1e6,
+		ratio (d[I960_LIVE_TAKEN], d[I960_LIVE_INSNS]),
+		(d[I960_LIVE_SPILLS] + d[I960_LIVE_FILLS]) / dt,
+		(unsigned long long) v[I960_LIVE_FAULTS],
+		(unsigned long long) v[I960_LIVE_MMIO]);
+
+	memcpy (p->v, v, sizeof (v));
+	p->seen = 1;
+}
+
+static void show_all (int argc, char *argv[], double dt)
+{
+	struct instance *p;
+	struct dirent *de;
+	char name[NAME_MAX + 2];
+	DIR *d;
+	int i;
+
+	printf ("%-16s %3s %14s %9s %7s %10s %8s %10s\n",
+		"instance", "thr", "insns", "MIPS", "taken", "frames/s",
+		"faults", "mmio");
+
+	for (i = 0; i < argc; ++i) {
+		snprintf (name, sizeof (name), "%s%s",
+			  argv[i][0] == '/' ? "" : "/", argv[i]);
+
+		if ((p = instance (name)) != NULL)
+			show (p, name, dt);
+	}
+
+	if (argc > 0 || (d = opendir ("/dev/shm")) == NULL)
+		return;
+
+	while ((de = readdir (d)) != NULL)
+		if (strncmp (de->d_name, "i960-", 5) == 0) {
+			snprintf (name, sizeof (name), "/%s", de->d_name);
+
+			if ((p = instance (name)) != NULL)
+				show (p, name, dt);
+		}
+
+	closedir (d);
+}
+
+int main (int argc, char *argv[])
+{
+	unsigned interval = 1, count = 0, i;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "i:n:")) != -1)
+		switch (opt) {
+		case 'i':  interval = atoi (optarg);  break;
+		case 'n':  count    = atoi (optarg);  break;
+		default:
+			fprintf (stderr, "usage:\n\ti960-top [-i seconds] "
+					 "[-n count] [instance ...]\n");
+			return 1;
+		}
+
+	if (interval == 0)
+		interval = 1;
+
+	for (i = 0; count == 0 || i < count; ++i) {
+		if (i > 0) {
+			sleep (interval);
+			putchar ('\n');
+		}
+
+		show_all (argc - optind, argv + optind, interval);
+		fflush (stdout);
+	}
+
+	return 0;
+}
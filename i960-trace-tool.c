@@ -0,0 +1,131 @@
+/*
+ * 80960 Emulator Binary Execution Trace Dump
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <i960-dasm.h>
+#include <i960-trace.h>
+
+static const char *reg_name (unsigned i)
+{
+	static const char *const regs[I960_TRACE_REGS] = {
+		"pfp", "sp",  "rip", "r3",  "r4",  "r5",  "r6",  "r7",
+		"r8",  "r9",  "r10", "r11", "r12", "r13", "r14", "r15",
+		"g0",  "g1",  "g2",  "g3",  "g4",  "g5",  "g6",  "g7",
+		"g8",  "g9",  "g10", "g11", "g12", "g13", "g14", "fp",
+		"ac",  "pc",  "tc",
+	};
+
+	return regs[i];
+}
+
+static void dump (FILE *to, const struct i960_trace_rec *rec)
+{
+	static const char *const kinds[] = {
+		"fetch", "ld", "st", "icctl", "dcctl", "dcinva",
+	};
+	const struct i960_access *a;
+	unsigned i;
+
+	if (rec->gap)
+		fprintf (to, "\t...\n");
+
+	fprintf (to, "%08x:\t", rec->ip);
+	i960_dasm (to, rec->ip, rec->op, rec->disp);
+	fputc ('\n', to);
+
+	for (i = 0; i < I960_TRACE_REGS; ++i)
+		if ((rec->regs >> i) & 1)
+			fprintf (to, "\t\t%s = %08x\n", reg_name (i), rec->r[i]);
+
+	for (i = 0; i < rec->nmem; ++i) {
+		a = rec->mem + i;
+
+		fprintf (to, "\t\t%s%u [%08x] = %08x\n",
+			 a->kind < 6 ? kinds[a->kind] : "?", a->size,
+			 a->addr, a->value);
+	}
+}
+
+static int usage (void)
+{
+	fprintf (stderr, "usage:\n"
+		 "\ti960-trace <trace> [<first> [<count>]]\n"
+		 "\ti960-trace <trace> write <addr> <before>\n"
+		 "\ti960-trace <trace> ip <ip> <from>\n");
+	return 1;
+}
+
+static int query (struct i960_trace_reader *r, int argc, char *argv[])
+{
+	struct i960_trace_rec rec;
+	uint64_t first, count;
+	int ret;
+
+	if (argc == 3 && strcmp (argv[0], "write") == 0) {
+		ret = i960_trace_last_write (r, strtoul (argv[1], NULL, 0),
+					     strtoull (argv[2], NULL, 0), &rec);
+		goto found;
+	}
+
+	if (argc == 3 && strcmp (argv[0], "ip") == 0) {
+		ret = i960_trace_find_ip (r, strtoul (argv[1], NULL, 0),
+					  strtoull (argv[2], NULL, 0), &rec);
+		goto found;
+	}
+
+	first = argc > 0 ? strtoull (argv[0], NULL, 0) : 0;
+	count = argc > 1 ? strtoull (argv[1], NULL, 0) : UINT64_MAX;
+
+	if ((ret = i960_trace_seek (r, first)) <= 0)
+		return ret;
+
+	for (; count > 0 && (ret = i960_trace_next (r, &rec)) > 0; --count)
+		dump (stdout, &rec);
+
+	if (ret < 0)
+		return ret;
+
+	printf ("# %llu records, %llu lost\n", (unsigned long long) r->count,
+		(unsigned long long) r->lost);
+	return 1;
+found:
+	if (ret > 0) {
+		printf ("# record %llu\n", (unsigned long long) rec.n);
+		dump (stdout, &rec);
+	}
+
+	return ret;
+}
+
+int main (int argc, char *argv[])
+{
+	struct i960_trace_reader r;
+	int ret;
+
+	if (argc < 2 || argc > 5)
+		return usage ();
+
+	if (!i960_trace_open (&r, argv[1])) {
+		fprintf (stderr, "i960-trace: %s: %s\n", argv[1],
+			 strerror (errno));
+		return 1;
+	}
+
+	if ((ret = query (&r, argc - 2, argv + 2)) < 0)
+		fprintf (stderr, "i960-trace: %s: %s\n", argv[1],
+			 strerror (errno));
+	else if (ret == 0)
+		fprintf (stderr, "i960-trace: not found\n");
+
+	i960_trace_close (&r);
+	return ret <= 0;
+}
@@ -0,0 +1,963 @@
+/*
+ * 80960 Emulator Binary Execution Trace
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <i960-decode.h>
+#include <i960-trace.h>
+
+/*
+ * File format: magic, chunks, index, trailer. All numbers are little
+ * endian.
+ *
+ * Chunk header: tag, first record number (64-bit), record count, payload
+ * size, lowest and highest executed ip, registers at chunk start, bloom
+ * filter of written words. Payload is a sequence of records, delta state
+ * and opcode cache are reset at chunk start.
+ *
+ * Each record starts with flags byte followed by:
+ *
+ *   ip delta	zigzag varint, from previous ip + 4
+ *   op		4 bytes, little endian, unless OPC flag set (op equal to
+ *		the one cached for ip)
+ *   disp	4 bytes, little endian, if DISP flag set
+ *   regs	varint mask, then for every register in mask varint of
+ *		zigzag difference with its previous value, if REGS set
+ *   mem	varint count, then for every access kind byte, varint
+ *		size, zigzag varint address delta and varint value, if MEM
+ *		set
+ *
+ * Index holds offset, first record number, record count and ip range of
+ * every chunk. Trailer: index offset, chunk count, record count, lost
+ * record count (all 64-bit), then index magic.
+ */
+static const char trace_magic[8] = "I960TRC\2";
+static const char index_magic[8] = "I960IDX\0";
+
+#define CHUNK_TAG	0x4b4e4843	/* "CHNK"			*/
+#define CHUNK_HEAD	(28 + 4 * I960_TRACE_REGS + I960_TRACE_BLOOM)
+#define INDEX_ENTRY	28
+#define TRAILER		40
+
+#define F_OPC	1
+#define F_GAP	2
+#define F_REGS	4
+#define F_MEM	8
+#define F_DISP	16
+
+#define OPS_ORDER	12
+
+struct i960_trace_op {
+	uint32_t ip, op;
+};
+
+static size_t op_slot (uint32_t ip)
+{
+	return (ip >> 2) & ((1 << OPS_ORDER) - 1);
+}
+
+static uint32_t zz_enc (int32_t x)
+{
+	return ((uint32_t) x << 1) ^ (uint32_t) (x >> 31);
+}
+
+static int32_t zz_dec (uint32_t x)
+{
+	return (int32_t) (x >> 1) ^ -(int32_t) (x & 1);
+}
+
+static void bloom_hash (uint32_t addr, unsigned h[2])
+{
+	const uint32_t w = addr >> 2;
+	const int shift = 32 - 3 - __builtin_ctz (I960_TRACE_BLOOM);
+
+	h[0] = (w * 0x9e3779b1u) >> shift;
+	h[1] = (w * 0x85ebca6bu) >> shift;
+}
+
+static void bloom_add (uint8_t *bloom, uint32_t addr)
+{
+	unsigned h[2];
+
+	bloom_hash (addr, h);
+	bloom[h[0] >> 3] |= 1 << (h[0] & 7);
+	bloom[h[1] >> 3] |= 1 << (h[1] & 7);
+}
+
+static int bloom_test (const uint8_t *bloom, uint32_t addr)
+{
+	unsigned h[2];
+
+	bloom_hash (addr, h);
+	return (bloom[h[0] >> 3] >> (h[0] & 7)) &
+	       (bloom[h[1] >> 3] >> (h[1] & 7)) & 1;
+}
+
+static uint8_t *put_le (uint8_t *p, uint64_t x, int size)
+{
+	for (; size > 0; --size, x >>= 8)
+		*p++ = x;
+
+	return p;
+}
+
+static uint64_t get_le (const uint8_t **p, int size)
+{
+	uint64_t x = 0;
+	int i;
+
+	for (i = 0; i < size; ++i)
+		x |= (uint64_t) (*p)[i] << (8 * i);
+
+	*p += size;
+	return x;
+}
+
+/*
+ * Producer (CPU thread)
+ *
+ * Raw record in ring: ip, op, disp, low register mask, high register
+ * mask | gap << 8 | nmem << 16, register values, then three words per
+ * memory access: kind | size << 16, address, value.
+ */
+static void trace_alog (void *ctx, const struct i960_access *v, size_t count)
+{
+	struct i960_trace *t = ctx;
+	size_t i;
+
+	for (i = 0; i < count; ++i)
+		if (v[i].kind == I960_ACC_FETCH)
+			continue;
+		else if (t->nmem < I960_TRACE_MEM)
+			t->mem[t->nmem++] = v[i];
+		else
+			++t->truncated;
+}
+
+static void regs_save (uint32_t *to, const struct i960 *o)
+{
+	memcpy (to, o->r, 32 * sizeof (o->r[0]));
+
+	to[I960_TRACE_AC] = o->ac;
+	to[I960_TRACE_PC] = o->pc;
+	to[I960_TRACE_TC] = o->tc;
+}
+
+void i960_trace_enter (struct i960_trace *t, uint32_t ip, uint32_t op,
+		       uint32_t disp)
+{
+	t->ip   = ip;
+	t->op   = op;
+	t->disp = disp;
+	t->nmem = 0;
+
+	regs_save (t->snap, t->cpu);
+}
+
+void i960_trace_retire (struct i960_trace *t)
+{
+	uint32_t regs[I960_TRACE_REGS], *ring = t->ring;
+	const size_t tail = __atomic_load_n (&t->tail, __ATOMIC_ACQUIRE);
+	size_t head = t->head, len, i;
+	uint64_t mask = 0;
+
+	i960_alog_flush (&t->alog);
+	regs_save (regs, t->cpu);
+
+	for (i = 0, len = 5 + 3 * t->nmem; i < I960_TRACE_REGS; ++i)
+		if (regs[i] != t->snap[i]) {
+			mask |= (uint64_t) 1 << i;
+			++len;
+		}
+
+	if (t->mask + 1 - (head - tail) < len) {
+		++t->lost;
+		t->gap = 1;
+		return;
+	}
+
+	ring[head++ & t->mask] = t->ip;
+	ring[head++ & t->mask] = t->op;
+	ring[head++ & t->mask] = t->disp;
+	ring[head++ & t->mask] = mask;
+	ring[head++ & t->mask] = (mask >> 32) | t->gap << 8 | t->nmem << 16;
+
+	for (i = 0; i < I960_TRACE_REGS; ++i)
+		if ((mask >> i) & 1)
+			ring[head++ & t->mask] = regs[i];
+
+	for (i = 0; i < t->nmem; ++i) {
+		ring[head++ & t->mask] = t->mem[i].kind | t->mem[i].size << 16;
+		ring[head++ & t->mask] = t->mem[i].addr;
+		ring[head++ & t->mask] = t->mem[i].value;
+	}
+
+	__atomic_store_n (&t->head, head, __ATOMIC_RELEASE);
+	++t->count;
+	t->gap = 0;
+}
+
+/*
+ * Consumer (writer thread)
+ */
+static uint8_t *put_varint (uint8_t *p, uint64_t x)
+{
+	for (; x >= 0x80; x >>= 7)
+		*p++ = (x & 0x7f) | 0x80;
+
+	*p++ = x;
+	return p;
+}
+
+static void chunk_reset (struct i960_trace *t)
+{
+	t->chunk.first += t->chunk.count;
+	t->chunk.count  = 0;
+	t->chunk.ip_lo  = ~0;
+	t->chunk.ip_hi  = 0;
+
+	t->last_ip = t->last_addr = 0;
+	t->len = 0;
+
+	memcpy (t->base, t->shadow, sizeof (t->base));
+	memset (t->bloom, 0, I960_TRACE_BLOOM);
+	memset (t->ops, 0, sizeof (t->ops[0]) << OPS_ORDER);
+}
+
+static int index_add (struct i960_trace *t)
+{
+	const size_t n = t->index_size == 0 ? 256 : t->index_size * 2;
+	struct i960_trace_chunk *v;
+
+	if (t->nchunks == t->index_size) {
+		if ((v = realloc (t->index, n * sizeof (v[0]))) == NULL)
+			return 0;
+
+		t->index      = v;
+		t->index_size = n;
+	}
+
+	t->index[t->nchunks++] = t->chunk;
+	return 1;
+}
+
+static void chunk_write (struct i960_trace *t)
+{
+	uint8_t head[CHUNK_HEAD], *p = head;
+	int i;
+
+	p = put_le (p, CHUNK_TAG, 4);
+	p = put_le (p, t->chunk.first, 8);
+	p = put_le (p, t->chunk.count, 4);
+	p = put_le (p, t->len, 4);
+	p = put_le (p, t->chunk.ip_lo, 4);
+	p = put_le (p, t->chunk.ip_hi, 4);
+
+	for (i = 0; i < I960_TRACE_REGS; ++i)
+		p = put_le (p, t->base[i], 4);
+
+	memcpy (p, t->bloom, I960_TRACE_BLOOM);
+
+	if (fwrite (head, sizeof (head), 1, t->out) != 1 ||
+	    fwrite (t->data, t->len, 1, t->out) != 1 || !index_add (t))
+		t->error = 1;
+
+	t->chunk.offset += sizeof (head) + t->len;
+	chunk_reset (t);
+}
+
+#define RECORD_MAX	(20 + 5 + 5 * I960_TRACE_REGS + 16 * I960_TRACE_MEM)
+
+static int data_grow (struct i960_trace *t)
+{
+	const size_t n = t->avail * 2;
+	uint8_t *p;
+
+	if ((p = realloc (t->data, n)) == NULL)
+		return 0;
+
+	t->data  = p;
+	t->avail = n;
+	return 1;
+}
+
+static size_t trace_encode (struct i960_trace *t, size_t tail)
+{
+	const uint32_t *ring = t->ring;
+	const size_t m = t->mask;
+	uint32_t ip, op, disp, info, kind, addr, x;
+	struct i960_trace_op *e;
+	uint8_t *p;
+	uint64_t mask;
+	unsigned flags, nmem, i;
+
+	ip   = ring[tail++ & m];
+	op   = ring[tail++ & m];
+	disp = ring[tail++ & m];
+	mask = ring[tail++ & m];
+	info = ring[tail++ & m];
+	mask |= (uint64_t) (info & 0xff) << 32;
+	nmem = info >> 16;
+
+	e = t->ops + op_slot (ip);
+
+	flags  = e->ip == ip && e->op == op ? F_OPC : 0;
+	flags |= (info >> 8) & 1 ? F_GAP : 0;
+	flags |= mask != 0 ? F_REGS : 0;
+	flags |= nmem != 0 ? F_MEM  : 0;
+	flags |= i960_insn_len (op) == 8 ? F_DISP : 0;
+
+	e->ip = ip;
+	e->op = op;
+
+	p = t->data + t->len;
+	*p++ = flags;
+	p = put_varint (p, zz_enc (ip - (t->last_ip + 4)));
+	t->last_ip = ip;
+
+	if ((flags & F_OPC) == 0)
+		p = put_le (p, op, 4);
+
+	if ((flags & F_DISP) != 0)
+		p = put_le (p, disp, 4);
+
+	if ((flags & F_REGS) != 0) {
+		p = put_varint (p, mask);
+
+		for (i = 0; i < I960_TRACE_REGS; ++i)
+			if ((mask >> i) & 1) {
+				x = ring[tail++ & m];
+				p = put_varint (p, zz_enc (x - t->shadow[i]));
+				t->shadow[i] = x;
+			}
+	}
+
+	if ((flags & F_MEM) != 0) {
+		p = put_varint (p, nmem);
+
+		for (i = 0; i < nmem; ++i) {
+			kind = ring[tail++ & m];
+			addr = ring[tail++ & m];
+			x    = ring[tail++ & m];
+
+			*p++ = kind;
+			p = put_varint (p, kind >> 16);
+			p = put_varint (p, zz_enc (addr - t->last_addr));
+			p = put_varint (p, x);
+			t->last_addr = addr;
+
+			if ((kind & 0xffff) == I960_ACC_STORE)
+				for (x = addr & ~3; x < addr + (kind >> 16);
+				     x += 4)
+					bloom_add (t->bloom, x);
+		}
+	}
+
+	t->len = p - t->data;
+
+	if (ip < t->chunk.ip_lo)  t->chunk.ip_lo = ip;
+	if (ip > t->chunk.ip_hi)  t->chunk.ip_hi = ip;
+
+	if (++t->chunk.count == I960_TRACE_CHUNK ||
+	    (t->avail - t->len < RECORD_MAX && !data_grow (t)))
+		chunk_write (t);
+
+	return tail;
+}
+
+static int trace_drain (struct i960_trace *t)
+{
+	const size_t head = __atomic_load_n (&t->head, __ATOMIC_ACQUIRE);
+	size_t tail;
+
+	if ((tail = t->tail) == head)
+		return 0;
+
+	do
+		tail = trace_encode (t, tail);
+	while (tail != head);
+
+	__atomic_store_n (&t->tail, tail, __ATOMIC_RELEASE);
+	return 1;
+}
+
+static void trace_finish (struct i960_trace *t)
+{
+	uint8_t buf[TRAILER], *p;
+	size_t i;
+
+	if (t->chunk.count > 0)
+		chunk_write (t);
+
+	for (i = 0; i < t->nchunks; ++i) {
+		p = put_le (buf, t->index[i].offset, 8);
+		p = put_le (p, t->index[i].first, 8);
+		p = put_le (p, t->index[i].count, 4);
+		p = put_le (p, t->index[i].ip_lo, 4);
+		p = put_le (p, t->index[i].ip_hi, 4);
+
+		if (fwrite (buf, INDEX_ENTRY, 1, t->out) != 1)
+			t->error = 1;
+	}
+
+	p = put_le (buf, t->chunk.offset, 8);
+	p = put_le (p, t->nchunks, 8);
+	p = put_le (p, t->chunk.first, 8);
+	p = put_le (p, t->lost, 8);
+	memcpy (p, index_magic, sizeof (index_magic));
+
+	if (fwrite (buf, TRAILER, 1, t->out) != 1)
+		t->error = 1;
+}
+
+static void *trace_writer (void *cookie)
+{
+	struct i960_trace *t = cookie;
+	const struct timespec idle = { 0, 100000 };
+
+	while (!__atomic_load_n (&t->stop, __ATOMIC_ACQUIRE))
+		if (!trace_drain (t))
+			nanosleep (&idle, NULL);
+
+	trace_drain (t);
+	trace_finish (t);
+
+	if (ferror (t->out))
+		t->error = 1;
+
+	return NULL;
+}
+
+static void trace_free (struct i960_trace *t)
+{
+	free (t->index);
+	free (t->data);
+	free (t->bloom);
+	free (t->ops);
+	free (t->ring);
+	t->index = NULL;
+	t->data  = NULL;
+	t->bloom = NULL;
+	t->ops   = NULL;
+	t->ring  = NULL;
+}
+
+int i960_trace_start (struct i960_trace *t, struct i960 *o, const char *path,
+		      size_t size)
+{
+	size_t n;
+	int e;
+
+	for (n = 65536; n < size; n *= 2) {}
+
+	memset (t, 0, sizeof (*t));
+
+	t->avail = 1024 * RECORD_MAX;
+
+	t->ring  = malloc (n * sizeof (t->ring[0]));
+	t->ops   = malloc (sizeof (t->ops[0]) << OPS_ORDER);
+	t->bloom = malloc (I960_TRACE_BLOOM);
+	t->data  = malloc (t->avail);
+
+	if (t->ring == NULL || t->ops == NULL || t->bloom == NULL ||
+	    t->data == NULL)
+		goto no_mem;
+
+	if ((t->out = fopen (path, "wb")) == NULL)
+		goto no_file;
+
+	if (fwrite (trace_magic, sizeof (trace_magic), 1, t->out) != 1)
+		goto no_write;
+
+	t->cpu  = o;
+	t->mask = n - 1;
+	t->chunk.offset = sizeof (trace_magic);
+
+	regs_save (t->shadow, o);
+	chunk_reset (t);
+
+	t->alog.v     = t->buf;
+	t->alog.size  = sizeof (t->buf) / sizeof (t->buf[0]);
+	t->alog.flush = trace_alog;
+	t->alog.ctx   = t;
+
+	if ((e = pthread_create (&t->writer, NULL, trace_writer, t)) != 0) {
+		errno = e;
+		goto no_write;
+	}
+
+	o->alog  = &t->alog;
+	o->trace = t;
+	return 1;
+no_write:
+	fclose (t->out);
+no_file:
+no_mem:
+	trace_free (t);
+	return 0;
+}
+
+int i960_trace_stop (struct i960_trace *t)
+{
+	int ok;
+
+	if (t->cpu->trace == t) {
+		t->cpu->trace = NULL;
+		t->cpu->alog  = NULL;
+	}
+
+	__atomic_store_n (&t->stop, 1, __ATOMIC_RELEASE);
+	pthread_join (t->writer, NULL);
+
+	ok = !t->error && fclose (t->out) == 0;
+
+	trace_free (t);
+	return ok;
+}
+
+/*
+ * Reader
+ */
+static int trace_bad (void)
+{
+	errno = EILSEQ;
+	return -1;
+}
+
+static int index_load (struct i960_trace_reader *r)
+{
+	uint8_t buf[TRAILER];
+	const uint8_t *p;
+	uint64_t offset;
+	size_t i;
+
+	if (fseeko (r->in, -TRAILER, SEEK_END) != 0 ||
+	    fread (buf, TRAILER, 1, r->in) != 1 ||
+	    memcmp (buf + 32, index_magic, sizeof (index_magic)) != 0)
+		return 0;
+
+	p = buf;
+	offset     = get_le (&p, 8);
+	r->nchunks = get_le (&p, 8);
+	r->count   = get_le (&p, 8);
+	r->lost    = get_le (&p, 8);
+
+	if (r->nchunks >= SIZE_MAX / sizeof (r->index[0]))
+		return trace_bad ();
+
+	r->index = malloc ((r->nchunks + 1) * sizeof (r->index[0]));
+
+	if (r->index == NULL || fseeko (r->in, offset, SEEK_SET) != 0)
+		return -1;
+
+	for (i = 0; i < r->nchunks; ++i) {
+		if (fread (buf, INDEX_ENTRY, 1, r->in) != 1)
+			return trace_bad ();
+
+		p = buf;
+		r->index[i].offset = get_le (&p, 8);
+		r->index[i].first  = get_le (&p, 8);
+		r->index[i].count  = get_le (&p, 4);
+		r->index[i].ip_lo  = get_le (&p, 4);
+		r->index[i].ip_hi  = get_le (&p, 4);
+	}
+
+	return 1;
+}
+
+static int chunk_head (struct i960_trace_reader *r, uint64_t offset,
+		       struct i960_trace_chunk *c, uint32_t *size)
+{
+	uint8_t head[28];
+	const uint8_t *p = head;
+
+	if (fseeko (r->in, offset, SEEK_SET) != 0 ||
+	    fread (head, sizeof (head), 1, r->in) != 1 ||
+	    get_le (&p, 4) != CHUNK_TAG)
+		return 0;
+
+	c->offset = offset;
+	c->first  = get_le (&p, 8);
+	c->count  = get_le (&p, 4);
+	*size     = get_le (&p, 4);
+	c->ip_lo  = get_le (&p, 4);
+	c->ip_hi  = get_le (&p, 4);
+	return 1;
+}
+
+/*
+ * Rebuild index of unfinished trace from chunk headers
+ */
+static int index_scan (struct i960_trace_reader *r)
+{
+	struct i960_trace_chunk c, *v;
+	uint64_t offset = sizeof (trace_magic);
+	size_t avail = 0;
+	uint32_t size;
+	off_t end;
+
+	free (r->index);
+	r->index   = NULL;
+	r->nchunks = 0;
+	r->count   = 0;
+	r->lost    = 0;
+
+	if (fseeko (r->in, 0, SEEK_END) != 0 || (end = ftello (r->in)) < 0)
+		return -1;
+
+	while (chunk_head (r, offset, &c, &size) &&
+	       offset + CHUNK_HEAD + size <= (uint64_t) end) {
+		if (r->nchunks == avail) {
+			avail = avail == 0 ? 256 : avail * 2;
+
+			if ((v = realloc (r->index, avail * sizeof (v[0]))) == NULL)
+				return -1;
+
+			r->index = v;
+		}
+
+		r->index[r->nchunks++] = c;
+		r->count = c.first + c.count;
+		offset += CHUNK_HEAD + size;
+	}
+
+	return 1;
+}
+
+int i960_trace_open (struct i960_trace_reader *r, const char *path)
+{
+	char magic[sizeof (trace_magic)];
+	int ret;
+
+	memset (r, 0, sizeof (*r));
+
+	r->ops   = malloc (sizeof (r->ops[0]) << OPS_ORDER);
+	r->bloom = malloc (I960_TRACE_BLOOM);
+
+	if (r->ops == NULL || r->bloom == NULL)
+		goto no_mem;
+
+	if ((r->in = fopen (path, "rb")) == NULL)
+		goto no_file;
+
+	if (fread (magic, sizeof (magic), 1, r->in) != 1 ||
+	    memcmp (magic, trace_magic, sizeof (magic)) != 0) {
+		errno = EILSEQ;
+		goto no_index;
+	}
+
+	if ((ret = index_load (r)) == 0)
+		ret = index_scan (r);
+
+	if (ret < 0)
+		goto no_index;
+
+	return 1;
+no_index:
+	fclose (r->in);
+no_file:
+no_mem:
+	free (r->index);
+	free (r->bloom);
+	free (r->ops);
+	return 0;
+}
+
+void i960_trace_close (struct i960_trace_reader *r)
+{
+	fclose (r->in);
+	free (r->index);
+	free (r->bloom);
+	free (r->ops);
+	r->index = NULL;
+	r->bloom = NULL;
+	r->ops   = NULL;
+}
+
+/*
+ * Enter chunk i: load its register state and, optionally, address filter
+ */
+static int chunk_load (struct i960_trace_reader *r, size_t i, int bloom)
+{
+	uint8_t regs[4 * I960_TRACE_REGS];
+	const uint8_t *p = regs;
+	const struct i960_trace_chunk *c = r->index + i;
+	int k;
+
+	if (fseeko (r->in, c->offset + 28, SEEK_SET) != 0 ||
+	    fread (regs, sizeof (regs), 1, r->in) != 1)
+		return trace_bad ();
+
+	if (bloom) {
+		if (fread (r->bloom, I960_TRACE_BLOOM, 1, r->in) != 1)
+			return trace_bad ();
+	}
+	else if (fseeko (r->in, I960_TRACE_BLOOM, SEEK_CUR) != 0)
+		return -1;
+
+	for (k = 0; k < I960_TRACE_REGS; ++k)
+		r->shadow[k] = get_le (&p, 4);
+
+	memset (r->ops, 0, sizeof (r->ops[0]) << OPS_ORDER);
+
+	r->last_ip = r->last_addr = 0;
+	r->chunk = i;
+	r->left  = c->count;
+	r->next  = c->first;
+	return 1;
+}
+
+static int get_varint (FILE *from, uint64_t *x)
+{
+	int c, shift;
+
+	for (*x = 0, shift = 0; shift < 64; shift += 7) {
+		if ((c = getc_unlocked (from)) == EOF)
+			return 0;
+
+		*x |= (uint64_t) (c & 0x7f) << shift;
+
+		if ((c & 0x80) == 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+static int get_word (FILE *from, uint32_t *x)
+{
+	uint8_t b[4];
+	const uint8_t *p = b;
+
+	if (fread (b, sizeof (b), 1, from) != 1)
+		return 0;
+
+	*x = get_le (&p, 4);
+	return 1;
+}
+
+static int
+trace_decode (struct i960_trace_reader *r, struct i960_trace_rec *rec)
+{
+	struct i960_trace_op *e;
+	struct i960_access *a;
+	uint64_t x, y, z;
+	int flags, kind;
+	unsigned i;
+
+	if ((flags = getc_unlocked (r->in)) == EOF || !get_varint (r->in, &x))
+		return trace_bad ();
+
+	rec->n   = r->next++;
+	rec->ip  = r->last_ip + 4 + zz_dec (x);
+	rec->gap = (flags & F_GAP) != 0;
+	r->last_ip = rec->ip;
+	--r->left;
+
+	e = r->ops + op_slot (rec->ip);
+
+	if ((flags & F_OPC) != 0) {
+		if (e->ip != rec->ip)
+			return trace_bad ();
+
+		rec->op = e->op;
+	}
+	else if (!get_word (r->in, &rec->op))
+		return trace_bad ();
+
+	e->ip = rec->ip;
+	e->op = rec->op;
+
+	rec->disp = 0;
+
+	if ((flags & F_DISP) != 0 && !get_word (r->in, &rec->disp))
+		return trace_bad ();
+
+	rec->regs = 0;
+
+	if ((flags & F_REGS) != 0) {
+		if (!get_varint (r->in, &rec->regs) ||
+		    rec->regs >> I960_TRACE_REGS != 0)
+			return trace_bad ();
+
+		for (i = 0; i < I960_TRACE_REGS; ++i)
+			if ((rec->regs >> i) & 1) {
+				if (!get_varint (r->in, &x))
+					return trace_bad ();
+
+				r->shadow[i] += zz_dec (x);
+			}
+	}
+
+	memcpy (rec->r, r->shadow, sizeof (rec->r));
+
+	rec->nmem = 0;
+
+	if ((flags & F_MEM) != 0) {
+		if (!get_varint (r->in, &x) || x > I960_TRACE_MEM)
+			return trace_bad ();
+
+		for (rec->nmem = x, i = 0; i < rec->nmem; ++i) {
+			if ((kind = getc_unlocked (r->in)) == EOF ||
+			    !get_varint (r->in, &x) ||
+			    !get_varint (r->in, &y) ||
+			    !get_varint (r->in, &z))
+				return trace_bad ();
+
+			a = rec->mem + i;
+			a->ip    = rec->ip;
+			a->kind  = kind;
+			a->size  = x;
+			a->addr  = r->last_addr + zz_dec (y);
+			a->value = z;
+			r->last_addr = a->addr;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Returns index of chunk holding record n or number of chunks if there
+ * is no such record.
+ */
+static size_t chunk_find (const struct i960_trace_reader *r, uint64_t n)
+{
+	size_t lo = 0, hi = r->nchunks, i;
+
+	while (lo < hi) {
+		i = lo + (hi - lo) / 2;
+
+		if (n < r->index[i].first)
+			hi = i;
+		else if (n >= r->index[i].first + r->index[i].count)
+			lo = i + 1;
+		else
+			return i;
+	}
+
+	return r->nchunks;
+}
+
+int i960_trace_next (struct i960_trace_reader *r, struct i960_trace_rec *rec)
+{
+	size_t i;
+	int ret;
+
+	while (r->left == 0) {
+		if ((i = chunk_find (r, r->next)) == r->nchunks)
+			return 0;
+
+		if ((ret = chunk_load (r, i, 0)) <= 0)
+			return ret;
+	}
+
+	return trace_decode (r, rec);
+}
+
+int i960_trace_seek (struct i960_trace_reader *r, uint64_t n)
+{
+	struct i960_trace_rec rec;
+	const size_t i = chunk_find (r, n);
+	int ret;
+
+	if (i == r->nchunks)
+		return 0;
+
+	if ((ret = chunk_load (r, i, 0)) <= 0)
+		return ret;
+
+	while (r->next < n)
+		if ((ret = trace_decode (r, &rec)) <= 0)
+			return ret;
+
+	return 1;
+}
+
+static int rec_writes (const struct i960_trace_rec *rec, uint32_t addr)
+{
+	const struct i960_access *a;
+	unsigned i;
+
+	for (i = 0; i < rec->nmem; ++i) {
+		a = rec->mem + i;
+
+		if (a->kind == I960_ACC_STORE && addr - a->addr < a->size)
+			return 1;
+	}
+
+	return 0;
+}
+
+int i960_trace_last_write (struct i960_trace_reader *r, uint32_t addr,
+			   uint64_t n, struct i960_trace_rec *rec)
+{
+	struct i960_trace_rec *cur;
+	size_t i;
+	int ret, found;
+
+	if ((cur = malloc (sizeof (*cur))) == NULL)
+		return -1;
+
+	if ((i = n == 0 ? 0 : chunk_find (r, n - 1)) < r->nchunks)
+		++i;
+
+	for (ret = 0; i > 0; --i) {
+		if ((ret = chunk_load (r, i - 1, 1)) < 0)
+			break;
+
+		if (!bloom_test (r->bloom, addr))
+			continue;
+
+		for (found = 0; r->left > 0 && r->next < n; )
+			if ((ret = trace_decode (r, cur)) < 0)
+				goto out;
+			else if (rec_writes (cur, addr)) {
+				*rec  = *cur;
+				found = 1;
+			}
+
+		if ((ret = found))
+			break;
+	}
+out:
+	free (cur);
+	return ret;
+}
+
+int i960_trace_find_ip (struct i960_trace_reader *r, uint32_t ip,
+			uint64_t n, struct i960_trace_rec *rec)
+{
+	const struct i960_trace_chunk *c;
+	size_t i;
+	int ret;
+
+	if ((i = chunk_find (r, n)) == r->nchunks)
+		return 0;
+
+	for (; i < r->nchunks; ++i) {
+		c = r->index + i;
+
+		if (ip < c->ip_lo || ip > c->ip_hi)
+			continue;
+
+		if ((ret = chunk_load (r, i, 0)) <= 0)
+			return ret;
+
+		while (r->left > 0)
+			if ((ret = trace_decode (r, rec)) <= 0)
+				return ret;
+			else if (rec->n >= n && rec->ip == ip)
+				return 1;
+	}
+
+	return 0;
+}
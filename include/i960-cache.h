@@ -0,0 +1,74 @@
+/*
+ * 80960 Emulator Cache Simulator
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_CACHE_H
+#define I960_CACHE_H  1
+
+#include <stdio.h>
+
+#include <i960-emu-alog.h>
+#include <i960-sym.h>
+#include <i960-timing.h>
+
+struct i960_cache_line {
+	uint32_t tag, stamp;
+	uint8_t valid, locked;
+};
+
+/*
+ * Set-associative LRU cache, no write allocation (stores update hit lines
+ * only, as write-through data caches of J and H series do).
+ */
+struct i960_cache {
+	unsigned sets, ways, shift;	/* shift = log2 (line size)	*/
+	int enabled;
+	uint32_t clock;
+	struct i960_cache_line *lines;
+	uint64_t reads, misses, writes;
+};
+
+/*
+ * Size zero makes cache absent: every read misses. Returns 1 on success,
+ * 0 on error with errno set.
+ */
+int  i960_cache_init (struct i960_cache *o, unsigned size, unsigned ways,
+		      unsigned line);
+void i960_cache_fini (struct i960_cache *o);
+
+int  i960_cache_read  (struct i960_cache *o, uint32_t addr);  /* 1 if hit */
+void i960_cache_write (struct i960_cache *o, uint32_t addr);
+
+void i960_cache_invalidate (struct i960_cache *o);	/* unlocked lines */
+void i960_cache_invalidate_line (struct i960_cache *o, uint32_t addr);
+void i960_cache_lock (struct i960_cache *o, uint32_t addr, unsigned lines);
+
+/*
+ * Instruction and data cache pair of 80960 variant fed by access log in
+ * batches, see i960_alog: use i960_csim_feed as flush callback and
+ * simulator as its context. Misses are attributed to guest functions.
+ */
+struct i960_csim_func {
+	uint32_t addr;
+	uint64_t fetches, fmisses, loads, lmisses;
+};
+
+struct i960_csim {
+	struct i960_cache ic, dc;
+	struct i960_syms *syms;		/* optional, for functions	*/
+
+	struct i960_csim_func *funcs;	/* open-addressing by address	*/
+	size_t nfuncs, used;
+};
+
+int  i960_csim_init (struct i960_csim *o, int variant, struct i960_syms *s);
+void i960_csim_fini (struct i960_csim *o);
+
+void i960_csim_feed (void *ctx, const struct i960_access *v, size_t count);
+void i960_csim_report (FILE *to, struct i960_csim *o);
+
+#endif  /* I960_CACHE_H */
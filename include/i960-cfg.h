@@ -0,0 +1,130 @@
+/*
+ * 80960 Control Flow Graph Recovery
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_CFG_H
+#define I960_CFG_H  1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Static analysis of a firmware image: code is followed from entry points
+ * over direct branches, calls and jump tables, then split into functions
+ * and basic blocks. Blocks end at control transfers, calls included, and
+ * before branch targets.
+ */
+#define I960_CFG_NONE	0xffffffff	/* no address, no index		*/
+
+enum i960_cfg_kind {
+	I960_CFG_FALL,			/* falls into next block	*/
+	I960_CFG_JUMP,			/* b, bx to fixed address	*/
+	I960_CFG_COND,			/* conditional branch		*/
+	I960_CFG_CALL,			/* call, bal, calls, continues	*/
+	I960_CFG_RET,			/* ret				*/
+	I960_CFG_TABLE,			/* bx over jump table		*/
+	I960_CFG_INDIRECT,		/* bx to unknown address	*/
+	I960_CFG_INVALID,		/* runs into undefined opcode	*/
+};
+
+enum i960_cfg_origin {
+	I960_CFG_ENTRY,			/* given by embedder, reset	*/
+	I960_CFG_FAULT,			/* fault table			*/
+	I960_CFG_PROC,			/* system procedure table	*/
+	I960_CFG_INTR,			/* interrupt table		*/
+	I960_CFG_CALLED,		/* target of call or callx	*/
+	I960_CFG_LEAF,			/* target of bal or balx	*/
+};
+
+/*
+ * Successors: next for FALL, COND and CALL; taken for JUMP, COND and
+ * CALL (callee, NONE if not known); table index for TABLE.
+ */
+struct i960_cfg_block {
+	uint32_t start, end;		/* address range [start, end)	*/
+	uint32_t taken, next;
+	uint32_t table;
+	uint32_t func;			/* first owner index or NONE	*/
+	uint8_t  kind;
+};
+
+struct i960_cfg_table {
+	uint32_t site;			/* address of bx		*/
+	uint32_t addr, count;		/* absolute target words	*/
+};
+
+struct i960_cfg_func {
+	uint32_t entry;
+	uint8_t  origin;
+};
+
+struct i960_cfg_item;
+
+struct i960_cfg {
+	const uint8_t *image;		/* little-endian words		*/
+	uint32_t base, size;
+	uint32_t proc;			/* system procedure table	*/
+
+	uint32_t *code, *leader, *entry;	/* bitmaps over words	*/
+
+	struct i960_cfg_item *work;
+	size_t nwork, awork;
+
+	struct i960_cfg_block *blocks;	/* sorted by address		*/
+	size_t nblocks, ablocks;
+
+	struct i960_cfg_table *tables;	/* sorted by site after build	*/
+	size_t ntables, atables;
+
+	struct i960_cfg_func *funcs;	/* sorted by entry after build	*/
+	size_t nfuncs, afuncs;
+};
+
+/*
+ * Image is not copied and must live until fini. Returns 1 on success,
+ * 0 on error with errno set.
+ */
+int  i960_cfg_init (struct i960_cfg *o, const void *image, uint32_t base,
+		    uint32_t size);
+void i960_cfg_fini (struct i960_cfg *o);
+
+/*
+ * Entry points. Table readers take table address and return 0 with
+ * errno = EFAULT if the table is not inside the image. The PRCB and the
+ * initialization boot record use Jx/Hx layout: boot record gives reset
+ * vector and PRCB, PRCB gives fault, interrupt and system procedure
+ * tables.
+ */
+int i960_cfg_add_entry (struct i960_cfg *o, uint32_t addr, int origin);
+
+int i960_cfg_add_fault_table (struct i960_cfg *o, uint32_t addr);
+int i960_cfg_add_proc_table  (struct i960_cfg *o, uint32_t addr);
+int i960_cfg_add_int_table   (struct i960_cfg *o, uint32_t addr);
+
+int i960_cfg_add_prcb (struct i960_cfg *o, uint32_t addr);
+int i960_cfg_add_boot (struct i960_cfg *o, uint32_t ibr);
+
+/*
+ * Follow all pending entry points and rebuild blocks and functions. May
+ * be called again after more entries are added. Returns 1 on success,
+ * 0 on error with errno set.
+ */
+int i960_cfg_build (struct i960_cfg *o);
+
+/*
+ * Returns block containing address or NULL
+ */
+const struct i960_cfg_block *i960_cfg_find (const struct i960_cfg *o,
+					    uint32_t addr);
+
+/*
+ * Returns target address of jump table entry
+ */
+uint32_t i960_cfg_table_target (const struct i960_cfg *o,
+				const struct i960_cfg_table *t, size_t i);
+
+#endif  /* I960_CFG_H */
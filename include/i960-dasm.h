@@ -0,0 +1,45 @@
+/*
+ * 80960 Disassembler
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_DASM_H
+#define I960_DASM_H  1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Disassemble one instruction, returns instruction length in bytes. The
+ * disp argument is the second instruction word, used by MEMB only.
+ */
+uint32_t i960_dasm (FILE *to, uint32_t ip, uint32_t op, uint32_t disp);
+
+/*
+ * Same as above but formats into buffer of len bytes without stdio. The
+ * text is always NUL-terminated and truncated to fit; I960_DASM_MAX bytes
+ * are enough for any instruction.
+ */
+#define I960_DASM_MAX	64
+
+uint32_t i960_dasm_buf (char *buf, size_t len, uint32_t ip, uint32_t op,
+			uint32_t disp);
+
+/*
+ * Same as above for an instruction decoded already by i960_decode.
+ */
+struct i960_insn;
+
+uint32_t i960_dasm_insn (char *buf, size_t len, uint32_t ip,
+			 const struct i960_insn *in);
+
+/*
+ * Returns mnemonic of an instruction or NULL if opcode is not defined.
+ */
+const char *i960_dasm_name (uint32_t op);
+
+#endif  /* I960_DASM_H */
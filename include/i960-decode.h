@@ -0,0 +1,208 @@
+/*
+ * 80960 Instruction Decoder
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_DECODE_H
+#define I960_DECODE_H  1
+
+#include <stdint.h>
+
+enum i960_format {
+	I960_FMT_CTRL,
+	I960_FMT_COBR,
+	I960_FMT_REG,
+	I960_FMT_MEMA,
+	I960_FMT_MEMB,
+};
+
+enum i960_opnd {
+	I960_OPND_NONE,
+	I960_OPND_REG,			/* local or global register	*/
+	I960_OPND_LIT,			/* literal 0..31		*/
+	I960_OPND_SFR,			/* special function or FP reg	*/
+};
+
+/*
+ * Operand slots: REG -- src1, src2, src/dst; COBR -- src1, src2, test
+ * destination; MEM -- index, abase, src/dst (plain registers, present
+ * only when addressing mode uses them); CTRL has no operands.
+ *
+ * The code is opcode index: major opcode op[31:24], for REG it is
+ * extended by minor opcode op[10:7] to 12 bits.
+ *
+ * The disp is sign-extended branch displacement for CTRL and COBR, offset
+ * for MEMA and second instruction word for long MEMB forms. The MEM mode
+ * is raw op[13:10] for MEMB and 0 (offset) or 8 (offset + abase) for MEMA.
+ */
+struct i960_insn {
+	uint32_t op, disp;
+	uint16_t code;
+	uint8_t  format, len;
+	uint8_t  mode, scale;		/* MEM mode and log2 of scale	*/
+	uint8_t  kind[3], val[3];	/* operand kinds and values	*/
+	uint8_t  fp;			/* real operand slots of FPU op	*/
+};
+
+/*
+ * MEMB modes with displacement word, with abase and with index
+ */
+#define I960_MEM_LONG	0xF020		/* 0101, 11xx		*/
+#define I960_MEM_BASE	0xA090		/* 0100, 0111, 1101, 1111	*/
+#define I960_MEM_INDEX	0xC080		/* 0111, 1110, 1111		*/
+
+static inline uint32_t i960_insn_len (uint32_t op)
+{
+	const uint32_t mode = (op >> 10) & 15;
+
+	return 4 + 4 * ((op >> 31) & (I960_MEM_LONG >> mode));
+}
+
+static inline int32_t i960_ctrl_disp (uint32_t op)
+{
+	return (((int32_t) op << 8) >> 8) & ~3;
+}
+
+static inline int32_t i960_cobr_disp (uint32_t op)
+{
+	return (((int32_t) op << 19) >> 19) & ~3;
+}
+
+static inline uint8_t i960_opnd (int S, int M)
+{
+	return S && M ? I960_OPND_NONE :	/* reserved		*/
+	       I960_OPND_REG + M + 2 * S;	/* SFR if S, else LIT if M */
+}
+
+/*
+ * Real operand slots of FPU operation: bit 0 -- src1, bit 1 -- src2,
+ * bit 2 -- dst; zero for non-FPU operations. M bit of real operand
+ * selects fp0-fp3, +0.0 or +1.0 (SFR kind), of integer one -- literal.
+ * S bits are reserved in FPU operations.
+ */
+static inline unsigned i960_fp_slots (uint32_t code)
+{
+	if ((code & 0xffc) == 0x674)		/* cvtir, cvtilr, scaler(l)	*/
+		return 6;
+
+	if ((code & 0xffc) == 0x6c0)		/* cvtri, cvtril, cvtzri(l)	*/
+		return 3;
+
+	if ((code >> 7) == 0x0d || (code & 0xff4) == 0x674 ||
+	    (code & 0xf88) == 0x788)
+		return 7;
+
+	return 0;
+}
+
+static inline uint8_t i960_fp_opnd (int S, int M, int real)
+{
+	return S ? I960_OPND_NONE : !M ? I960_OPND_REG :
+	       real ? I960_OPND_SFR : I960_OPND_LIT;
+}
+
+static inline void i960_decode_reg (struct i960_insn *in)
+{
+	const uint32_t op = in->op;
+	const int S1 = (op >>  5) & 1;
+	const int S2 = (op >>  6) & 1;
+	const int M1 = (op >> 11) & 1;
+	const int M2 = (op >> 12) & 1;
+	const int M3 = (op >> 13) & 1;
+	unsigned fp;
+
+	in->format = I960_FMT_REG;
+	in->code   = (op >> 20 & 0xff0) | (op >> 7 & 15);
+
+	if ((in->fp = fp = i960_fp_slots (in->code)) == 0) {
+		in->kind[0] = i960_opnd (S1, M1);
+		in->kind[1] = i960_opnd (S2, M2);
+		in->kind[2] = i960_opnd (M3, 0);
+		return;
+	}
+
+	in->kind[0] = i960_fp_opnd (S1, M1, fp & 1);
+	in->kind[1] = i960_fp_opnd (S2, M2, fp & 2);
+	in->kind[2] = !M3 ? I960_OPND_REG :
+		      fp & 4 ? I960_OPND_SFR : I960_OPND_NONE;
+}
+
+static inline void i960_decode_mem (struct i960_insn *in, uint32_t disp)
+{
+	const uint32_t op = in->op;
+	const uint32_t mode = (op >> 10) & 15;
+
+	in->kind[2] = I960_OPND_REG;
+
+	if ((op & 0x1000) == 0) {
+		in->format  = I960_FMT_MEMA;
+		in->mode    = mode & 8;
+		in->disp    = op & 0xfff;
+		in->kind[1] = in->mode ? I960_OPND_REG : I960_OPND_NONE;
+		return;
+	}
+
+	in->format  = I960_FMT_MEMB;
+	in->mode    = mode;
+	in->len     = i960_insn_len (op);
+	in->disp    = in->len == 8 ? disp : 0;
+	in->kind[1] = (I960_MEM_BASE  >> mode) & 1;	/* REG or NONE */
+	in->kind[0] = (I960_MEM_INDEX >> mode) & 1;
+	in->scale   = in->kind[0] ? (op >> 7) & 7 : 0;
+}
+
+/*
+ * Decode one instruction, returns instruction length in bytes. The disp
+ * argument is the second instruction word, used by MEMB only.
+ */
+static inline
+uint32_t i960_decode (struct i960_insn *in, uint32_t op, uint32_t disp)
+{
+	const int B0  = (op >>  0) & 1;		/* COBR S2			*/
+	const int B13 = (op >> 13) & 1;		/* COBR M1 or S3		*/
+
+	in->op      = op;
+	in->disp    = 0;
+	in->code    = op >> 24;
+	in->len     = 4;
+	in->mode    = 0;
+	in->scale   = 0;
+	in->fp      = 0;
+	in->kind[0] = in->kind[1] = in->kind[2] = I960_OPND_NONE;
+	in->val[0]  = op & 31;
+	in->val[1]  = (op >> 14) & 31;
+	in->val[2]  = (op >> 19) & 31;
+
+	switch (op >> 29) {
+	case 0:
+		in->format = I960_FMT_CTRL;
+		in->disp   = i960_ctrl_disp (op);
+		break;
+	case 1:
+		in->format = I960_FMT_COBR;
+		in->disp   = i960_cobr_disp (op);
+
+		if (op & 0x10000000) {		/* compare and branch	*/
+			in->kind[0] = i960_opnd (0, B13);
+			in->val[0]  = in->val[2];
+			in->kind[1] = i960_opnd (B0, 0);
+		}
+		else				/* test condition	*/
+			in->kind[2] = i960_opnd (B13, 0);
+
+		break;
+	case 2:
+	case 3:
+		i960_decode_reg (in);
+		break;
+	default:
+		i960_decode_mem (in, disp);
+	}
+
+	return in->len;
+}
+
+#endif  /* I960_DECODE_H */
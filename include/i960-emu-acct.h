@@ -0,0 +1,103 @@
+/*
+ * 80960 Emulator Host Time Accounting
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_EMU_ACCT_H
+#define I960_EMU_ACCT_H  1
+
+#include <stdio.h>
+#include <time.h>
+
+#include <i960-emu.h>
+
+#define I960_ACCT_DISPATCH	0	/* everything outside handlers	*/
+#define I960_ACCT_ALU		1	/* REG format handlers		*/
+#define I960_ACCT_BRANCH	2	/* CTRL and COBR handlers	*/
+#define I960_ACCT_MEM		3	/* MEM format handlers		*/
+#define I960_ACCT_FRAME		4	/* call/ret frame spill/fill	*/
+#define I960_ACCT_FAULT		5	/* fault delivery		*/
+#define I960_ACCT_MMIO		6	/* bracketed by embedder	*/
+#define I960_ACCT_JIT		7
+#define I960_ACCT_DEVICE	8
+#define I960_ACCT_COUNT		9
+
+#define I960_ACCT_DEPTH		8
+
+/*
+ * Exclusive host time per subsystem measured with time stamp counter:
+ * entering subsystem charges time since previous switch to the current
+ * one, leaving charges it to the subsystem left. Accounting is enabled
+ * by attaching initialized block to CPU state (o->acct).
+ */
+struct i960_acct {
+	uint64_t ticks[I960_ACCT_COUNT], count[I960_ACCT_COUNT];
+	uint64_t mark;
+	unsigned depth, over;		/* over = frames beyond stack	*/
+	uint8_t stack[I960_ACCT_DEPTH];	/* stack[depth] is current	*/
+
+	uint64_t tsc, ns;		/* start, for tick calibration	*/
+};
+
+static inline uint64_t i960_acct_clock (void)
+{
+#if defined (__x86_64__) || defined (__i386__)
+	return __builtin_ia32_rdtsc ();
+#else
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+static inline void i960_acct_charge (struct i960_acct *a)
+{
+	const uint64_t now = i960_acct_clock ();
+
+	a->ticks[a->stack[a->depth]] += now - a->mark;
+	a->mark = now;
+}
+
+static inline void i960_acct_enter (struct i960 *o, int sub)
+{
+	struct i960_acct *a = o->acct;
+
+	if (__builtin_expect (a == NULL, 1))
+		return;
+
+	i960_acct_charge (a);
+	++a->count[sub];
+
+	if (a->depth + 1 < I960_ACCT_DEPTH)
+		a->stack[++a->depth] = sub;
+	else
+		++a->over;
+}
+
+static inline void i960_acct_leave (struct i960 *o)
+{
+	struct i960_acct *a = o->acct;
+
+	if (__builtin_expect (a == NULL, 1))
+		return;
+
+	i960_acct_charge (a);
+
+	if (a->over > 0)
+		--a->over;
+	else if (a->depth > 0)
+		--a->depth;
+}
+
+void i960_acct_init (struct i960_acct *a);
+
+/*
+ * Write time breakdown collected so far, on demand or at exit
+ */
+void i960_acct_report (FILE *to, struct i960_acct *a);
+
+#endif  /* I960_EMU_ACCT_H */
@@ -0,0 +1,91 @@
+/*
+ * 80960 Emulator Memory Access Log
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_EMU_ALOG_H
+#define I960_EMU_ALOG_H  1
+
+#include <i960-emu.h>
+
+#define I960_ACC_FETCH		0
+#define I960_ACC_LOAD		1
+#define I960_ACC_STORE		2
+#define I960_ACC_ICCTL		3	/* addr = src2, value = type	*/
+#define I960_ACC_DCCTL		4	/* size = dst, lines to lock	*/
+#define I960_ACC_DCINVA		5
+
+struct i960_access {
+	uint32_t ip, addr, value;
+	uint16_t kind, size;
+};
+
+/*
+ * Access stream buffer: memory operations append records, full buffer
+ * is passed to consumer (cache simulator, tracer, ...) in one batch.
+ * Logging is enabled by attaching buffer to CPU state (o->alog). With
+ * period above one only every period-th record is appended, the others
+ * are dropped before they reach the buffer.
+ */
+struct i960_alog {
+	struct i960_access *v;
+	size_t count, size;
+	unsigned period, skip;		/* sampling, records to drop	*/
+
+	void (*flush) (void *ctx, const struct i960_access *v, size_t count);
+	void *ctx;
+};
+
+static inline void i960_alog_flush (struct i960_alog *o)
+{
+	if (o->count > 0)
+		o->flush (o->ctx, o->v, o->count);
+
+	o->count = 0;
+}
+
+static inline void
+i960_alog_put (struct i960_alog *o, uint32_t ip, int kind, uint32_t addr,
+	       uint32_t size, uint32_t value)
+{
+	struct i960_access *a;
+
+	if (__builtin_expect (o->skip > 0, 0)) {
+		--o->skip;
+		return;
+	}
+
+	o->skip = o->period - (o->period > 0);
+
+	a = o->v + o->count;
+	a->ip    = ip;
+	a->addr  = addr;
+	a->value = value;
+	a->kind  = kind;
+	a->size  = size;
+
+	if (++o->count == o->size)
+		i960_alog_flush (o);
+}
+
+static inline
+void i960_alog (struct i960 *o, int kind, uint32_t addr, uint32_t size,
+		uint32_t value)
+{
+	if (__builtin_expect (o->alog != NULL, 0))
+		i960_alog_put (o->alog, o->ip, kind, addr, size, value);
+}
+
+/*
+ * Instruction fetch is logged by dispatcher
+ */
+static inline void i960_alog_fetch (struct i960 *o, uint32_t ip, uint32_t op)
+{
+	if (__builtin_expect (o->alog != NULL, 0))
+		i960_alog_put (o->alog, ip, I960_ACC_FETCH, ip, 4, op);
+}
+
+#endif  /* I960_EMU_ALOG_H */
@@ -10,13 +10,18 @@
 #define I960_EMU_BRANCH_H  1
 
 #include <i960-emu.h>
+#include <i960-emu-acct.h>
+#include <i960-emu-bstat.h>
+#include <i960-emu-cg.h>
+#include <i960-emu-faults.h>
+#include <i960-emu-stat.h>
 
 static inline void i960_ldx (struct i960 *o, uint32_t efa, size_t c)
 {
 	size_t i;
 
 	for (i = 0; i < 16; ++i)
-		o->r[c + i] = i960_read_w (o, efa + i);
+		o->r[c + i] = i960_read_w (o, efa + 4 * i);
 }
 
 static inline void i960_stx (struct i960 *o, uint32_t efa, size_t c)
@@ -24,7 +29,7 @@ static inline void i960_stx (struct i960 *o, uint32_t efa, size_t c)
 	size_t i;
 
 	for (i = 0; i < 16; ++i)
-		i960_write_w (o, efa + i, o->r[c + i]);
+		i960_write_w (o, efa + 4 * i, o->r[c + i]);
 }
 
 static inline void i960_b (struct i960 *o, uint32_t efa)
@@ -32,10 +37,27 @@ static inline void i960_b (struct i960 *o, uint32_t efa)
 	o->ip = efa;
 }
 
+/*
+ * Branch: taken branch penalty of timing model, calls and returns are
+ * costed by their own classes
+ */
+static inline void i960_br (struct i960 *o, uint32_t efa)
+{
+	i960_stat_taken (o);
+	i960_b (o, efa);
+}
+
+static inline void i960_bx (struct i960 *o, uint32_t efa)
+{
+	i960_on_bx (o, efa);		/* may be return from leaf */
+	i960_br (o, efa);
+}
+
 static inline void i960_bal (struct i960 *o, uint32_t efa, size_t link)
 {
 	o->r[link] = o->ip;		/* save next instruction address */
 
+	i960_on_bal (o, efa, o->ip);
 	i960_b (o, efa);
 }
 
@@ -45,12 +67,16 @@ static inline void i960_call (struct i960 *o, uint32_t efa)
 
 	o->r[I960_RIP] = o->ip;		/* save next instruction address */
 
-	i960_stx (o, o->r[I960_FP], 16);
+	i960_acct_enter (o, I960_ACCT_FRAME);
+	i960_stx (o, o->r[I960_FP], 0);		/* save caller locals */
+	i960_acct_leave (o);
 
 	o->r[I960_PFP] = o->r[I960_FP];
 	o->r[I960_FP]  = fp;
 	o->r[I960_SP]  = fp + 64;
 
+	i960_stat_call (o);
+	i960_on_call (o, efa);
 	i960_b (o, efa);
 }
 
@@ -66,8 +92,12 @@ static inline void i960_ret (struct i960 *o)
 {
 	o->r[I960_FP] = o->r[I960_PFP] & ~63;
 
-	i960_ldx (o, o->r[I960_FP], 16);
+	i960_acct_enter (o, I960_ACCT_FRAME);
+	i960_ldx (o, o->r[I960_FP], 0);		/* restore caller locals */
+	i960_acct_leave (o);
 
+	i960_stat_ret (o);
+	i960_on_ret (o);
 	i960_b (o, o->r[I960_RIP]);
 }
 
@@ -78,19 +108,23 @@ static inline int i960_check_cond (struct i960 *o, uint32_t op)
 {
 	const uint32_t cc = u32_extract (op, 24, 3);
 
-	return (o->ac && cc) != 0 || (o->ac & I960_CC_MASK) == cc;
+	return (o->ac & cc) != 0 || (o->ac & I960_CC_MASK) == cc;
 }
 
 static inline void i960_bcc (struct i960 *o, uint32_t op, uint32_t efa)
 {
-	if (i960_check_cond (o, op))
-		i960_b (o, efa);
+	const int ok = i960_check_cond (o, op);
+
+	i960_bstat_cond (o, op, ok);
+
+	if (ok)
+		i960_br (o, efa);
 }
 
 static inline void i960_faultcc (struct i960 *o, uint32_t op, uint32_t efa)
 {
 	if (i960_check_cond (o, op))
-		i960_fault (o, 0x50001);  /* constraint range */
+		i960_raise (o, 0x50001);  /* constraint range */
 }
 
 #endif  /* I960_EMU_BRANCH_H */
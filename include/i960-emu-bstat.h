@@ -0,0 +1,90 @@
+/*
+ * 80960 Emulator Branch Site Statistics
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_EMU_BSTAT_H
+#define I960_EMU_BSTAT_H  1
+
+#include <stdio.h>
+
+#include <i960-decode.h>
+#include <i960-emu.h>
+
+/*
+ * Side table of branch sites keyed by instruction address: conditional
+ * branches, compare-and-branch, bit test branches and conditional
+ * select/add count executions and taken (condition true) outcomes,
+ * indirect branches (bx, balx, callx) keep histogram of most frequent
+ * targets. Collection is enabled by attaching zeroed table to CPU state
+ * (o->bstat).
+ *
+ * Site address is o->ip less instruction length: dispatcher advances ip
+ * before execution.
+ */
+#define I960_BSTAT_TARGETS	4
+
+struct i960_btarget {
+	uint32_t ip;
+	uint64_t count;
+};
+
+struct i960_bsite {
+	uint32_t ip, op;
+	uint64_t count, taken;
+	struct i960_btarget target[I960_BSTAT_TARGETS];
+	uint64_t other;			/* targets not in histogram	*/
+};
+
+struct i960_bstat {
+	struct i960_bsite *v;		/* open-addressing by ip	*/
+	size_t size, used;
+};
+
+void i960_bstat_fini (struct i960_bstat *s);
+
+/*
+ * Returns site record, creates it if needed. Returns NULL if site not
+ * found and out of memory.
+ */
+struct i960_bsite *i960_bstat_site (struct i960_bstat *s, uint32_t ip,
+				    uint32_t op);
+struct i960_bsite *i960_bstat_find (const struct i960_bstat *s, uint32_t ip);
+
+void i960_bstat_target (struct i960_bsite *site, uint32_t target);
+
+static inline void i960_bstat_cond (struct i960 *o, uint32_t op, int taken)
+{
+	struct i960_bsite *site;
+
+	if (__builtin_expect (o->bstat != NULL, 0) &&
+	    (site = i960_bstat_site (o->bstat, o->ip - 4, op)) != NULL) {
+		++site->count;
+		site->taken += taken != 0;
+	}
+}
+
+static inline
+void i960_bstat_indirect (struct i960 *o, uint32_t op, uint32_t target)
+{
+	const uint32_t len = i960_insn_len (op);
+	struct i960_bsite *site;
+
+	if (__builtin_expect (o->bstat != NULL, 0) &&
+	    (site = i960_bstat_site (o->bstat, o->ip - len, op)) != NULL) {
+		++site->count;
+		++site->taken;
+		i960_bstat_target (site, target);
+	}
+}
+
+/*
+ * Write sites ordered by address with disassembly, counts, taken ratio
+ * and target histogram.
+ */
+void i960_bstat_report (FILE *to, const struct i960_bstat *s);
+
+#endif  /* I960_EMU_BSTAT_H */
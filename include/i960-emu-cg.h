@@ -0,0 +1,101 @@
+/*
+ * 80960 Emulator Call Graph Profiler
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_EMU_CG_H
+#define I960_EMU_CG_H  1
+
+#include <stdio.h>
+
+#include <i960-emu.h>
+#include <i960-sym.h>
+
+/*
+ * Shadow call stack over calling context tree. Time is taken from the
+ * clock counter given on init, usually retired instruction counter of
+ * statistics block (&stat->insns) or cycle estimation.
+ */
+struct i960_cg_node {
+	uint32_t addr;			/* function entry		*/
+	uint32_t parent, child, next;	/* node indices, 0 = none	*/
+	uint64_t calls, self, total;
+};
+
+struct i960_cg_frame {
+	uint32_t node, link;		/* link = 0 for call frames	*/
+	uint64_t start;
+};
+
+#define I960_CG_DEPTH	1024
+
+struct i960_cg {
+	const uint64_t *clock;
+	uint64_t last;
+	struct i960_syms *syms;		/* optional, for names		*/
+	FILE *trace;			/* optional Chrome trace output	*/
+	int tid;
+
+	struct i960_cg_node *nodes;
+	size_t count, avail;
+
+	struct i960_cg_frame stack[I960_CG_DEPTH];
+	size_t depth, lost, leaves;	/* call, leaf frames beyond stack */
+};
+
+int  i960_cg_init (struct i960_cg *o, const uint64_t *clock);
+void i960_cg_fini (struct i960_cg *o);
+
+void i960_cg_enter (struct i960_cg *o, uint32_t addr, uint32_t link);
+void i960_cg_leave (struct i960_cg *o);
+void i960_cg_leaf_leave (struct i960_cg *o, uint32_t addr);
+
+/*
+ * Hooks: call, callx and calls open call frame closed by ret, bal and
+ * balx open leaf frame closed by bx to the saved link address.
+ */
+static inline void i960_on_call (struct i960 *o, uint32_t efa)
+{
+	if (__builtin_expect (o->cg != NULL, 0))
+		i960_cg_enter (o->cg, efa, 0);
+}
+
+static inline void i960_on_bal (struct i960 *o, uint32_t efa, uint32_t link)
+{
+	if (__builtin_expect (o->cg != NULL, 0))
+		i960_cg_enter (o->cg, efa, link);
+}
+
+static inline void i960_on_ret (struct i960 *o)
+{
+	if (__builtin_expect (o->cg != NULL, 0))
+		i960_cg_leave (o->cg);
+}
+
+static inline void i960_on_bx (struct i960 *o, uint32_t efa)
+{
+	if (__builtin_expect (o->cg != NULL, 0))
+		i960_cg_leaf_leave (o->cg, efa);
+}
+
+/*
+ * Brendan Gregg folded stacks with exclusive time per calling context.
+ */
+void i960_cg_folded (FILE *to, struct i960_cg *o);
+
+/*
+ * Flat profile: calls, inclusive and exclusive time per function.
+ */
+void i960_cg_report (FILE *to, struct i960_cg *o);
+
+/*
+ * Start Chrome trace JSON (array format) on the given stream, call and
+ * return events are written as they happen. Finish closes the array.
+ */
+void i960_cg_trace_start  (struct i960_cg *o, FILE *to, int tid);
+void i960_cg_trace_finish (struct i960_cg *o);
+
+#endif  /* I960_EMU_CG_H */
@@ -10,11 +10,47 @@
 #define I960_EMU_FAULTS_H  1
 
 #include <i960-emu.h>
+#include <i960-emu-acct.h>
 #include <i960-emu-bits.h>
+#include <i960-emu-stat.h>
+
+static inline void i960_raise (struct i960 *o, int type)
+{
+	i960_stat_fault (o);
+	i960_acct_enter (o, I960_ACCT_FAULT);
+	i960_fault (o, type);
+	i960_acct_leave (o);
+}
 
 static inline void i960_on_undef (struct i960 *o)
 {
-	i960_fault (o, 0x20001);	/* invalid opcode */
+	i960_raise (o, 0x20001);	/* invalid opcode */
+}
+
+/*
+ * Supervisor-only operations and special function registers sf0-sf2
+ */
+static inline int i960_check_em (struct i960 *o)
+{
+	const int em = u32_bit_select (o->pc, I960_EM_POS);
+
+	if (em == 0)
+		i960_raise (o, 0xa0001);	/* type mismatch */
+
+	return em;
+}
+
+static inline int i960_check_sfr (struct i960 *o, uint32_t i)
+{
+	if (!i960_check_em (o))
+		return 0;
+
+	if (i >= I960_SF_COUNT) {
+		i960_raise (o, 0x20004);	/* invalid operand */
+		return 0;
+	}
+
+	return 1;
 }
 
 static inline void i960_on_overflow (struct i960 *o)
@@ -22,7 +58,7 @@ static inline void i960_on_overflow (struct i960 *o)
 	if (u32_bit_select (o->ac, I960_OM_POS))	/* if masked	*/
 		o->ac |= u32_bit_mask (I960_OF_POS);	/* set flag	*/
 	else
-		i960_fault (o, 0x30001);	/* integer overflow	*/
+		i960_raise (o, 0x30001);	/* integer overflow	*/
 }
 
 #endif  /* I960_EMU_FAULTS_H */
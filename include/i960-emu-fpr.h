@@ -0,0 +1,69 @@
+/*
+ * 80960 Emulator Floating-Point Registers
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ *
+ * Values are converted lazily: writer stores value in its own format,
+ * reader converts only if it needs other format. Value is kept in the
+ * format of operation that produced it, which may be wider than value
+ * needs: extended 1.0 stays extended.
+ */
+
+#ifndef I960_EMU_FPR_H
+#define I960_EMU_FPR_H  1
+
+#include <i960-emu.h>
+
+static inline long double i960_fpr_get (const struct i960_fpr *f)
+{
+	switch (f->fmt) {
+	case I960_FPR_S:  return f->v.s;
+	case I960_FPR_D:  return f->v.d;
+	}
+
+	return f->v.e;
+}
+
+static inline void i960_fpr_set_s (struct i960_fpr *f, float x)
+{
+	f->v.s = x;
+	f->fmt = I960_FPR_S;
+}
+
+static inline void i960_fpr_set_d (struct i960_fpr *f, double x)
+{
+	f->v.d = x;
+	f->fmt = I960_FPR_D;
+}
+
+static inline void i960_fpr_set_e (struct i960_fpr *f, long double x)
+{
+	f->v.e = x;
+	f->fmt = I960_FPR_E;
+}
+
+/*
+ * Returns 1 and value if it is held in float or double without rounding
+ */
+static inline int i960_fpr_get_s (const struct i960_fpr *f, float *x)
+{
+	if (f->fmt != I960_FPR_S)
+		return 0;
+
+	*x = f->v.s;
+	return 1;
+}
+
+static inline int i960_fpr_get_d (const struct i960_fpr *f, double *x)
+{
+	switch (f->fmt) {
+	case I960_FPR_S:  *x = f->v.s;  return 1;
+	case I960_FPR_D:  *x = f->v.d;  return 1;
+	}
+
+	return 0;
+}
+
+#endif  /* I960_EMU_FPR_H */
@@ -0,0 +1,72 @@
+/*
+ * 80960 Emulator Operation Entry Points
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_EMU_OPS_H
+#define I960_EMU_OPS_H  1
+
+#include <stddef.h>
+
+#include <i960-decode.h>
+#include <i960-emu.h>
+
+/*
+ * Instruction handlers called by embedder after fetch and operand
+ * decode. The o->ip points to the next instruction already, REG and MEM
+ * handlers get source operand values and destination register index.
+ */
+void reg_core   (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c);
+void reg_supp   (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c);
+void reg_muldiv (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c);
+void reg_cond   (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c);
+void reg_fpu    (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c);
+
+void mem_op (struct i960 *o, uint32_t op, uint32_t efa, size_t c);
+
+/*
+ * CTRL, COBR and REG handlers take instruction decoded by i960_decode,
+ * CTRL and COBR ones take its address too
+ */
+void i960_ctrl (struct i960 *o, const struct i960_insn *in, uint32_t ip);
+void i960_cobr (struct i960 *o, const struct i960_insn *in, uint32_t ip);
+void i960_reg  (struct i960 *o, const struct i960_insn *in);
+
+/*
+ * Floating-point operations of reg_fpu, reg_supp and reg_cond
+ */
+void i960_fpu (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c);
+
+/*
+ * String and block operations of reg_supp: cmpstr, movqstr, movstr and
+ * fill with length in register c. Instruction completes in one step,
+ * operand registers are left intact
+ */
+void i960_string (struct i960 *o, uint32_t op, uint32_t a, uint32_t b,
+		  size_t c);
+
+/*
+ * Fetch, decode and execute one instruction at o->ip
+ */
+void i960_step (struct i960 *o);
+
+/*
+ * Step until o->ip reaches stop address or limit instructions retired,
+ * returns number of instructions executed
+ */
+uint64_t i960_run (struct i960 *o, uint32_t stop, uint64_t limit);
+
+/*
+ * REG function families dispatched by reg_core, exported for direct use
+ * by benchmarks and alternative decoders
+ */
+void reg_log   (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c);
+void reg_addx  (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c);
+void reg_addc  (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c);
+void reg_shift (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c);
+void reg_cmp   (struct i960 *o, uint32_t op, uint32_t a, uint32_t b, size_t c);
+
+#endif  /* I960_EMU_OPS_H */
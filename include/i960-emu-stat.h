@@ -0,0 +1,157 @@
+/*
+ * 80960 Emulator Instruction Statistics
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_EMU_STAT_H
+#define I960_EMU_STAT_H  1
+
+#include <stdio.h>
+
+#include <i960-emu.h>
+
+/*
+ * Retired instruction counters, indexed the same way as disassembler
+ * tables are. Counting is enabled by attaching zeroed statistics block
+ * to CPU state (o->stat), default is NULL: one well-predicted branch per
+ * instruction.
+ */
+struct i960_stat {
+	uint64_t insns;			/* total retired instructions	*/
+	uint64_t ctrl[32];		/* 00..1F			*/
+	uint64_t cobr[32];		/* 20..3F			*/
+	uint64_t mem[128];		/* 80..FF			*/
+	uint64_t reg[1024];		/* 40..7F, 4-bit function	*/
+
+	uint64_t taken;			/* taken branches		*/
+	uint64_t strbytes;		/* bytes covered by string ops	*/
+	uint64_t spills, fills;		/* register cache frame moves	*/
+	uint32_t frames, cached;	/* register cache model, sets	*/
+	uint64_t faults;		/* raised faults		*/
+	uint64_t mmio;			/* device accesses		*/
+};
+
+static inline uint32_t i960_stat_reg_index (uint32_t op)
+{
+	return ((op >> 20) & 0x3f0) | ((op >> 7) & 0xf);
+}
+
+static inline void i960_stat_ctrl (struct i960 *o, uint32_t op)
+{
+	if (__builtin_expect (o->stat != NULL, 0)) {
+		++o->stat->insns;
+		++o->stat->ctrl[(op >> 24) & 31];
+	}
+}
+
+static inline void i960_stat_cobr (struct i960 *o, uint32_t op)
+{
+	if (__builtin_expect (o->stat != NULL, 0)) {
+		++o->stat->insns;
+		++o->stat->cobr[(op >> 24) & 31];
+	}
+}
+
+static inline void i960_stat_mem (struct i960 *o, uint32_t op)
+{
+	if (__builtin_expect (o->stat != NULL, 0)) {
+		++o->stat->insns;
+		++o->stat->mem[(op >> 24) & 127];
+	}
+}
+
+static inline void i960_stat_reg (struct i960 *o, uint32_t op)
+{
+	if (__builtin_expect (o->stat != NULL, 0)) {
+		++o->stat->insns;
+		++o->stat->reg[i960_stat_reg_index (op)];
+	}
+}
+
+/*
+ * String operation covered n bytes
+ */
+static inline void i960_stat_string (struct i960 *o, uint32_t n)
+{
+	if (__builtin_expect (o->stat != NULL, 0))
+		o->stat->strbytes += n;
+}
+
+static inline void i960_stat_taken (struct i960 *o)
+{
+	if (__builtin_expect (o->stat != NULL, 0))
+		++o->stat->taken;
+}
+
+static inline void i960_stat_fault (struct i960 *o)
+{
+	if (__builtin_expect (o->stat != NULL, 0))
+		++o->stat->faults;
+}
+
+/*
+ * Memory callbacks of embedder call it for accesses that go to devices
+ * rather than to plain RAM
+ */
+static inline void i960_stat_mmio (struct i960 *o)
+{
+	if (__builtin_expect (o->stat != NULL, 0))
+		++o->stat->mmio;
+}
+
+/*
+ * Register cache holds current frame and up to frames - 1 frames of
+ * callers: call spills the oldest one when full, return fills caller
+ * frame if it was spilled. Not modelled if frames is zero.
+ */
+static inline void i960_stat_call (struct i960 *o)
+{
+	struct i960_stat *s = o->stat;
+
+	if (__builtin_expect (s == NULL || s->frames == 0, 1))
+		return;
+
+	if (s->cached + 1 < s->frames)
+		++s->cached;
+	else
+		++s->spills;
+}
+
+static inline void i960_stat_ret (struct i960 *o)
+{
+	struct i960_stat *s = o->stat;
+
+	if (__builtin_expect (s == NULL || s->frames == 0, 1))
+		return;
+
+	if (s->cached > 0)
+		--s->cached;
+	else
+		++s->fills;
+}
+
+static inline void i960_stat_flush (struct i960 *o)
+{
+	struct i960_stat *s = o->stat;
+
+	if (__builtin_expect (s == NULL, 1))
+		return;
+
+	s->spills += s->cached;
+	s->cached  = 0;
+}
+
+#define I960_STAT_CSV	0
+#define I960_STAT_JSON	1
+
+/*
+ * Write instruction mix report: one record per executed opcode with
+ * mnemonic from disassembler tables, count and share of all retired
+ * instructions.
+ */
+void i960_stat_dump (FILE *to, const struct i960_stat *s, int format);
+
+#endif  /* I960_EMU_STAT_H */
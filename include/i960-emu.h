@@ -19,9 +19,14 @@
 #define I960_FP			31	/* g15, frame pointer		*/
 
 #define I960_CC_MASK		0x7	/* AC, condition code mask	*/
+#define I960_AS_POS		3	/* AC, arithmetic status	*/
 #define I960_OF_POS		8	/* AC, integer overflow bit	*/
 #define I960_OM_POS		12	/* AC, overflow mask bit	*/
 #define I960_BIF_POS		15	/* AC, no-imprecise faults	*/
+#define I960_FPF_POS		16	/* AC, FP exception flags	*/
+#define I960_FPM_POS		24	/* AC, FP exception masks	*/
+#define I960_NM_POS		29	/* AC, FP normalizing mode	*/
+#define I960_RND_POS		30	/* AC, FP rounding control	*/
 
 #define I960_TE_POS		0	/* PC, trace enable		*/
 #define I960_EM_POS		1	/* PC, execution mode		*/
@@ -30,8 +35,49 @@
 #define I960_P_POS		16	/* PC, priority			*/
 #define I960_P_MASK		0x1f
 
+#define I960_SF_IPND		0	/* sf0, interrupt pending	*/
+#define I960_SF_IMSK		1	/* sf1, interrupt mask		*/
+#define I960_SF_DMAC		2	/* sf2, DMA command		*/
+#define I960_SF_COUNT		3	/* CA special function regs	*/
+#define I960_SF_SLOT		32	/* r, sfr destination scratch	*/
+
+struct i960_stat;
+struct i960_cg;
+struct i960_alog;
+struct i960_trace;
+struct i960_bstat;
+struct i960_acct;
+
+/*
+ * Floating-point register holds value in host format of the operation
+ * that produced it, all-zero register is +0.0
+ */
+enum i960_fpr_fmt {
+	I960_FPR_S,			/* float, real			*/
+	I960_FPR_D,			/* double, long real		*/
+	I960_FPR_E,			/* long double, extended real	*/
+};
+
+struct i960_fpr {
+	union {
+		float s;
+		double d;
+		long double e;
+	} v;
+	uint8_t fmt;
+};
+
 struct i960 {
-	uint32_t r[32], ip, ac, pc, tc;
+	uint32_t r[32 + 4], ip, ac, pc, tc;	/* r32-r35 are sfr scratch	*/
+	uint32_t sf[I960_SF_COUNT];	/* IPND, IMSK, DMAC, CA only	*/
+	struct i960_fpr fp[4];		/* fp0-fp3, KB and SB only	*/
+
+	struct i960_stat *stat;		/* opcode counters, optional	*/
+	struct i960_cg   *cg;		/* call graph, optional		*/
+	struct i960_alog *alog;		/* access log, optional		*/
+	struct i960_trace *trace;	/* execution trace, optional	*/
+	struct i960_bstat *bstat;	/* branch sites, optional	*/
+	struct i960_acct  *acct;	/* host time, optional		*/
 };
 
 uint8_t  i960_read_b (struct i960 *o, uint32_t addr);
@@ -42,6 +88,14 @@ void i960_write_b (struct i960 *o, uint32_t addr, uint32_t x);
 void i960_write_s (struct i960 *o, uint32_t addr, uint32_t x);
 void i960_write_w (struct i960 *o, uint32_t addr, uint32_t x);
 
+/*
+ * Host pointer to size bytes of plain RAM at addr or NULL if range is
+ * not host-backed (devices, holes, mapping boundaries). Block operations
+ * use it to bypass per-access callbacks, embedder without host-backed
+ * RAM returns NULL always.
+ */
+void *i960_map (struct i960 *o, uint32_t addr, uint32_t size, int write);
+
 void i960_fault (struct i960 *o, int type);
 void i960_calls (struct i960 *o, int type);
 
@@ -0,0 +1,45 @@
+/*
+ * 80960 Emulator Floating-Point Function Kernels
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_FPU_FN_H
+#define I960_FPU_FN_H  1
+
+/*
+ * Functions of atanr, logepr, logr, expr, sinr, cosr and tanr without
+ * src2 scaling of logarithms: atan2 (y, x), log2 (x + 1), log2 (x),
+ * 2^x - 1, sin (x), cos (x), tan (x)
+ */
+enum i960_fpu_fn {
+	I960_FN_ATAN,
+	I960_FN_LOGEP,
+	I960_FN_LOG,
+	I960_FN_EXP,
+	I960_FN_SIN,
+	I960_FN_COS,
+	I960_FN_TAN,
+};
+
+/*
+ * Result status: inexact, exact, or argument out of kernel domain (zeros,
+ * denormals, infinities, NaNs, large arguments) and result is not
+ * defined: caller should evaluate such argument other way
+ */
+enum i960_fpu_fn_status {
+	I960_FN_INEXACT,
+	I960_FN_EXACT,
+	I960_FN_OUT,
+};
+
+/*
+ * Evaluates function in double precision with host rounding to nearest:
+ * *r = f (x), or f (y, x) for atan; y is not used by other functions.
+ * Returns result status, *r is left intact for I960_FN_OUT.
+ */
+int i960_fpu_fn (int fn, double x, double y, double *r);
+
+#endif  /* I960_FPU_FN_H */
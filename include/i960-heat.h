@@ -0,0 +1,74 @@
+/*
+ * 80960 Emulator Memory Heat Map
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_HEAT_H
+#define I960_HEAT_H  1
+
+#include <stdio.h>
+
+#include <i960-emu-alog.h>
+
+#define I960_HEAT_SHIFT		12	/* 4 KiB pages			*/
+
+struct i960_heat_page {
+	uint32_t page;
+	uint64_t n[3];			/* fetches, loads, stores	*/
+};
+
+struct i960_region {
+	uint32_t base, size;
+	char *name;
+	uint64_t n[3];
+};
+
+/*
+ * Access counters per guest page and per registered region fed by access
+ * log in batches, see i960_alog: use i960_heat_feed as flush callback
+ * and heat map as its context. Access log samples every period-th record
+ * itself, i960_heat_alog sets it up.
+ */
+struct i960_heat {
+	unsigned period;
+
+	struct i960_heat_page *pages;	/* open-addressing by page	*/
+	size_t size, used;
+	struct i960_heat_page *last;	/* page of previous sample	*/
+
+	struct i960_region *regions;	/* sorted by base		*/
+	size_t count, avail;
+};
+
+int  i960_heat_init (struct i960_heat *o, unsigned period);
+void i960_heat_fini (struct i960_heat *o);
+
+/*
+ * Register named memory region, regions must not overlap. Returns 1 on
+ * success, 0 on error with errno set.
+ */
+int i960_heat_region (struct i960_heat *o, uint32_t base, uint32_t size,
+		      const char *name);
+
+void i960_heat_feed (void *ctx, const struct i960_access *v, size_t count);
+
+/*
+ * Set up access log with buffer of size records to feed heat map with
+ * every period-th access
+ */
+void i960_heat_alog (struct i960_heat *o, struct i960_alog *a,
+		     struct i960_access *v, size_t size);
+
+#define I960_HEAT_MAP	0		/* text map, 64 KiB per row	*/
+#define I960_HEAT_CSV	1		/* one record per page		*/
+
+/*
+ * Write page heat map or page table and region table, counts scaled by
+ * sampling period.
+ */
+void i960_heat_report (FILE *to, const struct i960_heat *o, int format);
+
+#endif  /* I960_HEAT_H */
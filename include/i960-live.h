@@ -0,0 +1,101 @@
+/*
+ * 80960 Emulator Live Statistics Page
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_LIVE_H
+#define I960_LIVE_H  1
+
+#include <i960-emu-stat.h>
+
+#define I960_LIVE_INSNS		0	/* retired instructions		*/
+#define I960_LIVE_TAKEN		1	/* taken branches		*/
+#define I960_LIVE_SPILLS	2	/* register cache frame moves	*/
+#define I960_LIVE_FILLS		3
+#define I960_LIVE_FAULTS	4	/* raised faults		*/
+#define I960_LIVE_MMIO		5	/* device accesses		*/
+#define I960_LIVE_COUNTERS	15
+
+/*
+ * Counters of one emulation thread, written by that thread only. Every
+ * slot takes its own cache lines: no false sharing between threads.
+ */
+struct i960_live_slot {
+	uint64_t tid;
+	uint64_t v[I960_LIVE_COUNTERS];
+} __attribute__ ((aligned (64)));
+
+struct i960_live_page {
+	char magic[8];
+	uint32_t nslots, used;
+	uint64_t pid, start;		/* start time, ns since epoch	*/
+	uint8_t pad[32];
+
+	struct i960_live_slot slot[];
+};
+
+/*
+ * Page is published as POSIX shared memory object, default name is
+ * /i960-<pid>: monitor finds running instances in /dev/shm.
+ */
+struct i960_live {
+	struct i960_live_page *page;
+	size_t size;
+	int owner;
+	char name[64];
+};
+
+/*
+ * Create page with given number of thread slots, name may be NULL.
+ * Returns 1 on success, 0 on error with errno set.
+ */
+int  i960_live_open  (struct i960_live *o, const char *name, unsigned slots);
+void i960_live_close (struct i960_live *o);
+
+/*
+ * Map existing page read-only (monitor side)
+ */
+int i960_live_map (struct i960_live *o, const char *name);
+
+/*
+ * Claim slot for the calling thread, returns NULL if all slots are taken.
+ */
+struct i960_live_slot *i960_live_slot (struct i960_live *o);
+
+static inline
+void i960_live_set (struct i960_live_slot *s, int counter, uint64_t x)
+{
+	__atomic_store_n (s->v + counter, x, __ATOMIC_RELAXED);
+}
+
+static inline
+void i960_live_add (struct i960_live_slot *s, int counter, uint64_t x)
+{
+	i960_live_set (s, counter, s->v[counter] + x);  /* single writer */
+}
+
+static inline
+uint64_t i960_live_get (const struct i960_live_slot *s, int counter)
+{
+	return __atomic_load_n (s->v + counter, __ATOMIC_RELAXED);
+}
+
+/*
+ * Publish counters of statistics block: call from emulation thread from
+ * time to time (every translated block, every N instructions, ...).
+ */
+static inline
+void i960_live_sync (struct i960_live_slot *s, const struct i960_stat *st)
+{
+	i960_live_set (s, I960_LIVE_INSNS,  st->insns);
+	i960_live_set (s, I960_LIVE_TAKEN,  st->taken);
+	i960_live_set (s, I960_LIVE_SPILLS, st->spills);
+	i960_live_set (s, I960_LIVE_FILLS,  st->fills);
+	i960_live_set (s, I960_LIVE_FAULTS, st->faults);
+	i960_live_set (s, I960_LIVE_MMIO,   st->mmio);
+}
+
+#endif  /* I960_LIVE_H */
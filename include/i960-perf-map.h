@@ -0,0 +1,45 @@
+/*
+ * 80960 Emulator Linux perf Code Map
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_PERF_MAP_H
+#define I960_PERF_MAP_H  1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <i960-sym.h>
+
+/*
+ * Names host code regions generated for guest blocks for perf(1): text
+ * map /tmp/perf-<pid>.map is read by perf report/top directly, jitdump
+ * /tmp/jit-<pid>.dump (with code bytes) is merged by perf inject --jit
+ * for recordings made with -k 1.
+ */
+struct i960_perf_map {
+	FILE *map, *dump;
+	void *marker;
+	uint64_t index;
+	struct i960_syms *syms;		/* optional, for names		*/
+};
+
+#define I960_PERF_MAP		1
+#define I960_PERF_JITDUMP	2
+
+int  i960_perf_map_open  (struct i960_perf_map *o, int flags,
+			  struct i960_syms *syms);
+void i960_perf_map_close (struct i960_perf_map *o);
+
+/*
+ * Register host code region translated from guest block at given address.
+ * Returns 1 on success, 0 on error with errno set.
+ */
+int i960_perf_map_add (struct i960_perf_map *o, const void *code, size_t size,
+		       uint32_t guest);
+
+#endif  /* I960_PERF_MAP_H */
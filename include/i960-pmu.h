@@ -0,0 +1,68 @@
+/*
+ * 80960 Emulator Host Performance Counters
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_PMU_H
+#define I960_PMU_H  1
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define I960_PMU_INSNS		0	/* retired host instructions	*/
+#define I960_PMU_CYCLES		1
+#define I960_PMU_BMISSES	2	/* branch mispredictions	*/
+#define I960_PMU_L1I		3	/* L1 instruction cache misses	*/
+#define I960_PMU_L1D		4	/* L1 data cache read misses	*/
+#define I960_PMU_ITLB		5	/* instruction TLB misses	*/
+#define I960_PMU_COUNT		6
+
+/*
+ * Hardware counters of the calling thread, user mode only, read with
+ * perf_event_open(2) as one group. Counters the host or its
+ * perf_event_paranoid setting refuses stay closed (fd < 0); group
+ * multiplexed by kernel is scaled to the full enabled time. Group that
+ * kernel never schedules (more events than free counters) is split and
+ * counters are read one by one then. Counter is not valid if it was
+ * never scheduled between start and stop.
+ */
+struct i960_pmu {
+	int fd[I960_PMU_COUNT];
+	int group;			/* leader fd, -1 if none	*/
+	int split;			/* counters read one by one	*/
+	uint64_t start[I960_PMU_COUNT];
+	uint64_t v[I960_PMU_COUNT];	/* accumulated deltas		*/
+	uint64_t start_time[I960_PMU_COUNT];
+	uint64_t time[I960_PMU_COUNT];	/* running time			*/
+};
+
+/*
+ * Returns number of counters opened, zero if none available
+ */
+int  i960_pmu_open  (struct i960_pmu *o);
+void i960_pmu_close (struct i960_pmu *o);
+
+static inline int i960_pmu_valid (const struct i960_pmu *o, int i)
+{
+	return o->fd[i] >= 0 && o->time[i] > 0;
+}
+
+/*
+ * Add counts between start and stop to o->v, reset clears o->v
+ */
+void i960_pmu_start (struct i960_pmu *o);
+void i960_pmu_stop  (struct i960_pmu *o);
+void i960_pmu_reset (struct i960_pmu *o);
+
+const char *i960_pmu_name (int i);
+
+/*
+ * Write counters divided by number of guest instructions as JSON object,
+ * null for counters not available
+ */
+void i960_pmu_report (FILE *to, const struct i960_pmu *o, uint64_t insns);
+
+#endif  /* I960_PMU_H */
@@ -0,0 +1,61 @@
+/*
+ * 80960 Emulator Sampling Profiler
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_PROF_H
+#define I960_PROF_H  1
+
+#include <stdio.h>
+
+#include <i960-emu.h>
+#include <i960-sym.h>
+
+/*
+ * Per-thread sampler: SIGPROF handler stores guest ip of the CPU attached
+ * to the interrupted thread into a single-producer ring, owner thread
+ * folds ring into histogram with i960_prof_collect. Nothing is touched
+ * on the emulation path.
+ */
+struct i960_prof_bin {
+	uint32_t ip;
+	uint64_t count;
+};
+
+struct i960_prof {
+	struct i960 *cpu;
+	uint32_t *ring;
+	size_t mask, head, tail;	/* head written by handler only	*/
+	uint64_t lost;
+
+	struct i960_prof_bin *bins;	/* open-addressing ip histogram	*/
+	size_t nbins, used;
+};
+
+/*
+ * Install SIGPROF handler and start process CPU time interval timer with
+ * given sampling frequency. Returns 1 on success, 0 on error with errno
+ * set.
+ */
+int  i960_prof_start (unsigned hz);
+void i960_prof_stop  (void);
+
+/*
+ * Bind sampler to CPU emulated by the calling thread, ring size rounded
+ * up to power of two.
+ */
+int  i960_prof_attach (struct i960_prof *p, struct i960 *o, size_t size);
+void i960_prof_detach (struct i960_prof *p);
+
+int  i960_prof_collect (struct i960_prof *p);
+
+/*
+ * Collect pending samples and write flat profile with guest symbols
+ * resolved, most sampled functions first. Symbol table may be NULL.
+ */
+void i960_prof_report (FILE *to, struct i960_prof *p, struct i960_syms *s);
+
+#endif  /* I960_PROF_H */
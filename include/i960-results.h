@@ -0,0 +1,61 @@
+/*
+ * 80960 Emulator Benchmark Result Store
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_RESULTS_H
+#define I960_RESULTS_H  1
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * Results file is line-oriented text, one header field or benchmark per
+ * line, samples are in "higher is better" units (MIPS):
+ *
+ *	i960-results 1
+ *	tool i960-macro
+ *	date 2024-05-01T12:00:00Z
+ *	cpu <host CPU model>
+ *	compiler <compiler used to build the emulator>
+ *	revision <git revision of the emulator build>
+ *	sample <benchmark> <mode> <value> ...
+ */
+struct i960_result {
+	char *name, *mode;
+	double *v;
+	unsigned n;
+};
+
+struct i960_results {
+	char *tool, *date, *cpu, *compiler, *revision;
+
+	struct i960_result *v;
+	size_t count, avail;
+};
+
+/*
+ * Create new results file in directory named after tool, time and
+ * revision, header is written already. Returns NULL on error with errno
+ * set, path of file created is stored into path buffer.
+ */
+FILE *i960_results_create (const char *dir, const char *tool, char *path,
+			   size_t size);
+
+void i960_results_put (FILE *to, const char *name, const char *mode,
+		       const double *v, unsigned n);
+
+/*
+ * Load results file. Returns 1 on success, 0 on error with errno set.
+ */
+int  i960_results_load (struct i960_results *o, const char *path);
+void i960_results_fini (struct i960_results *o);
+
+const struct i960_result *
+i960_results_find (const struct i960_results *o, const char *name,
+		   const char *mode);
+
+#endif  /* I960_RESULTS_H */
@@ -0,0 +1,35 @@
+/*
+ * 80960 Emulator Benchmark Sample Statistics
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_SAMPLE_H
+#define I960_SAMPLE_H  1
+
+struct i960_sample {
+	unsigned n;
+	double mean, sd, min, max;
+	double lo, hi;			/* 95% confidence interval	*/
+};
+
+/*
+ * Summarize n measurements, confidence interval of the mean uses Student
+ * t distribution
+ */
+void i960_sample_stat (struct i960_sample *s, const double *v, unsigned n);
+
+double i960_sample_median (const double *v, unsigned n);
+
+/*
+ * Mann-Whitney U rank-sum test of two independent samples, returns
+ * two-sided p-value of the hypothesis that both come from the same
+ * distribution: exact for small tie-free samples, normal approximation
+ * with tie correction otherwise
+ */
+double i960_sample_mwu (const double *x, unsigned n, const double *y,
+			unsigned m);
+
+#endif  /* I960_SAMPLE_H */
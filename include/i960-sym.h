@@ -0,0 +1,42 @@
+/*
+ * 80960 Guest Symbol Table
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_SYM_H
+#define I960_SYM_H  1
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct i960_sym {
+	uint32_t addr;
+	char *name;
+};
+
+struct i960_syms {
+	struct i960_sym *v;
+	size_t count, avail;
+	int sorted;
+};
+
+void i960_syms_init (struct i960_syms *o);
+void i960_syms_fini (struct i960_syms *o);
+
+int i960_syms_add (struct i960_syms *o, uint32_t addr, const char *name);
+
+/*
+ * Load symbols in nm(1) output format: "address [type] name" per line,
+ * address in hex. Returns 1 on success, 0 on error with errno set.
+ */
+int i960_syms_load (struct i960_syms *o, const char *path);
+
+/*
+ * Returns symbol with the highest address not above addr, or NULL.
+ */
+const struct i960_sym *i960_syms_lookup (struct i960_syms *o, uint32_t addr);
+
+#endif  /* I960_SYM_H */
@@ -0,0 +1,81 @@
+/*
+ * 80960 Emulator Instruction Timing Model
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_TIMING_H
+#define I960_TIMING_H  1
+
+#include <stdio.h>
+
+#include <i960-emu-stat.h>
+
+#define I960_KA		0
+#define I960_KB		1
+#define I960_SA		2
+#define I960_SB		3
+#define I960_CA		4
+#define I960_JF		5
+#define I960_HD		6
+#define I960_VARIANTS	7
+
+#define I960_F_FPU	1		/* KB, SB floating point	*/
+#define I960_F_KS	2		/* K, S only: synmov, decimal	*/
+#define I960_F_C	4		/* C only: DMA			*/
+#define I960_F_CJ	8		/* C and J: sysctl, eshro	*/
+#define I960_F_J	16		/* J: cmpXb, bswap, cond. ops	*/
+
+/*
+ * Instruction cost classes
+ */
+enum i960_tclass {
+	I960_T_UNDEF,	I960_T_ALU,	I960_T_MOVE,	I960_T_SYS,
+	I960_T_MUL,	I960_T_DIV,	I960_T_EMUL,	I960_T_EDIV,
+	I960_T_LD1,	I960_T_LD2,	I960_T_LD3,	I960_T_LD4,
+	I960_T_ST1,	I960_T_ST2,	I960_T_ST3,	I960_T_ST4,
+	I960_T_ATOMIC,	I960_T_BRANCH,	I960_T_BAL,	I960_T_CALL,
+	I960_T_RET,	I960_T_CALLS,	I960_T_FADD,	I960_T_FMUL,
+	I960_T_FDIV,	I960_T_FSQRT,	I960_T_FMISC,	I960_T_FTRANS,
+	I960_T_STRING,
+	I960_T_COUNT
+};
+
+struct i960_timing {
+	const char *name;
+	unsigned features;		/* I960_F_* bit set		*/
+	unsigned frames;		/* register cache sets		*/
+	unsigned taken;			/* taken branch penalty		*/
+	unsigned spill, fill;		/* frame save/restore cost	*/
+	unsigned cost[I960_T_COUNT];
+};
+
+const struct i960_timing *i960_timing (int variant);
+const struct i960_timing *i960_timing_find (const char *name);
+
+/*
+ * Returns cost class of instruction for given variant, I960_T_UNDEF if
+ * instruction is not implemented by it.
+ */
+enum i960_tclass i960_timing_class (const struct i960_timing *t, uint32_t op);
+
+/*
+ * Prepare statistics block to collect variant specific events (register
+ * cache spills and fills) and attach it to CPU.
+ */
+void i960_timing_attach (struct i960 *o, struct i960_stat *s,
+			 const struct i960_timing *t);
+
+/*
+ * Estimated cycle count of collected statistics: sum of class costs of
+ * retired instructions, taken branch penalties and register cache
+ * traffic.
+ */
+uint64_t i960_cycles (const struct i960_stat *s, const struct i960_timing *t);
+
+void i960_timing_report (FILE *to, const struct i960_stat *s,
+			 const struct i960_timing *t);
+
+#endif  /* I960_TIMING_H */
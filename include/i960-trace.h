@@ -0,0 +1,174 @@
+/*
+ * 80960 Emulator Binary Execution Trace
+ *
+ * Copyright (c) 2024 Alexei A. Smekalkine <ikle@ikle.ru>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#ifndef I960_TRACE_H
+#define I960_TRACE_H  1
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include <i960-emu-alog.h>
+
+#define I960_TRACE_AC		32	/* register indices of record	*/
+#define I960_TRACE_PC		33
+#define I960_TRACE_TC		34
+#define I960_TRACE_REGS		35
+
+#define I960_TRACE_MEM		32	/* memory effects per record	*/
+
+#define I960_TRACE_CHUNK	65536	/* records per chunk		*/
+#define I960_TRACE_BLOOM	4096	/* written address filter size	*/
+
+/*
+ * Retired instruction: address, instruction words, new values of written
+ * registers and memory effects in program order.
+ */
+struct i960_trace_rec {
+	uint64_t n;				/* record number	*/
+	uint32_t ip, op, disp;
+	uint64_t regs;				/* written registers	*/
+	uint32_t r[I960_TRACE_REGS];
+	unsigned nmem;
+	struct i960_access mem[I960_TRACE_MEM];
+	int gap;				/* records lost before	*/
+};
+
+/*
+ * Trace file is a sequence of independently encoded chunks. Every chunk
+ * header holds register state at chunk start, range of executed ips and
+ * bloom filter of written words; index of chunks is stored at the end of
+ * file.
+ */
+struct i960_trace_chunk {
+	uint64_t offset, first;		/* file offset, first record	*/
+	uint32_t count, ip_lo, ip_hi;	/* records, executed ip range	*/
+};
+
+/*
+ * Per-CPU trace writer: emulation thread puts raw records into a single
+ * producer ring and never blocks, full ring drops records (counted as
+ * lost). Background thread delta-encodes records into chunks and writes
+ * them to file.
+ *
+ * Attached trace owns access log of CPU (o->alog) to collect memory
+ * effects.
+ */
+struct i960_trace_op;
+
+struct i960_trace {
+	struct i960 *cpu;
+	uint32_t *ring;
+	size_t mask, head, tail;	/* head written by CPU thread	*/
+	uint64_t count, lost, truncated;
+	int gap;
+
+	uint32_t snap[I960_TRACE_REGS];	/* registers before insn	*/
+	uint32_t ip, op, disp;
+	unsigned nmem;
+	struct i960_access mem[I960_TRACE_MEM];
+	struct i960_access buf[8];
+	struct i960_alog alog;
+
+	FILE *out;			/* owned by writer thread	*/
+	pthread_t writer;
+	int stop, error;
+	uint32_t last_ip, last_addr, shadow[I960_TRACE_REGS];
+	struct i960_trace_op *ops;
+
+	struct i960_trace_chunk chunk;	/* chunk being encoded		*/
+	uint32_t base[I960_TRACE_REGS];	/* registers at chunk start	*/
+	uint8_t *bloom, *data;
+	size_t len, avail;
+
+	struct i960_trace_chunk *index;
+	size_t nchunks, index_size;
+};
+
+/*
+ * Create trace file, start writer thread and attach trace to CPU. Ring
+ * size in words rounded up to power of two. Returns 1 on success, 0 on
+ * error with errno set.
+ */
+int i960_trace_start (struct i960_trace *t, struct i960 *o, const char *path,
+		      size_t size);
+
+/*
+ * Detach trace, drain ring and close file. Returns 0 if writer failed.
+ */
+int i960_trace_stop (struct i960_trace *t);
+
+void i960_trace_enter  (struct i960_trace *t, uint32_t ip, uint32_t op,
+			uint32_t disp);
+void i960_trace_retire (struct i960_trace *t);
+
+/*
+ * Dispatcher hooks: call i960_trace_begin before instruction execution
+ * and i960_trace_end after it. The disp argument is the second word of
+ * instruction (MEMB only), ignored otherwise.
+ */
+static inline
+void i960_trace_begin (struct i960 *o, uint32_t ip, uint32_t op, uint32_t disp)
+{
+	if (__builtin_expect (o->trace != NULL, 0))
+		i960_trace_enter (o->trace, ip, op, disp);
+}
+
+static inline void i960_trace_end (struct i960 *o)
+{
+	if (__builtin_expect (o->trace != NULL, 0))
+		i960_trace_retire (o->trace);
+}
+
+/*
+ * Trace reader. Index of unfinished trace (writer killed) is rebuilt from
+ * chunk headers, lost record count is unknown then.
+ */
+struct i960_trace_reader {
+	FILE *in;
+	uint32_t last_ip, last_addr, shadow[I960_TRACE_REGS];
+	struct i960_trace_op *ops;
+	uint8_t *bloom;
+
+	struct i960_trace_chunk *index;
+	size_t nchunks, chunk;		/* current chunk		*/
+	uint32_t left;			/* records left in chunk	*/
+	uint64_t next;			/* next record number		*/
+	uint64_t count, lost;
+};
+
+int  i960_trace_open  (struct i960_trace_reader *r, const char *path);
+void i960_trace_close (struct i960_trace_reader *r);
+
+/*
+ * Query functions below return 1 on success, 0 if nothing found (end of
+ * trace reached), -1 on error with errno set.
+ */
+int i960_trace_next (struct i960_trace_reader *r, struct i960_trace_rec *rec);
+
+/*
+ * Position reader to record n: decodes records of one chunk only.
+ */
+int i960_trace_seek (struct i960_trace_reader *r, uint64_t n);
+
+/*
+ * Find last store to byte at addr made by record before n. Only chunks
+ * with matching address filter are decoded. Reader position is undefined
+ * after the call.
+ */
+int i960_trace_last_write (struct i960_trace_reader *r, uint32_t addr,
+			   uint64_t n, struct i960_trace_rec *rec);
+
+/*
+ * Find first execution of instruction at ip by record n or later. Only
+ * chunks with matching ip range are decoded. Reader position is undefined
+ * after the call.
+ */
+int i960_trace_find_ip (struct i960_trace_reader *r, uint32_t ip,
+			uint64_t n, struct i960_trace_rec *rec);
+
+#endif  /* I960_TRACE_H */